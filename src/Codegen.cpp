@@ -0,0 +1,1620 @@
+#include "Codegen.hpp"
+#include "Emitter.hpp"
+#include "Target.hpp"
+#include "Operator.hpp"
+
+#include <cstdio>
+#include <cstdarg>
+#include <algorithm>
+
+/**
+ * \brief mnemonics of instructions and type suffixes
+ */
+#define IR_OP_NAME(op, name) name,
+static const char* CodegenOpName[] =
+{
+	IR_OPS(IR_OP_NAME)
+};
+#undef IR_OP_NAME
+
+static const char* CodegenTypeName[] =
+{
+	[(u32)IrType::U8]   = "u8",
+	[(u32)IrType::I64]  = "i64",
+	[(u32)IrType::F64]  = "f64",
+	[(u32)IrType::None] = "",
+};
+
+/**
+ * \brief append formatted text
+ */
+static void CodegenPrint(std::string& out, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void CodegenPrint(std::string& out, const char* fmt, ...)
+{
+	char    buffer[256];
+	va_list args;
+
+	va_start(args, fmt);
+	int size = std::vsnprintf(buffer, sizeof(buffer), fmt, args);
+	va_end(args);
+
+	if(size > 0)
+	{
+		out.append(buffer, size < (int)sizeof(buffer) ? size : sizeof(buffer) - 1);
+	}
+}
+
+/**
+ * \brief start new function, its entry block becomes the current block
+ */
+void Codegen::begin(const std::string& name, u64 source)
+{
+	this->pName   = name;
+	this->pSource = source;
+
+	this->pInsts.clear();
+	this->pBlocks.clear();
+	this->pOperands.clear();
+	this->pEdges.clear();
+	this->pPending.clear();
+	this->pVars.clear();
+	this->pDefs.clear();
+	this->pSymbols.clear();
+	this->pSymbolIndex.clear();
+	this->pLocations.clear();
+	this->pLocals.clear();
+	this->pFrame = 0;
+	this->pSaved = 0;
+
+	//entry block has no predecessors
+	this->pCurrent = this->block();
+	this->seal(this->pCurrent);
+}
+
+/**
+ * \brief costs of target decide strength reduction (nullptr = operations are kept)
+ */
+void Codegen::setTarget(const Target* target)
+{
+	static constexpr std::array<Reduce, TargetCount> instances = Codegen::reductions(std::make_index_sequence<TargetCount>());
+	this->pReduce = target != nullptr ? instances[target - Targets] : nullptr;
+}
+
+/**
+ * \brief new block
+ */
+IrId Codegen::block()
+{
+	IrBlock b;
+	b.first     = IrNone;
+	b.last      = IrNone;
+	b.preds     = IrNone;
+	b.predsLast = IrNone;
+	b.predCount = 0;
+	b.succ[0]   = IrNone;
+	b.succ[1]   = IrNone;
+	b.pending   = IrNone;
+	b.sealed    = false;
+
+	this->pBlocks.push_back(b);
+	return this->pBlocks.size() - 1;
+}
+
+/**
+ * \brief continue code in block, it belongs to all open scopes of local variables
+ */
+void Codegen::enter(IrId block)
+{
+	this->pCurrent = block;
+
+	for(IrLocal& l : this->pLocals)
+	{
+		if(l.open && l.blocks.back() != block)
+		{
+			l.blocks.push_back(block);
+		}
+	}
+}
+
+/**
+ * \brief no more predecessors will be added to the block, complete its phi instructions
+ */
+void Codegen::seal(IrId block)
+{
+	if(this->pBlocks[block].sealed)
+	{
+		return;
+	}
+
+	for(u32 p = this->pBlocks[block].pending; p != IrNone; p = this->pPending[p].next)
+	{
+		this->phiOperands(this->pPending[p].var, this->pPending[p].phi);
+	}
+	this->pBlocks[block].pending = IrNone;
+	this->pBlocks[block].sealed  = true;
+}
+
+/**
+ * \brief current block ends with jump, branch or return
+ */
+bool Codegen::terminated() const
+{
+	IrId last = this->pBlocks[this->pCurrent].last;
+	if(last == IrNone)
+	{
+		return false;
+	}
+
+	IrOp op = this->pInsts[last].op;
+	return op == IrOp::Jump || op == IrOp::Branch || op == IrOp::Ret;
+}
+
+/**
+ * \brief no jump leads into the current block and no more will be added (code after return)
+ */
+bool Codegen::unreachable() const
+{
+	const IrBlock& b = this->pBlocks[this->pCurrent];
+	return this->pCurrent != 0 && b.sealed && b.predCount == 0;
+}
+
+/**
+ * \brief add edge into list of predecessors
+ */
+void Codegen::edge(IrId from, IrId to)
+{
+	IrBlock& f = this->pBlocks[from];
+	f.succ[f.succ[0] == IrNone ? 0 : 1] = to;
+
+	Edge e;
+	e.from = from;
+	e.next = IrNone;
+	this->pEdges.push_back(e);
+
+	IrBlock& t = this->pBlocks[to];
+	if(t.preds == IrNone)
+	{
+		t.preds = this->pEdges.size() - 1;
+	}
+	else
+	{
+		this->pEdges[t.predsLast].next = this->pEdges.size() - 1;
+	}
+	t.predsLast = this->pEdges.size() - 1;
+	t.predCount++;
+}
+
+/**
+ * \brief unreachable block doesn't add predecessors
+ */
+void Codegen::jump(IrId to)
+{
+	if(this->unreachable())
+	{
+		return;
+	}
+	this->append(IrOp::Jump, IrType::None, nullptr, 0);
+	this->edge(this->pCurrent, to);
+}
+
+void Codegen::branch(IrId cond, IrId ifTrue, IrId ifFalse)
+{
+	if(this->unreachable())
+	{
+		return;
+	}
+	this->append(IrOp::Branch, IrType::None, &cond, 1);
+	this->edge(this->pCurrent, ifTrue);
+	this->edge(this->pCurrent, ifFalse);
+}
+
+/**
+ * \brief return values, following code is unreachable
+ */
+void Codegen::ret(const IrId* values, u16 count)
+{
+	this->append(IrOp::Ret, IrType::None, values, count);
+
+	this->pCurrent = this->block();
+	this->seal(this->pCurrent);
+}
+
+/**
+ * \brief local variables in SSA form
+ */
+IrId Codegen::variable(IrType type)
+{
+	this->pVars.push_back(type);
+	return this->pVars.size() - 1;
+}
+
+void Codegen::write(IrId var, IrId value)
+{
+	this->pDefs[(u64)var << 32 | this->pCurrent] = value;
+}
+
+IrId Codegen::read(IrId var)
+{
+	return this->readBlock(var, this->pCurrent);
+}
+
+/**
+ * \brief value of variable at the end of block
+ */
+IrId Codegen::readBlock(IrId var, IrId block)
+{
+	auto it = this->pDefs.find((u64)var << 32 | block);
+	if(it != this->pDefs.end())
+	{
+		return it->second;
+	}
+
+	IrId value;
+	//predecessors are not known yet, operands are added when the block is sealed
+	if(!this->pBlocks[block].sealed)
+	{
+		value = this->prepend(block, IrOp::Phi, this->pVars[var]);
+
+		Pending p;
+		p.var  = var;
+		p.phi  = value;
+		p.next = this->pBlocks[block].pending;
+		this->pPending.push_back(p);
+		this->pBlocks[block].pending = this->pPending.size() - 1;
+	}
+	//single predecessor doesn't need phi
+	else if(this->pBlocks[block].predCount == 1)
+	{
+		value = this->readBlock(var, this->pEdges[this->pBlocks[block].preds].from);
+	}
+	//variable read before its first assignment (entry or unreachable block)
+	else if(this->pBlocks[block].predCount == 0)
+	{
+		value = this->prepend(block, IrOp::Undef, this->pVars[var]);
+	}
+	//phi is defined before its operands are read to break cycles of loops
+	else
+	{
+		value = this->prepend(block, IrOp::Phi, this->pVars[var]);
+		this->pDefs[(u64)var << 32 | block] = value;
+		this->phiOperands(var, value);
+	}
+
+	this->pDefs[(u64)var << 32 | block] = value;
+	return value;
+}
+
+/**
+ * \brief operands of phi are values of variable at the end of predecessors
+ */
+void Codegen::phiOperands(IrId var, IrId phi)
+{
+	IrId block = this->pInsts[phi].block;
+
+	std::vector<IrId> values;
+	values.reserve(this->pBlocks[block].predCount);
+	for(u32 e = this->pBlocks[block].preds; e != IrNone; e = this->pEdges[e].next)
+	{
+		values.push_back(this->readBlock(var, this->pEdges[e].from));
+	}
+
+	this->pInsts[phi].operands = this->pOperands.size();
+	this->pInsts[phi].count    = values.size();
+	this->pOperands.insert(this->pOperands.end(), values.begin(), values.end());
+}
+
+/**
+ * \brief values
+ */
+IrId Codegen::constant(IrType type, i64 value)
+{
+	IrId id = this->append(IrOp::Const, type, nullptr, 0);
+	this->pInsts[id].imm.i = value;
+	return id;
+}
+
+IrId Codegen::constant(f64 value)
+{
+	IrId id = this->append(IrOp::Const, IrType::F64, nullptr, 0);
+	this->pInsts[id].imm.f = value;
+	return id;
+}
+
+IrId Codegen::string(const std::string& value)
+{
+	IrId id = this->append(IrOp::Str, IrType::I64, nullptr, 0);
+	this->pInsts[id].symbol = this->symbol(value);
+	return id;
+}
+
+IrId Codegen::argument(u32 index, IrType type)
+{
+	IrId id = this->append(IrOp::Arg, type, nullptr, 0);
+	this->pInsts[id].imm.i = index;
+	return id;
+}
+
+IrId Codegen::binary(IrOp op, IrType type, IrId a, IrId b)
+{
+	IrId simple = this->simplify(op, type, a, b);
+	if(simple != IrNone)
+	{
+		return simple;
+	}
+
+	IrId operands[2] = { a, b };
+	return this->append(op, type, operands, 2);
+}
+
+/**
+ * \brief constant is converted in compile time by semantics of conversion
+ */
+IrId Codegen::convert(IrId value, IrType to)
+{
+	if(this->constOf(value))
+	{
+		const IrInst& c = this->pInsts[value];
+		OperatorValue v;
+		OperatorValue r;
+		v.type = c.type;
+		v.i    = c.type == IrType::F64 ? 0 : c.imm.i;
+		v.f    = c.type == IrType::F64 ? c.imm.f : 0.0;
+		//float out of integer range has no defined conversion
+		if(OperatorConvert(v, to, r))
+		{
+			return r.type == IrType::F64 ? this->constant(r.f) : this->constant(r.type, r.i);
+		}
+	}
+	return this->append(IrOp::Cvt, to, &value, 1);
+}
+
+/**
+ * \brief result of operation of constants by semantics of the operator (false when it has no result)
+ */
+static bool CodegenFold(IrOp op, IrType type, const IrInst& a, const IrInst& b, OperatorValue& r)
+{
+	switch(type)
+	{
+		case IrType::F64: { return OperatorEval(op, a.imm.f, b.imm.f, r); }
+		case IrType::U8:  { return OperatorEval(op, (u8)a.imm.i, (u8)b.imm.i, r); }
+		default:          { return OperatorEval(op, a.imm.i, b.imm.i, r); }
+	}
+}
+
+/**
+ * \brief exponent of power of two (-1 when value is not a power of two)
+ */
+static i32 CodegenLog2(i64 value)
+{
+	if(value <= 0 || (value & (value - 1)) != 0)
+	{
+		return -1;
+	}
+	i32 shift = 0;
+	while(((u64)1 << shift) != (u64)value)
+	{
+		shift++;
+	}
+	return shift;
+}
+
+/**
+ * \brief comparison with swapped operands
+ */
+static IrOp CodegenMirror(IrOp op)
+{
+	switch(op)
+	{
+		case IrOp::Lt: { return IrOp::Gt; }
+		case IrOp::Le: { return IrOp::Ge; }
+		case IrOp::Gt: { return IrOp::Lt; }
+		case IrOp::Ge: { return IrOp::Le; }
+		default:       { return op; }
+	}
+}
+
+/**
+ * \brief fold constants, apply algebraic identities and reduce strength of operation
+ * \note returns value computing the operation, IrNone when the operation is created as it is.
+ *       Constant operand of commutative operation goes to the right, so the identities
+ *       check only the second operand. Floats keep only identities exact for every value
+ *       (x + 0 is not x for negative zero).
+ */
+IrId Codegen::simplify(IrOp op, IrType type, IrId a, IrId b)
+{
+	if(this->constOf(a) && this->constOf(b))
+	{
+		OperatorValue r;
+		if(CodegenFold(op, type, this->pInsts[a], this->pInsts[b], r))
+		{
+			return r.type == IrType::F64 ? this->constant(r.f) : this->constant(r.type, r.i);
+		}
+		return IrNone;
+	}
+
+	if(this->constOf(a))
+	{
+		switch(op)
+		{
+			case IrOp::Add: case IrOp::Mul: case IrOp::Eq: case IrOp::Ne:
+			case IrOp::Lt:  case IrOp::Le:  case IrOp::Gt: case IrOp::Ge:
+			{
+				return this->binary(CodegenMirror(op), type, b, a);
+			}
+			default:
+			{
+				return IrNone;
+			}
+		}
+	}
+
+	if(type == IrType::F64)
+	{
+		f64 c = this->constOf(b) ? this->pInsts[b].imm.f : 0.0;
+		if(this->constOf(b) && (((op == IrOp::Mul || op == IrOp::Div) && c == 1.0) || (op == IrOp::Sub && c == 0.0)))
+		{
+			return a;
+		}
+		return IrNone;
+	}
+
+	//operation of value with itself
+	if(a == b)
+	{
+		switch(op)
+		{
+			case IrOp::Sub:                                 { return this->constant(type, 0); }
+			case IrOp::Eq: case IrOp::Le: case IrOp::Ge:    { return this->constant(IrType::I64, 1); }
+			case IrOp::Ne: case IrOp::Lt: case IrOp::Gt:    { return this->constant(IrType::I64, 0); }
+			default:                                        { return IrNone; }
+		}
+	}
+	if(!this->constOf(b))
+	{
+		return IrNone;
+	}
+
+	u64  mask  = type == IrType::U8 ? 0xff : ~0ull;
+	i64  c     = this->pInsts[b].imm.i;
+	IrOp inner = this->pInsts[a].op;
+	i32  shift = CodegenLog2(type == IrType::U8 ? (c & 0xff) : c);
+
+	switch(op)
+	{
+		case IrOp::Add:
+		case IrOp::Sub:
+		{
+			if(c == 0)
+			{
+				return a;
+			}
+			//(x + c1) + c2 = x + (c1 + c2), subtraction adds negated constant
+			if((inner == IrOp::Add || inner == IrOp::Sub) && this->constOf(this->operand(a, 1)))
+			{
+				u64 c1  = (u64)this->pInsts[this->operand(a, 1)].imm.i;
+				u64 sum = (inner == IrOp::Add ? c1 : 0 - c1) + (op == IrOp::Add ? (u64)c : 0 - (u64)c);
+				if(type == IrType::I64 && (i64)sum < 0 && sum != (u64)INT64_MIN)
+				{
+					return this->binary(IrOp::Sub, type, this->operand(a, 0), this->constant(type, (i64)(0 - sum)));
+				}
+				return this->binary(IrOp::Add, type, this->operand(a, 0), this->constant(type, (i64)(sum & mask)));
+			}
+			return IrNone;
+		}
+		case IrOp::Mul:
+		{
+			if((c & mask) == 0)
+			{
+				return this->constant(type, 0);
+			}
+			if((c & mask) == 1)
+			{
+				return a;
+			}
+			//(x * c1) * c2 = x * (c1 * c2)
+			if(inner == IrOp::Mul && this->constOf(this->operand(a, 1)))
+			{
+				u64 product = (u64)this->pInsts[this->operand(a, 1)].imm.i * (u64)c;
+				return this->binary(IrOp::Mul, type, this->operand(a, 0), this->constant(type, (i64)(product & mask)));
+			}
+			return this->pReduce != nullptr ? (this->*pReduce)(op, type, a, c, shift) : IrNone;
+		}
+		case IrOp::Div:
+		{
+			if((c & mask) == 1)
+			{
+				return a;
+			}
+			if(c == 0)
+			{
+				return IrNone;
+			}
+			return this->pReduce != nullptr ? (this->*pReduce)(op, type, a, c, shift) : IrNone;
+		}
+		default:
+		{
+			return IrNone;
+		}
+	}
+}
+
+/**
+ * \brief strength reduction of integer operation by constant c for costs of target Targets[T]
+ */
+template<u32 T>
+IrId Codegen::reduceTarget(IrOp op, IrType type, IrId a, i64 c, i32 shift)
+{
+	const Target& target = Targets[T];
+	if(op == IrOp::Mul)
+	{
+		if(shift > 0 && target.cost(IrOp::Shl, type) < target.cost(IrOp::Mul, type))
+		{
+			IrId operands[2] = { a, this->constant(type, shift) };
+			return this->append(IrOp::Shl, type, operands, 2);
+		}
+		return IrNone;
+	}
+
+	//bytes are unsigned
+	if(type == IrType::U8)
+	{
+		if(shift > 0 && target.cost(IrOp::Shr, type) < target.cost(IrOp::Div, type))
+		{
+			IrId operands[2] = { a, this->constant(type, shift) };
+			return this->append(IrOp::Shr, type, operands, 2);
+		}
+		return IrNone;
+	}
+	if(c > 1 && target.cost(IrOp::MulHi, type) + 4 * target.cost(IrOp::Add, type) < target.cost(IrOp::Div, type))
+	{
+		return this->divide(a, c);
+	}
+	return IrNone;
+}
+
+/**
+ * \brief signed division by constant greater than one without division instruction
+ * \note quotient rounds toward zero. Power of two: negative dividend is biased by divisor - 1
+ *       before arithmetic shift. Other divisors: high half of product with magic number
+ *       m = ceil(2^(64 + s) / d), shifted by s and corrected by one for negative dividend
+ *       (Granlund, Montgomery: Division by invariant integers using multiplication).
+ */
+IrId Codegen::divide(IrId value, i64 divisor)
+{
+	auto emit = [this](IrOp op, IrId a, IrId b)
+	{
+		IrId operands[2] = { a, b };
+		return this->append(op, IrType::I64, operands, 2);
+	};
+
+	i32 shift = CodegenLog2(divisor);
+	if(shift > 0)
+	{
+		IrId sign = emit(IrOp::Sar, value, this->constant(IrType::I64, 63));
+		IrId bias = emit(IrOp::Shr, sign, this->constant(IrType::I64, 64 - shift));
+		IrId sum  = emit(IrOp::Add, value, bias);
+		return emit(IrOp::Sar, sum, this->constant(IrType::I64, shift));
+	}
+
+	//the smallest p >= 64 for which 2^p / d fits the precision (Hacker's Delight 10-1)
+	const u64 two63 = (u64)1 << 63;
+	u64 d     = (u64)divisor;
+	u64 anc   = two63 - 1 - two63 % d;
+	u32 p     = 63;
+	u64 q1    = two63 / anc;
+	u64 r1    = two63 - q1 * anc;
+	u64 q2    = two63 / d;
+	u64 r2    = two63 - q2 * d;
+	u64 delta = 0;
+	do
+	{
+		p++;
+		q1 *= 2;
+		r1 *= 2;
+		if(r1 >= anc)
+		{
+			q1++;
+			r1 -= anc;
+		}
+		q2 *= 2;
+		r2 *= 2;
+		if(r2 >= d)
+		{
+			q2++;
+			r2 -= d;
+		}
+		delta = d - r2;
+	} while(q1 < delta || (q1 == delta && r1 == 0));
+
+	i64  magic = (i64)(q2 + 1);
+	IrId q     = emit(IrOp::MulHi, value, this->constant(IrType::I64, magic));
+	//magic number above 2^63 is negative, the product is corrected by the dividend
+	if(magic < 0)
+	{
+		q = emit(IrOp::Add, q, value);
+	}
+	if(p - 64 > 0)
+	{
+		q = emit(IrOp::Sar, q, this->constant(IrType::I64, p - 64));
+	}
+	IrId sign = emit(IrOp::Shr, value, this->constant(IrType::I64, 63));
+	return emit(IrOp::Add, q, sign);
+}
+
+IrId Codegen::call(const std::string& function, IrType type, const IrId* args, u16 count)
+{
+	IrId id = this->append(IrOp::Call, type, args, count);
+	this->pInsts[id].symbol = this->symbol(function);
+	return id;
+}
+
+IrId Codegen::result(IrId call, u32 index, IrType type)
+{
+	IrId id = this->append(IrOp::Result, type, &call, 1);
+	this->pInsts[id].imm.i = index;
+	return id;
+}
+
+/**
+ * \brief memory of globals and packages which are not scalarized
+ */
+IrId Codegen::load(const std::string& symbol, i64 offset, IrType type)
+{
+	IrId id = this->append(IrOp::Load, type, nullptr, 0);
+	this->pInsts[id].symbol = this->symbol(symbol);
+	this->pInsts[id].imm.i  = offset;
+	return id;
+}
+
+void Codegen::store(const std::string& symbol, i64 offset, IrType type, IrId value)
+{
+	IrId id = this->append(IrOp::Store, type, &value, 1);
+	this->pInsts[id].symbol = this->symbol(symbol);
+	this->pInsts[id].imm.i  = offset;
+}
+
+IrId Codegen::address(const std::string& symbol)
+{
+	IrId id = this->append(IrOp::Addr, IrType::I64, nullptr, 0);
+	this->pInsts[id].symbol = this->symbol(symbol);
+	return id;
+}
+
+void Codegen::copy(const std::string& symbol, IrId source, i64 size)
+{
+	IrId id = this->append(IrOp::Copy, IrType::None, &source, 1);
+	this->pInsts[id].symbol = this->symbol(symbol);
+	this->pInsts[id].imm.i  = size;
+}
+
+/**
+ * \brief memory at address value, the address is the last operand
+ */
+IrId Codegen::load(IrId address, i64 offset, IrType type)
+{
+	IrId id = this->append(IrOp::Load, type, &address, 1);
+	this->pInsts[id].imm.i = offset;
+	return id;
+}
+
+void Codegen::store(IrId address, i64 offset, IrType type, IrId value)
+{
+	IrId operands[2] = { value, address };
+	IrId id          = this->append(IrOp::Store, type, operands, 2);
+	this->pInsts[id].imm.i = offset;
+}
+
+void Codegen::copy(IrId address, IrId source, i64 size)
+{
+	IrId operands[2] = { source, address };
+	IrId id          = this->append(IrOp::Copy, IrType::None, operands, 2);
+	this->pInsts[id].imm.i = size;
+}
+
+/**
+ * \brief memory of local variable is live from declaration to the end of its scope
+ * \note variables with the same name in sibling scopes are one memory
+ */
+void Codegen::local(const std::string& name, u64 size, u64 align)
+{
+	u32 symbol = this->symbol(name);
+	for(IrLocal& l : this->pLocals)
+	{
+		if(l.symbol == symbol)
+		{
+			l.open = true;
+			l.blocks.push_back(this->pCurrent);
+			return;
+		}
+	}
+
+	IrLocal l;
+	l.symbol = symbol;
+	l.size   = size;
+	l.align  = align;
+	l.offset = 0;
+	l.open   = true;
+	l.blocks.push_back(this->pCurrent);
+	this->pLocals.push_back(std::move(l));
+}
+
+void Codegen::localEnd(const std::string& name)
+{
+	auto it = this->pSymbolIndex.find(name);
+	if(it == this->pSymbolIndex.end())
+	{
+		return;
+	}
+	for(IrLocal& l : this->pLocals)
+	{
+		if(l.symbol == it->second)
+		{
+			l.open = false;
+		}
+	}
+}
+
+/**
+ * \brief type of defined value
+ */
+IrType Codegen::valueType(IrId id) const
+{
+	const IrInst& inst = this->pInsts[id];
+	switch(inst.op)
+	{
+		case IrOp::Lt: case IrOp::Le: case IrOp::Gt:
+		case IrOp::Ge: case IrOp::Eq: case IrOp::Ne: { return IrType::I64; }
+		default:                                     { return inst.type; }
+	}
+}
+
+/**
+ * \brief create instruction at the end of the current block
+ */
+IrId Codegen::append(IrOp op, IrType type, const IrId* operands, u16 count)
+{
+	IrInst inst;
+	inst.op       = op;
+	inst.type     = type;
+	inst.count    = count;
+	inst.block    = this->pCurrent;
+	inst.next     = IrNone;
+	inst.operands = this->pOperands.size();
+	inst.symbol   = IrNone;
+	inst.imm.i    = 0;
+
+	this->pOperands.insert(this->pOperands.end(), operands, operands + count);
+	this->pInsts.push_back(inst);
+
+	IrId     id = this->pInsts.size() - 1;
+	IrBlock& b  = this->pBlocks[this->pCurrent];
+	if(b.last == IrNone)
+	{
+		b.first = id;
+	}
+	else
+	{
+		this->pInsts[b.last].next = id;
+	}
+	b.last = id;
+
+	return id;
+}
+
+/**
+ * \brief create instruction at the start of block (phi and undef)
+ */
+IrId Codegen::prepend(IrId block, IrOp op, IrType type)
+{
+	IrInst inst;
+	inst.op       = op;
+	inst.type     = type;
+	inst.count    = 0;
+	inst.block    = block;
+	inst.next     = this->pBlocks[block].first;
+	inst.operands = this->pOperands.size();
+	inst.symbol   = IrNone;
+	inst.imm.i    = 0;
+
+	this->pInsts.push_back(inst);
+
+	IrId     id = this->pInsts.size() - 1;
+	IrBlock& b  = this->pBlocks[block];
+	if(b.last == IrNone)
+	{
+		b.last = id;
+	}
+	b.first = id;
+
+	return id;
+}
+
+/**
+ * \brief link instruction into list of block before another instruction
+ */
+void Codegen::link(IrId id, IrId before)
+{
+	IrId  block = this->pInsts[before].block;
+	IrId* link  = &this->pBlocks[block].first;
+	while(*link != before)
+	{
+		link = &this->pInsts[*link].next;
+	}
+	*link                  = id;
+	this->pInsts[id].next  = before;
+	this->pInsts[id].block = block;
+}
+
+/**
+ * \brief intern name
+ */
+u32 Codegen::symbol(const std::string& name)
+{
+	auto it = this->pSymbolIndex.find(name);
+	if(it != this->pSymbolIndex.end())
+	{
+		return it->second;
+	}
+
+	this->pSymbols.push_back(name);
+	return this->pSymbolIndex[name] = this->pSymbols.size() - 1;
+}
+
+/**
+ * \brief remove edge from list of predecessors together with its phi operands
+ */
+void Codegen::unlink(IrId from, IrId to)
+{
+	IrBlock& t = this->pBlocks[to];
+
+	u32  index = 0;
+	u32* link  = &t.preds;
+	u32  last  = IrNone;
+	while(*link != IrNone && this->pEdges[*link].from != from)
+	{
+		last = *link;
+		link = &this->pEdges[*link].next;
+		index++;
+	}
+	if(*link == IrNone)
+	{
+		return;
+	}
+
+	if(*link == t.predsLast)
+	{
+		t.predsLast = last;
+	}
+	*link = this->pEdges[*link].next;
+	t.predCount--;
+
+	for(IrId i = t.first; i != IrNone; i = this->pInsts[i].next)
+	{
+		IrInst& phi = this->pInsts[i];
+		if(phi.op == IrOp::Phi && index < phi.count)
+		{
+			IrId* operands = &this->pOperands[phi.operands];
+			std::copy(operands + index + 1, operands + phi.count, operands + index);
+			phi.count--;
+		}
+	}
+}
+
+/**
+ * \brief value which replaced removed phi
+ */
+IrId Codegen::resolve(IrId value)
+{
+	while(this->pReplace[value] != value)
+	{
+		this->pReplace[value] = this->pReplace[this->pReplace[value]];
+		value = this->pReplace[value];
+	}
+	return value;
+}
+
+/**
+ * \brief finish function
+ * \note phi whose operands are only one value (or the phi itself) is replaced by the value
+ */
+void Codegen::finish()
+{
+	//edges out of unreachable blocks make their successors unreachable too
+	bool removed = true;
+	while(removed)
+	{
+		removed = false;
+		for(IrId b = 0; b < this->pBlocks.size(); b++)
+		{
+			if(this->live(b) || this->pBlocks[b].succ[0] == IrNone)
+			{
+				continue;
+			}
+			this->detach(b);
+			removed = true;
+		}
+	}
+
+	this->pReplace.resize(this->pInsts.size());
+	for(IrId i = 0; i < this->pInsts.size(); i++)
+	{
+		this->pReplace[i] = i;
+	}
+
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		for(IrId i = 0; i < this->pInsts.size(); i++)
+		{
+			if(this->pInsts[i].op != IrOp::Phi || this->pReplace[i] != i)
+			{
+				continue;
+			}
+
+			IrId same    = IrNone;
+			bool trivial = true;
+			for(u32 o = 0; o < this->pInsts[i].count; o++)
+			{
+				IrId v = this->resolve(this->operand(i, o));
+				if(v == i || v == same)
+				{
+					continue;
+				}
+				if(same != IrNone)
+				{
+					trivial = false;
+					break;
+				}
+				same = v;
+			}
+
+			//phi of unreachable block may have no other value
+			if(trivial && same != IrNone)
+			{
+				this->pReplace[i] = same;
+				changed           = true;
+			}
+		}
+	}
+
+	for(IrId& o : this->pOperands)
+	{
+		if(o != IrNone)
+		{
+			o = this->resolve(o);
+		}
+	}
+
+	//values are kept when they are used by instruction with side effect or by other kept value,
+	//folded operands and values of unused expressions are removed
+	this->pMarks.assign(this->pInsts.size(), 0);
+	this->pWork.clear();
+	for(const IrBlock& b : this->pBlocks)
+	{
+		for(IrId i = b.first; i != IrNone; i = this->pInsts[i].next)
+		{
+			switch(this->pInsts[i].op)
+			{
+				case IrOp::Arg:  case IrOp::Store: case IrOp::Copy: case IrOp::Call:
+				case IrOp::Ret:  case IrOp::Jump:  case IrOp::Branch:
+				{
+					this->pMarks[i] = 1;
+					this->pWork.push_back(i);
+					break;
+				}
+				default:
+				{
+					break;
+				}
+			}
+		}
+	}
+	while(this->pWork.size() != 0)
+	{
+		IrId i = this->pWork.back();
+		this->pWork.pop_back();
+		for(u32 o = 0; o < this->pInsts[i].count; o++)
+		{
+			IrId v = this->operand(i, o);
+			if(v != IrNone && this->pMarks[v] == 0)
+			{
+				this->pMarks[v] = 1;
+				this->pWork.push_back(v);
+			}
+		}
+	}
+
+	//unlink removed phi and unused instructions
+	for(IrBlock& b : this->pBlocks)
+	{
+		IrId* link = &b.first;
+		IrId  last = IrNone;
+		while(*link != IrNone)
+		{
+			if(this->pReplace[*link] != *link || this->pMarks[*link] == 0)
+			{
+				*link = this->pInsts[*link].next;
+				continue;
+			}
+			last = *link;
+			link = &this->pInsts[*link].next;
+		}
+		b.last = last;
+	}
+}
+
+/**
+ * \brief create instruction before another one in its block
+ */
+IrId Codegen::insert(IrId before, IrOp op, IrType type, const IrId* operands, u16 count)
+{
+	IrInst inst;
+	inst.op       = op;
+	inst.type     = type;
+	inst.count    = count;
+	inst.block    = IrNone;
+	inst.next     = IrNone;
+	inst.operands = this->pOperands.size();
+	inst.symbol   = IrNone;
+	inst.imm.i    = 0;
+
+	this->pOperands.insert(this->pOperands.end(), operands, operands + count);
+	this->pInsts.push_back(inst);
+
+	IrId id = this->pInsts.size() - 1;
+	this->link(id, before);
+	return id;
+}
+
+/**
+ * \brief create phi instruction at the start of block, operands follow predecessors
+ */
+IrId Codegen::phi(IrId block, IrType type, const IrId* operands, u16 count)
+{
+	IrId id = this->prepend(block, IrOp::Phi, type);
+	this->pInsts[id].operands = this->pOperands.size();
+	this->pInsts[id].count    = count;
+	this->pOperands.insert(this->pOperands.end(), operands, operands + count);
+	return id;
+}
+
+/**
+ * \brief move instruction before terminator of block
+ */
+void Codegen::move(IrId id, IrId block)
+{
+	IrBlock& from = this->pBlocks[this->pInsts[id].block];
+	IrId*    link = &from.first;
+	IrId     prev = IrNone;
+	while(*link != id)
+	{
+		prev = *link;
+		link = &this->pInsts[*link].next;
+	}
+	*link = this->pInsts[id].next;
+	if(from.last == id)
+	{
+		from.last = prev;
+	}
+
+	this->link(id, this->pBlocks[block].last);
+}
+
+/**
+ * \brief instruction becomes constant, its operands are removed by finish when they are unused
+ */
+void Codegen::setConstant(IrId id, IrType type, i64 value)
+{
+	IrInst& inst = this->pInsts[id];
+	inst.op      = IrOp::Const;
+	inst.type    = type;
+	inst.count   = 0;
+	inst.symbol  = IrNone;
+	inst.imm.i   = value;
+}
+
+void Codegen::setConstant(IrId id, f64 value)
+{
+	this->setConstant(id, IrType::F64, 0);
+	this->pInsts[id].imm.f = value;
+}
+
+/**
+ * \brief operation created by binary
+ */
+static bool CodegenBinary(IrOp op)
+{
+	switch(op)
+	{
+		case IrOp::Add: case IrOp::Sub: case IrOp::Mul: case IrOp::Div:
+		case IrOp::Shl: case IrOp::Shr: case IrOp::Sar: case IrOp::MulHi:
+		case IrOp::Lt:  case IrOp::Le:  case IrOp::Gt:  case IrOp::Ge:
+		case IrOp::Eq:  case IrOp::Ne:                   { return true; }
+		default:                                         { return false; }
+	}
+}
+
+/**
+ * \brief simplify binary operations of finished function again
+ * \note operation is simplified as if it was created with its current operands, the value which
+ *       computes it replaces it. Values created by simplification are appended to the block of
+ *       the operation and moved before it, so they are simplified by the next round, rounds repeat
+ *       until nothing changes ((x + 1) + 1 of unrolled copies becomes x + 2).
+ */
+void Codegen::resimplify()
+{
+	IrId current = this->pCurrent;
+	bool changed = true;
+	bool any     = false;
+
+	this->pReplace.resize(this->pInsts.size());
+	for(IrId i = 0; i < this->pInsts.size(); i++)
+	{
+		this->pReplace[i] = i;
+	}
+	while(changed)
+	{
+		changed = false;
+		for(IrId b = 0; b < this->pBlocks.size(); b++)
+		{
+			if(!this->live(b))
+			{
+				continue;
+			}
+			for(IrId i = this->pBlocks[b].first; i != IrNone; i = this->pInsts[i].next)
+			{
+				for(u32 o = 0; o < this->pInsts[i].count; o++)
+				{
+					if(this->operand(i, o) != IrNone)
+					{
+						this->setOperand(i, o, this->resolve(this->operand(i, o)));
+					}
+				}
+				if(!CodegenBinary(this->pInsts[i].op) || this->pReplace[i] != i)
+				{
+					continue;
+				}
+
+				IrId last      = this->pBlocks[b].last;
+				this->pCurrent = b;
+				IrId simple    = this->simplify(this->pInsts[i].op, this->pInsts[i].type, this->operand(i, 0), this->operand(i, 1));
+				IrId created   = this->pInsts[last].next;
+				this->pInsts[last].next = IrNone;
+				this->pBlocks[b].last   = last;
+				while(created != IrNone)
+				{
+					IrId next = this->pInsts[created].next;
+					this->link(created, i);
+					created = next;
+				}
+				while(this->pReplace.size() < this->pInsts.size())
+				{
+					this->pReplace.push_back(this->pReplace.size());
+				}
+
+				if(simple != IrNone && simple != i)
+				{
+					this->pReplace[i] = simple;
+					changed           = true;
+					any               = true;
+				}
+			}
+		}
+	}
+	this->pCurrent = current;
+
+	//replaced operations are unused, finish removes them
+	if(any)
+	{
+		for(IrId& o : this->pOperands)
+		{
+			if(o != IrNone)
+			{
+				o = this->resolve(o);
+			}
+		}
+		this->finish();
+	}
+}
+
+/**
+ * \brief branch of block always goes to successor succ (0 when condition is true)
+ */
+void Codegen::takeBranch(IrId block, u32 succ)
+{
+	IrBlock& b    = this->pBlocks[block];
+	IrInst&  last = this->pInsts[b.last];
+	IrId     to   = b.succ[succ];
+
+	last.op    = IrOp::Jump;
+	last.count = 0;
+	//both successors can be the same block, one of its edges is removed
+	this->unlink(block, b.succ[1 - succ]);
+	b.succ[0] = to;
+	b.succ[1] = IrNone;
+}
+
+/**
+ * \brief remove edges out of block (block is never executed)
+ */
+void Codegen::detach(IrId block)
+{
+	IrBlock& b = this->pBlocks[block];
+	for(IrId s : b.succ)
+	{
+		if(s != IrNone)
+		{
+			this->unlink(block, s);
+		}
+	}
+	b.succ[0] = IrNone;
+	b.succ[1] = IrNone;
+}
+
+/**
+ * \brief append successor of block to the block (false when it can't be merged)
+ * \note successor has no phi instructions because it has only one predecessor,
+ *       its edges and scopes of local variables move to the block
+ */
+bool Codegen::merge(IrId block)
+{
+	IrBlock& b = this->pBlocks[block];
+	IrId     s = b.succ[0];
+	if(!this->live(block) || b.last == IrNone || this->pInsts[b.last].op != IrOp::Jump ||
+	   s == block || s == 0 || this->pBlocks[s].predCount != 1)
+	{
+		return false;
+	}
+	IrBlock& next = this->pBlocks[s];
+	if(next.first != IrNone && this->pInsts[next.first].op == IrOp::Phi)
+	{
+		return false;
+	}
+
+	//drop the jump and link instructions of successor
+	IrId  prev = IrNone;
+	IrId* link = &b.first;
+	while(*link != b.last)
+	{
+		prev = *link;
+		link = &this->pInsts[*link].next;
+	}
+	*link  = next.first;
+	b.last = prev;
+	for(IrId i = next.first; i != IrNone; i = this->pInsts[i].next)
+	{
+		this->pInsts[i].block = block;
+		b.last                = i;
+	}
+
+	for(IrId t : next.succ)
+	{
+		for(u32 e = t != IrNone ? this->pBlocks[t].preds : IrNone; e != IrNone; e = this->pEdges[e].next)
+		{
+			if(this->pEdges[e].from == s)
+			{
+				this->pEdges[e].from = block;
+			}
+		}
+	}
+	b.succ[0]      = next.succ[0];
+	b.succ[1]      = next.succ[1];
+	next.first     = IrNone;
+	next.last      = IrNone;
+	next.preds     = IrNone;
+	next.predsLast = IrNone;
+	next.predCount = 0;
+	next.succ[0]   = IrNone;
+	next.succ[1]   = IrNone;
+
+	for(IrLocal& l : this->pLocals)
+	{
+		std::replace(l.blocks.begin(), l.blocks.end(), s, block);
+	}
+	return true;
+}
+
+/**
+ * \brief new block in scopes of local variables of block
+ */
+IrId Codegen::copyBlock(IrId block)
+{
+	IrId copy = this->block();
+	for(IrLocal& l : this->pLocals)
+	{
+		if(std::find(l.blocks.begin(), l.blocks.end(), block) != l.blocks.end())
+		{
+			l.blocks.push_back(copy);
+		}
+	}
+	return copy;
+}
+
+/**
+ * \brief copy of instruction at the end of block
+ */
+IrId Codegen::copy(IrId id, IrId block)
+{
+	IrInst inst   = this->pInsts[id];
+	inst.block    = block;
+	inst.next     = IrNone;
+	inst.operands = this->pOperands.size();
+	for(u32 o = 0; o < inst.count; o++)
+	{
+		IrId value = this->operand(id, o);
+		this->pOperands.push_back(value);
+	}
+	this->pInsts.push_back(inst);
+
+	IrId     copy = this->pInsts.size() - 1;
+	IrBlock& b    = this->pBlocks[block];
+	if(b.last == IrNone)
+	{
+		b.first = copy;
+	}
+	else
+	{
+		this->pInsts[b.last].next = copy;
+	}
+	b.last = copy;
+	return copy;
+}
+
+/**
+ * \brief edge into block with phi instructions, their operands move to the end of arena
+ */
+u32 Codegen::addEdge(IrId from, IrId to)
+{
+	this->edge(from, to);
+	for(IrId i = this->pBlocks[to].first; i != IrNone; i = this->pInsts[i].next)
+	{
+		IrInst& phi = this->pInsts[i];
+		if(phi.op != IrOp::Phi)
+		{
+			continue;
+		}
+		u32 start = this->pOperands.size();
+		this->pOperands.resize(start + phi.count + 1, IrNone);
+		std::copy(this->pOperands.begin() + phi.operands, this->pOperands.begin() + phi.operands + phi.count,
+		          this->pOperands.begin() + start);
+		phi.operands = start;
+		phi.count++;
+	}
+	return this->pBlocks[to].predCount - 1;
+}
+
+/**
+ * \brief edge from block to another target (operands of phi instructions of the old target are removed)
+ */
+u32 Codegen::retarget(IrId from, IrId to, IrId target)
+{
+	IrBlock& b = this->pBlocks[from];
+	this->unlink(from, to);
+	b.succ[b.succ[0] == to ? 0 : 1] = IrNone;
+	return this->addEdge(from, target);
+}
+
+/**
+ * \brief jump at the end of block becomes branch to its target when cond is true and to block to otherwise
+ */
+u32 Codegen::addBranch(IrId block, IrId cond, IrId to)
+{
+	IrInst& last  = this->pInsts[this->pBlocks[block].last];
+	last.op       = IrOp::Branch;
+	last.count    = 1;
+	last.operands = this->pOperands.size();
+	this->pOperands.push_back(cond);
+	return this->addEdge(block, to);
+}
+
+/**
+ * \brief replace order of instructions of block
+ */
+void Codegen::schedule(IrId block, const IrId* order, u32 count)
+{
+	IrBlock& b = this->pBlocks[block];
+
+	b.first = count != 0 ? order[0] : IrNone;
+	b.last  = count != 0 ? order[count - 1] : IrNone;
+	for(u32 i = 0; i < count; i++)
+	{
+		this->pInsts[order[i]].next = i + 1 < count ? order[i + 1] : IrNone;
+	}
+}
+
+/**
+ * \brief assign register or stack slot to value
+ */
+void Codegen::locate(IrId id, u32 location)
+{
+	if(this->pLocations.size() < this->pInsts.size())
+	{
+		this->pLocations.resize(this->pInsts.size(), IrNone);
+	}
+	this->pLocations[id] = location;
+}
+
+/**
+ * \brief location of value (@r1 integer register, @f1 float register, @[8] stack slot at offset in frame)
+ */
+static void CodegenLocation(std::string& out, u32 location)
+{
+	if(location == IrNone)
+	{
+		return;
+	}
+	if((location & IrSlot) != 0)
+	{
+		CodegenPrint(out, " @[%u]", location & ~IrSlot);
+	}
+	else if((location & IrFloat) != 0)
+	{
+		CodegenPrint(out, " @f%u", location & ~IrFloat);
+	}
+	else
+	{
+		CodegenPrint(out, " @r%u", location);
+	}
+}
+
+/**
+ * \brief append text form of the function
+ */
+void Codegen::print(std::string& out) const
+{
+	CodegenPrint(out, "function %s\n", this->pName.c_str());
+	if(this->pFrame != 0)
+	{
+		CodegenPrint(out, "\tframe %llu bytes\n", (unsigned long long)this->pFrame);
+	}
+	if(this->pSaved != 0)
+	{
+		//integer registers are the low half of the mask, float registers the high half
+		CodegenPrint(out, "\tsaved");
+		for(u32 r = 0; r < 64; r++)
+		{
+			if((this->pSaved & (1ull << r)) != 0)
+			{
+				CodegenPrint(out, r < 32 ? " r%u" : " f%u", r % 32);
+			}
+		}
+		CodegenPrint(out, "\n");
+	}
+	for(const IrLocal& l : this->pLocals)
+	{
+		CodegenPrint(out, "\tlocal %s [%llu], %llu bytes\n", this->pSymbols[l.symbol].c_str(), (unsigned long long)l.offset,
+			(unsigned long long)l.size);
+	}
+
+	//memory of instruction is its symbol or the address in its last operand
+	auto memory = [this](IrId i)
+	{
+		const IrInst& inst = this->pInsts[i];
+		if(inst.symbol != IrNone)
+		{
+			return this->pSymbols[inst.symbol];
+		}
+		return "%" + std::to_string(this->operand(i, inst.count - 1));
+	};
+
+	for(IrId b = 0; b < this->pBlocks.size(); b++)
+	{
+		const IrBlock& block = this->pBlocks[b];
+
+		if(!this->live(b))
+		{
+			continue;
+		}
+
+		CodegenPrint(out, "b%u:", b);
+		if(block.predCount != 0)
+		{
+			CodegenPrint(out, " preds");
+			for(u32 e = block.preds; e != IrNone; e = this->pEdges[e].next)
+			{
+				CodegenPrint(out, " b%u", this->pEdges[e].from);
+			}
+		}
+		CodegenPrint(out, "\n");
+
+		for(IrId i = block.first; i != IrNone; i = this->pInsts[i].next)
+		{
+			const IrInst& inst = this->pInsts[i];
+			const char*   name = CodegenOpName[(u32)inst.op];
+			const char*   type = CodegenTypeName[(u32)inst.type];
+
+			out.push_back('\t');
+			switch(inst.op)
+			{
+				case IrOp::Const:
+				{
+					if(inst.type == IrType::F64)
+					{
+						CodegenPrint(out, "%%%u = const.f64 ", i);
+						EmitterFloat(out, inst.imm.f);
+					}
+					else
+					{
+						CodegenPrint(out, "%%%u = const.%s %lli", i, type, (long long)inst.imm.i);
+					}
+					break;
+				}
+				case IrOp::Undef:  { CodegenPrint(out, "%%%u = undef.%s", i, type); break; }
+				case IrOp::Str:    { CodegenPrint(out, "%%%u = str \"%s\"", i, this->pSymbols[inst.symbol].c_str()); break; }
+				case IrOp::Arg:    { CodegenPrint(out, "%%%u = arg.%s %lli", i, type, (long long)inst.imm.i); break; }
+				case IrOp::Phi:
+				{
+					CodegenPrint(out, "%%%u = phi.%s", i, type);
+					u32 e = block.preds;
+					for(u32 o = 0; o < inst.count; o++, e = this->pEdges[e].next)
+					{
+						CodegenPrint(out, "%s %%%u [b%u]", o == 0 ? "" : ",", this->operand(i, o), this->pEdges[e].from);
+					}
+					break;
+				}
+				case IrOp::Cvt:
+				{
+					IrId value = this->operand(i, 0);
+					CodegenPrint(out, "%%%u = cvt.%s.%s %%%u", i, type, CodegenTypeName[(u32)this->valueType(value)], value);
+					break;
+				}
+				case IrOp::Load:
+				{
+					CodegenPrint(out, "%%%u = load.%s [%s + %lli]", i, type, memory(i).c_str(), (long long)inst.imm.i);
+					break;
+				}
+				case IrOp::Store:
+				{
+					CodegenPrint(out, "store.%s [%s + %lli], %%%u", type, memory(i).c_str(), (long long)inst.imm.i, this->operand(i, 0));
+					break;
+				}
+				case IrOp::Addr:   { CodegenPrint(out, "%%%u = addr %s", i, this->pSymbols[inst.symbol].c_str()); break; }
+				case IrOp::Copy:
+				{
+					CodegenPrint(out, "copy [%s], [%%%u], %lli", memory(i).c_str(), this->operand(i, 0), (long long)inst.imm.i);
+					break;
+				}
+				case IrOp::Call:
+				{
+					//results of package are taken from the call by result instruction
+					if(inst.type != IrType::None)
+					{
+						CodegenPrint(out, "%%%u = call.%s ", i, type);
+					}
+					else
+					{
+						CodegenPrint(out, "%%%u = call ", i);
+					}
+					CodegenPrint(out, "%s(", this->pSymbols[inst.symbol].c_str());
+					for(u32 o = 0; o < inst.count; o++)
+					{
+						CodegenPrint(out, "%s%%%u", o == 0 ? "" : ", ", this->operand(i, o));
+					}
+					CodegenPrint(out, ")");
+					break;
+				}
+				case IrOp::Result: { CodegenPrint(out, "%%%u = result.%s %%%u, %lli", i, type, this->operand(i, 0), (long long)inst.imm.i); break; }
+				case IrOp::Ret:
+				{
+					CodegenPrint(out, "ret");
+					for(u32 o = 0; o < inst.count; o++)
+					{
+						CodegenPrint(out, "%s %%%u", o == 0 ? "" : ",", this->operand(i, o));
+					}
+					break;
+				}
+				case IrOp::Jump:   { CodegenPrint(out, "jmp b%u", block.succ[0]); break; }
+				case IrOp::Branch: { CodegenPrint(out, "br %%%u, b%u, b%u", this->operand(i, 0), block.succ[0], block.succ[1]); break; }
+				//binary operations
+				default:
+				{
+					CodegenPrint(out, "%%%u = %s.%s %%%u, %%%u", i, name, type, this->operand(i, 0), this->operand(i, 1));
+					break;
+				}
+			}
+			CodegenLocation(out, this->location(i));
+			out.push_back('\n');
+		}
+	}
+}
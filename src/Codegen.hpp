@@ -0,0 +1,374 @@
+#pragma once
+
+#include "types.hpp"
+
+struct Target;
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * \brief id of instruction (and of the value it defines), block or variable inside one function
+ */
+typedef u32 IrId;
+static constexpr IrId IrNone = 0xffffffff;
+
+/**
+ * \brief type of value (same order as Parser::ValueType)
+ */
+enum class IrType : u8
+{
+	U8,
+	I64,
+	F64,
+	None,
+};
+
+/**
+ * \brief location of value assigned by register allocation
+ * \note integer register index, float register (IrFloat | index) or stack slot (IrSlot | offset in frame),
+ *       IrNone for immediate operands (constants) and instructions without value
+ */
+static constexpr u32 IrSlot  = 0x80000000;
+static constexpr u32 IrFloat = 0x40000000;
+
+/**
+ * \brief instructions of intermediate representation
+ * \note X(op, mnemonic)
+ */
+#define IR_OPS(X) \
+	X(Const,  "const")  \
+	X(Undef,  "undef")  \
+	X(Str,    "str")    \
+	X(Arg,    "arg")    \
+	X(Phi,    "phi")    \
+	X(Add,    "add")    \
+	X(Sub,    "sub")    \
+	X(Mul,    "mul")    \
+	X(Div,    "div")    \
+	X(Shl,    "shl")    \
+	X(Shr,    "shr")    \
+	X(Sar,    "sar")    \
+	X(MulHi,  "mulh")   \
+	X(Lt,     "lt")     \
+	X(Le,     "le")     \
+	X(Gt,     "gt")     \
+	X(Ge,     "ge")     \
+	X(Eq,     "eq")     \
+	X(Ne,     "ne")     \
+	X(Cvt,    "cvt")    \
+	X(Load,   "load")   \
+	X(Store,  "store")  \
+	X(Addr,   "addr")   \
+	X(Copy,   "copy")   \
+	X(Call,   "call")   \
+	X(Result, "result") \
+	X(Ret,    "ret")    \
+	X(Jump,   "jmp")    \
+	X(Branch, "br")
+
+#define IR_OP_ENUM(op, name) op,
+enum class IrOp : u8
+{
+	IR_OPS(IR_OP_ENUM)
+};
+#undef IR_OP_ENUM
+
+/**
+ * \brief instruction
+ * \note type is the type of the operation (comparisons define i64 value),
+ *       operands are stored in operand arena of the function
+ */
+struct IrInst
+{
+	IrOp   op;
+	IrType type;
+	u16    count;
+	//owning block and next instruction of the block
+	IrId   block;
+	IrId   next;
+	//first operand in operand arena
+	u32    operands;
+	//variable, function or string literal (IrNone when unused)
+	u32    symbol;
+	//constant, argument index, memory offset, copied size or index of call result
+	union
+	{
+		i64 i;
+		f64 f;
+	} imm;
+};
+
+/**
+ * \brief basic block
+ * \note predecessors are linked list in edge arena, operands of phi instructions follow its order
+ */
+struct IrBlock
+{
+	IrId first;
+	IrId last;
+	u32  preds;
+	u32  predsLast;
+	u32  predCount;
+	IrId succ[2];
+	//phi instructions waiting for predecessors of unsealed block
+	u32  pending;
+	bool sealed;
+};
+
+/**
+ * \brief memory of local variable (package which is not scalarized)
+ * \note variable is live in blocks entered while its scope is open, offset is assigned by frame layout
+ */
+struct IrLocal
+{
+	u32               symbol;
+	u64               size;
+	u64               align;
+	u64               offset;
+	bool              open;
+	std::vector<IrId> blocks;
+};
+
+/**
+ * \brief SSA intermediate representation of one function
+ * \note everything is stored in dense arrays indexed by 32-bit ids, arrays keep their memory
+ *       between functions. Values of variables are tracked per block and phi instructions
+ *       are created on demand, block is sealed when all its predecessors are known.
+ */
+class Codegen
+{
+public:
+	Codegen() { this->pReduce = nullptr; }
+
+	/**
+	 * \brief start new function, its entry block becomes the current block
+	 * \note source is byte offset of the function body in preprocessed source (line information)
+	 */
+	void begin(const std::string& name, u64 source = 0);
+	/**
+	 * \brief costs of target decide strength reduction (nullptr = operations are kept)
+	 */
+	void setTarget(const Target* target);
+	/**
+	 * \brief finish function (removes trivial phi instructions and unused values)
+	 */
+	void finish();
+	/**
+	 * \brief append text form of the function
+	 */
+	void print(std::string& out) const;
+
+	/**
+	 * \brief control flow
+	 * \note block is sealed when no more predecessors will be added,
+	 *       jumps out of unreachable block are dropped
+	 */
+	IrId block();
+	void enter(IrId block);
+	IrId current() const   { return this->pCurrent; }
+	void seal(IrId block);
+	bool terminated() const;
+	bool unreachable() const;
+	void jump(IrId to);
+	void branch(IrId cond, IrId ifTrue, IrId ifFalse);
+	/**
+	 * \brief return values, following code is unreachable
+	 */
+	void ret(const IrId* values, u16 count);
+
+	/**
+	 * \brief local variables in SSA form
+	 */
+	IrId variable(IrType type);
+	void write(IrId var, IrId value);
+	IrId read(IrId var);
+
+	/**
+	 * \brief values
+	 */
+	IrId constant(IrType type, i64 value);
+	IrId constant(f64 value);
+	IrId string(const std::string& value);
+	IrId argument(u32 index, IrType type);
+	/**
+	 * \brief binary operation is simplified when it is created, constants are folded
+	 *        and the result can be an existing value
+	 */
+	IrId binary(IrOp op, IrType type, IrId a, IrId b);
+	IrId convert(IrId value, IrType to);
+	IrId call(const std::string& function, IrType type, const IrId* args, u16 count);
+	IrId result(IrId call, u32 index, IrType type);
+
+	/**
+	 * \brief memory of globals and packages which are not scalarized
+	 */
+	IrId load(const std::string& symbol, i64 offset, IrType type);
+	void store(const std::string& symbol, i64 offset, IrType type, IrId value);
+	IrId address(const std::string& symbol);
+	void copy(const std::string& symbol, IrId source, i64 size);
+	/**
+	 * \brief memory at address value (package passed by the caller), instruction has no symbol
+	 *        and the address is its last operand
+	 */
+	IrId load(IrId address, i64 offset, IrType type);
+	void store(IrId address, i64 offset, IrType type, IrId value);
+	void copy(IrId address, IrId source, i64 size);
+	/**
+	 * \brief memory of local variable is live from declaration to the end of its scope
+	 */
+	void local(const std::string& name, u64 size, u64 align);
+	void localEnd(const std::string& name);
+
+	/**
+	 * \brief read access for passes
+	 */
+	u64            instCount() const                { return this->pInsts.size(); }
+	u64            blockCount() const               { return this->pBlocks.size(); }
+	const IrInst&  inst(IrId id) const              { return this->pInsts[id]; }
+	const IrBlock& block(IrId id) const             { return this->pBlocks[id]; }
+	IrId           operand(IrId id, u32 i) const    { return this->pOperands[this->pInsts[id].operands + i]; }
+	IrType         valueType(IrId id) const;
+	const std::string& name() const                 { return this->pName; }
+	u64            source() const                   { return this->pSource; }
+	const std::string& symbolName(u32 symbol) const { return this->pSymbols[symbol]; }
+	u32            symbolCount() const              { return this->pSymbols.size(); }
+	//predecessors of block (in order of phi operands)
+	IrId           edgeFrom(u32 edge) const         { return this->pEdges[edge].from; }
+	u32            edgeNext(u32 edge) const         { return this->pEdges[edge].next; }
+	u64            edgeCount() const                { return this->pEdges.size(); }
+	//code of block without predecessors (except entry) is never executed
+	bool           live(IrId block) const           { return block == 0 || this->pBlocks[block].predCount != 0; }
+
+	/**
+	 * \brief transformations for passes (finish cleans up after them)
+	 * \note operand can be replaced by equal value which dominates the instruction,
+	 *       new instruction is inserted before another one, phi at the start of block and instruction
+	 *       moves before terminator of another block (operands must dominate the new place),
+	 *       instruction becomes constant in place so its uses stay valid, branch becomes jump
+	 *       to one of its successors, detached block loses its successors, block ending with jump
+	 *       absorbs its successor when it is the only predecessor of the successor.
+	 *       Copied block belongs to the scopes of its original, copied instruction is appended to block
+	 *       with the same operands, new edge gives every phi of its target operand IrNone (its index
+	 *       is returned, the pass sets it), edge can move to another target and jump can become branch
+	 *       whose condition keeps the jump target (the new target is taken when it is false).
+	 *       Binary operations are simplified again when passes made their operands constant or equal
+	 *       (copies of unrolled loop), values created by simplification are inserted before them
+	 */
+	void           setOperand(IrId id, u32 i, IrId value) { this->pOperands[this->pInsts[id].operands + i] = value; }
+	IrId           insert(IrId before, IrOp op, IrType type, const IrId* operands, u16 count);
+	IrId           phi(IrId block, IrType type, const IrId* operands, u16 count);
+	void           move(IrId id, IrId block);
+	void           setConstant(IrId id, IrType type, i64 value);
+	void           setConstant(IrId id, f64 value);
+	void           takeBranch(IrId block, u32 succ);
+	void           detach(IrId block);
+	bool           merge(IrId block);
+	IrId           copyBlock(IrId block);
+	IrId           copy(IrId id, IrId block);
+	u32            addEdge(IrId from, IrId to);
+	u32            retarget(IrId from, IrId to, IrId target);
+	u32            addBranch(IrId block, IrId cond, IrId to);
+	void           resimplify();
+
+	/**
+	 * \brief results of register allocation
+	 * \note schedule replaces order of instructions of block (the same instructions in new order)
+	 */
+	void           schedule(IrId block, const IrId* order, u32 count);
+	void           locate(IrId id, u32 location);
+	u32            location(IrId id) const          { return id < this->pLocations.size() ? this->pLocations[id] : IrNone; }
+	void           setFrame(u64 size)               { this->pFrame = size; }
+	u64            frame() const                    { return this->pFrame; }
+	void           setSaved(u64 registers)          { this->pSaved = registers; }
+	u64            saved() const                    { return this->pSaved; }
+	u32            localCount() const               { return this->pLocals.size(); }
+	IrLocal&       local(u32 index)                 { return this->pLocals[index]; }
+	const IrLocal& local(u32 index) const           { return this->pLocals[index]; }
+
+private:
+
+	/**
+	 * \brief predecessor edge
+	 */
+	struct Edge
+	{
+		IrId from;
+		u32  next;
+	};
+	/**
+	 * \brief phi instruction waiting for sealing of its block
+	 */
+	struct Pending
+	{
+		IrId var;
+		IrId phi;
+		u32  next;
+	};
+
+	std::string          pName;
+	u64                  pSource;
+	IrId                 pCurrent;
+	IrId (Codegen::*     pReduce)(IrOp op, IrType type, IrId a, i64 c, i32 shift);
+
+	std::vector<IrInst>  pInsts;
+	std::vector<IrBlock> pBlocks;
+	std::vector<IrId>    pOperands;
+	std::vector<Edge>    pEdges;
+	std::vector<Pending> pPending;
+
+	//type of every variable and its value at the end of block (variable << 32 | block)
+	std::vector<IrType>                pVars;
+	std::unordered_map<u64, IrId>      pDefs;
+
+	//names of variables, functions and string literals
+	std::vector<std::string>           pSymbols;
+	std::unordered_map<std::string, u32> pSymbolIndex;
+
+	//replacement of removed phi instructions, instructions reached from side effects
+	std::vector<IrId>    pReplace;
+	std::vector<u8>      pMarks;
+	std::vector<IrId>    pWork;
+
+	//location of every value, memory of local variables, size of the frame and mask of registers saved in it
+	std::vector<u32>     pLocations;
+	std::vector<IrLocal> pLocals;
+	u64                  pFrame;
+	u64                  pSaved;
+
+	/**
+	 * \brief create instruction at the end of the current block or at the start of given block
+	 */
+	IrId append(IrOp op, IrType type, const IrId* operands, u16 count);
+	IrId prepend(IrId block, IrOp op, IrType type);
+	void link(IrId id, IrId before);
+	u32  symbol(const std::string& name);
+	void edge(IrId from, IrId to);
+	void unlink(IrId from, IrId to);
+
+	/**
+	 * \brief value of variable in block, phi operands are values in predecessors
+	 */
+	IrId readBlock(IrId var, IrId block);
+	void phiOperands(IrId var, IrId phi);
+	IrId resolve(IrId value);
+
+	/**
+	 * \brief constant folding, algebraic identities and strength reduction of binary operation
+	 */
+	IrId simplify(IrOp op, IrType type, IrId a, IrId b);
+	IrId divide(IrId value, i64 divisor);
+	/**
+	 * \brief strength reduction of integer operation by constant c for costs of target Targets[T]
+	 *        and instances for all targets (shift is log2 of c, -1 when it isn't power of two)
+	 */
+	template<u32 T>
+	IrId reduceTarget(IrOp op, IrType type, IrId a, i64 c, i32 shift);
+	using Reduce = IrId (Codegen::*)(IrOp op, IrType type, IrId a, i64 c, i32 shift);
+	template<std::size_t... T>
+	static constexpr std::array<Reduce, sizeof...(T)> reductions(std::index_sequence<T...>) { return {{ &Codegen::reduceTarget<T>... }}; }
+	bool constOf(IrId value) const { return this->pInsts[value].op == IrOp::Const; }
+};
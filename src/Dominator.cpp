@@ -0,0 +1,149 @@
+#include "Dominator.hpp"
+
+#include <algorithm>
+
+/**
+ * \brief compute dominator tree of live blocks reached from the entry
+ */
+void Dominator::run(const Codegen& code)
+{
+	u64 blocks = code.blockCount();
+	this->pOrder.clear();
+	this->pNumber.assign(blocks, IrNone);
+	this->pIdom.assign(blocks, IrNone);
+
+	//postorder by depth first search, successor index of every block on the stack is in pLast
+	this->pLast.assign(blocks, 0);
+	this->pStack.clear();
+	this->pStack.push_back(0);
+	this->pNumber[0] = 0;
+	while(this->pStack.size() != 0)
+	{
+		IrId b = this->pStack.back();
+		if(this->pLast[b] < 2)
+		{
+			IrId s = code.block(b).succ[this->pLast[b]++];
+			if(s != IrNone && this->pNumber[s] == IrNone)
+			{
+				this->pNumber[s] = 0;
+				this->pStack.push_back(s);
+			}
+			continue;
+		}
+		this->pStack.pop_back();
+		this->pOrder.push_back(b);
+	}
+	std::reverse(this->pOrder.begin(), this->pOrder.end());
+	for(u32 i = 0; i < this->pOrder.size(); i++)
+	{
+		this->pNumber[this->pOrder[i]] = i;
+	}
+
+	//immediate dominator is the nearest common dominator of processed predecessors
+	this->pIdom[0] = 0;
+	bool changed   = true;
+	while(changed)
+	{
+		changed = false;
+		for(u32 i = 1; i < this->pOrder.size(); i++)
+		{
+			IrId b    = this->pOrder[i];
+			IrId idom = IrNone;
+			for(u32 e = code.block(b).preds; e != IrNone; e = code.edgeNext(e))
+			{
+				IrId p = code.edgeFrom(e);
+				if(this->pNumber[p] == IrNone || this->pIdom[p] == IrNone)
+				{
+					continue;
+				}
+				idom = idom == IrNone ? p : this->intersect(p, idom);
+			}
+			if(this->pIdom[b] != idom)
+			{
+				this->pIdom[b] = idom;
+				changed        = true;
+			}
+		}
+	}
+	this->pIdom[0] = IrNone;
+
+	//children grouped by parent in reverse postorder
+	this->pChildStart.assign(blocks + 1, 0);
+	for(IrId b : this->pOrder)
+	{
+		if(this->pIdom[b] != IrNone)
+		{
+			this->pChildStart[this->pIdom[b]]++;
+		}
+	}
+	for(u64 b = 1; b <= blocks; b++)
+	{
+		this->pChildStart[b] += this->pChildStart[b - 1];
+	}
+	this->pChildren.resize(this->pChildStart[blocks]);
+	for(u64 i = this->pOrder.size(); i-- > 0;)
+	{
+		IrId b = this->pOrder[i];
+		if(this->pIdom[b] != IrNone)
+		{
+			this->pChildren[--this->pChildStart[this->pIdom[b]]] = b;
+		}
+	}
+
+	//preorder of the tree, subtree of block is range from the block to the last of its descendants
+	this->pPreorder.clear();
+	this->pPre.assign(blocks, IrNone);
+	this->pStack.clear();
+	this->pStack.push_back(0);
+	while(this->pStack.size() != 0)
+	{
+		IrId b = this->pStack.back();
+		this->pStack.pop_back();
+		this->pPre[b] = this->pPreorder.size();
+		this->pPreorder.push_back(b);
+		for(u32 c = this->pChildStart[b + 1]; c-- > this->pChildStart[b];)
+		{
+			this->pStack.push_back(this->pChildren[c]);
+		}
+	}
+	this->pLast = this->pPre;
+	for(u64 i = this->pPreorder.size(); i-- > 0;)
+	{
+		IrId b = this->pPreorder[i];
+		if(this->pIdom[b] != IrNone)
+		{
+			this->pLast[this->pIdom[b]] = std::max(this->pLast[this->pIdom[b]], this->pLast[b]);
+		}
+	}
+}
+
+/**
+ * \brief block a dominates block b (every block dominates itself)
+ */
+bool Dominator::dominates(IrId a, IrId b) const
+{
+	if(this->pPre[a] == IrNone || this->pPre[b] == IrNone)
+	{
+		return false;
+	}
+	return this->pPre[a] <= this->pPre[b] && this->pPre[b] <= this->pLast[a];
+}
+
+/**
+ * \brief nearest common dominator of two blocks
+ */
+IrId Dominator::intersect(IrId a, IrId b) const
+{
+	while(a != b)
+	{
+		while(this->pNumber[a] > this->pNumber[b])
+		{
+			a = this->pIdom[a];
+		}
+		while(this->pNumber[b] > this->pNumber[a])
+		{
+			b = this->pIdom[b];
+		}
+	}
+	return a;
+}
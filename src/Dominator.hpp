@@ -0,0 +1,49 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+
+#include <vector>
+
+/**
+ * \brief dominator tree of finished function
+ * \note block a dominates block b when every path from the entry to b goes through a.
+ *       Immediate dominators are computed iteratively over reverse postorder (Cooper, Harvey, Kennedy),
+ *       blocks not reached from the entry are not in the tree. Preorder of the tree numbers blocks
+ *       so that subtree of block is a contiguous range, dominance is a test of two numbers.
+ */
+class Dominator
+{
+public:
+	/**
+	 * \brief compute dominator tree of live blocks reached from the entry
+	 */
+	void run(const Codegen& code);
+
+	/**
+	 * \brief immediate dominator of block (IrNone for the entry and blocks not reached)
+	 */
+	IrId idom(IrId block) const                  { return this->pIdom[block]; }
+	bool reached(IrId block) const               { return this->pNumber[block] != IrNone; }
+	bool dominates(IrId a, IrId b) const;
+	/**
+	 * \brief blocks in reverse postorder of control flow graph and in preorder of dominator tree
+	 */
+	const std::vector<IrId>& order() const       { return this->pOrder; }
+	const std::vector<IrId>& preorder() const    { return this->pPreorder; }
+
+private:
+	IrId intersect(IrId a, IrId b) const;
+
+	//blocks in reverse postorder and index of every block in it
+	std::vector<IrId> pOrder;
+	std::vector<u32>  pNumber;
+	std::vector<IrId> pIdom;
+	//children of every block grouped by parent, preorder and the last preorder index of subtree
+	std::vector<u32>  pChildStart;
+	std::vector<IrId> pChildren;
+	std::vector<IrId> pPreorder;
+	std::vector<u32>  pPre;
+	std::vector<u32>  pLast;
+	std::vector<u32>  pStack;
+};
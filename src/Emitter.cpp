@@ -0,0 +1,650 @@
+#include "Emitter.hpp"
+#include "Codegen.hpp"
+#include "Silcode.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \brief append bytes, full block is written into file
+ */
+void Emitter::append(const char* data, u64 size)
+{
+	this->pBuffer.append(data, size);
+
+	if(this->pOut != nullptr && this->pBuffer.size() >= this->pBlock)
+	{
+		this->flush();
+	}
+}
+
+/**
+ * \brief write collected output into file
+ */
+void Emitter::flush()
+{
+	if(this->pOut == nullptr || this->pBuffer.size() == 0)
+	{
+		return;
+	}
+
+	std::fwrite(this->pBuffer.data(), 1, this->pBuffer.size(), this->pOut);
+	this->pWritten += this->pBuffer.size();
+	this->pBuffer.clear();
+}
+
+/**
+ * \brief append output of segment created by this emitter
+ */
+void Emitter::merge(Emitter& segment)
+{
+	this->append(segment.pBuffer.data(), segment.pBuffer.size());
+}
+
+/**
+ * \brief printed intermediate code and trace messages
+ */
+class EmitterText : public Emitter
+{
+public:
+	EmitterText(FILE* out, u64 block) : Emitter(out, block) {}
+
+	void text(const char* data, u64 size) override
+	{
+		this->append(data, size);
+	}
+
+	void function(const Codegen& code) override
+	{
+		//function is printed directly into the buffer
+		code.print(this->pBuffer);
+		this->append(nullptr, 0);
+	}
+
+	Emitter* segment() override
+	{
+		return new EmitterText(nullptr, this->pBlock);
+	}
+};
+
+/**
+ * \brief .silcode file
+ * \note code is written into file as functions come, other sections are collected
+ *       in memory and written after the code together with the header.
+ *       Segments only record functions and globals, they are encoded when the segment
+ *       is merged so the file does not depend on the order in which threads finished.
+ *
+ *       function:    blocks, values, frame size, mask of saved registers, local count (LEB128),
+ *                    locals, blocks in order
+ *       local:       symbol, offset in frame
+ *       block:       predecessor count, predecessors, instruction count, instructions
+ *       instruction: op (u8), type (u8), location, operands by op:
+ *                    const     sleb value (f64: offset in constants)
+ *                    str       offset in constants
+ *                    arg       index
+ *                    phi       value for every predecessor
+ *                    binary    two values
+ *                    cvt       value
+ *                    load      symbol, sleb offset
+ *                    store     symbol, sleb offset, value
+ *                    addr      symbol
+ *                    copy      symbol, value, size
+ *                    (load, store and copy with symbol none are followed by value of address)
+ *                    call      symbol, count, values
+ *                    result    value, index
+ *                    ret       count, values
+ *                    jmp       block
+ *                    br        value, block, block
+ *       values and blocks are numbered densely from zero in order of the function,
+ *       location is 0 (none), 4 * register + 1, 4 * float register + 3 or 2 * offset of stack slot
+ *       in frame + 2, mask of saved registers has integer registers in bits 0-31 and float
+ *       registers in bits 32-63
+ */
+class EmitterBinary : public Emitter
+{
+public:
+	EmitterBinary(FILE* out, u64 block, bool segment) : Emitter(out, block)
+	{
+		this->pSegment = segment;
+		this->pCode    = 0;
+
+		//header and section table are written when the file is complete
+		if(out != nullptr)
+		{
+			this->pBuffer.resize(EmitterBinary::start(), '\0');
+		}
+	}
+
+	void text(const char*, u64) override
+	{
+	}
+
+	void function(const Codegen& code) override;
+	void global(const std::string& name, u64 size, u64 align, const void* value) override;
+	void global(const std::string& name, const std::string& literal) override;
+
+	Emitter* segment() override
+	{
+		return new EmitterBinary(nullptr, this->pBlock, true);
+	}
+
+	void merge(Emitter& segment) override;
+	void finish() override;
+
+private:
+	/**
+	 * \brief function or global recorded by segment
+	 */
+	struct Record
+	{
+		Codegen     code;
+		std::string name;
+		std::string value;
+		u64         align;
+		bool        function;
+		bool        literal;
+		bool        zero;
+	};
+
+	/**
+	 * \brief offset of code section
+	 */
+	static u64 start()
+	{
+		u64 size = sizeof(SilcodeHeader) + (u64)SilcodeSection::Count * sizeof(SilcodeSectionEntry);
+		return (size + SilcodeAlign - 1) / SilcodeAlign * SilcodeAlign;
+	}
+
+	/**
+	 * \brief symbol, float and string constant of the file
+	 */
+	u32 symbol(const std::string& name);
+	u64 constant(f64 value);
+	u64 constant(const std::string& value);
+
+	bool                pSegment;
+	std::vector<Record> pRecords;
+
+	//tables of the file
+	u64                                  pCode;
+	std::vector<SilcodeSymbol>           pSymbols;
+	std::vector<bool>                    pMemory;
+	std::unordered_map<std::string, u32> pSymbolIndex;
+	std::string                          pStrings;
+	std::string                          pConstants;
+	std::unordered_map<u64, u64>         pFloats;
+	std::unordered_map<std::string, u64> pLiterals;
+	std::string                          pData;
+	std::vector<SilcodeLine>             pLines;
+};
+
+/**
+ * \brief symbol of the file
+ */
+u32 EmitterBinary::symbol(const std::string& name)
+{
+	auto it = this->pSymbolIndex.find(name);
+	if(it != this->pSymbolIndex.end())
+	{
+		return it->second;
+	}
+
+	SilcodeSymbol s;
+	s.name  = this->pStrings.size();
+	s.kind  = SilcodeSymbolKind::Extern;
+	s.flags = 0;
+	s.align = 1;
+	s.value = 0;
+	s.size  = 0;
+
+	this->pStrings.append(name.c_str(), name.size() + 1);
+	this->pSymbols.push_back(s);
+	this->pMemory.push_back(false);
+
+	return this->pSymbolIndex[name] = this->pSymbols.size() - 1;
+}
+
+/**
+ * \brief float constant (8 byte aligned) and string literal (null terminated)
+ */
+u64 EmitterBinary::constant(f64 value)
+{
+	u64 bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	auto it = this->pFloats.find(bits);
+	if(it != this->pFloats.end())
+	{
+		return it->second;
+	}
+
+	this->pConstants.resize((this->pConstants.size() + 7) / 8 * 8, '\0');
+	u64 offset = this->pConstants.size();
+	this->pConstants.append((const char*)&value, sizeof(value));
+
+	return this->pFloats[bits] = offset;
+}
+
+u64 EmitterBinary::constant(const std::string& value)
+{
+	auto it = this->pLiterals.find(value);
+	if(it != this->pLiterals.end())
+	{
+		return it->second;
+	}
+
+	u64 offset = this->pConstants.size();
+	this->pConstants.append(value.c_str(), value.size() + 1);
+
+	return this->pLiterals[value] = offset;
+}
+
+/**
+ * \brief encode function
+ */
+void EmitterBinary::function(const Codegen& code)
+{
+	if(this->pSegment)
+	{
+		this->pRecords.emplace_back();
+		this->pRecords.back().code     = code;
+		this->pRecords.back().function = true;
+		return;
+	}
+
+	std::string out;
+
+	//dense numbers of live blocks and values
+	std::vector<u32> blocks(code.blockCount(), SilcodeNone);
+	std::vector<u32> values(code.instCount(), SilcodeNone);
+	u32 blockCount = 0;
+	u32 valueCount = 0;
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(!code.live(b))
+		{
+			continue;
+		}
+		blocks[b] = blockCount++;
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			values[i] = valueCount++;
+		}
+	}
+
+	auto value = [&](IrId v) { SilcodeWriteU(out, v == IrNone ? SilcodeNone : values[v]); };
+	auto block = [&](IrId b) { SilcodeWriteU(out, b == IrNone ? SilcodeNone : blocks[b]); };
+
+	//names of the function are symbols of the file
+	std::vector<u32> symbols(code.symbolCount(), SilcodeNone);
+	auto symbol = [&](u32 s, bool memory)
+	{
+		if(symbols[s] == SilcodeNone)
+		{
+			symbols[s] = this->symbol(code.symbolName(s));
+		}
+		if(memory)
+		{
+			this->pMemory[symbols[s]] = true;
+		}
+		SilcodeWriteU(out, symbols[s]);
+	};
+	//memory operation without symbol addresses memory by value written after its operands
+	auto memory = [&](IrId i)
+	{
+		if(code.inst(i).symbol == IrNone)
+		{
+			SilcodeWriteU(out, SilcodeNone);
+			return;
+		}
+		symbol(code.inst(i).symbol, true);
+	};
+	auto address = [&](IrId i)
+	{
+		if(code.inst(i).symbol == IrNone)
+		{
+			value(code.operand(i, code.inst(i).count - 1));
+		}
+	};
+
+	SilcodeWriteU(out, blockCount);
+	SilcodeWriteU(out, valueCount);
+	SilcodeWriteU(out, code.frame());
+	SilcodeWriteU(out, code.saved());
+	SilcodeWriteU(out, code.localCount());
+	for(u32 l = 0; l < code.localCount(); l++)
+	{
+		symbol(code.local(l).symbol, true);
+		SilcodeWriteU(out, code.local(l).offset);
+	}
+
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(!code.live(b))
+		{
+			continue;
+		}
+		const IrBlock& bb = code.block(b);
+
+		SilcodeWriteU(out, bb.predCount);
+		for(u32 e = bb.preds; e != IrNone; e = code.edgeNext(e))
+		{
+			block(code.edgeFrom(e));
+		}
+
+		u32 count = 0;
+		for(IrId i = bb.first; i != IrNone; i = code.inst(i).next)
+		{
+			count++;
+		}
+		SilcodeWriteU(out, count);
+
+		for(IrId i = bb.first; i != IrNone; i = code.inst(i).next)
+		{
+			const IrInst& inst = code.inst(i);
+
+			out.push_back((char)inst.op);
+			out.push_back((char)inst.type);
+
+			u32 location = code.location(i);
+			if(location == IrNone)
+			{
+				SilcodeWriteU(out, 0);
+			}
+			else if((location & IrSlot) != 0)
+			{
+				SilcodeWriteU(out, (u64)(location & ~IrSlot) * 2 + 2);
+			}
+			else if((location & IrFloat) != 0)
+			{
+				SilcodeWriteU(out, (u64)(location & ~IrFloat) * 4 + 3);
+			}
+			else
+			{
+				SilcodeWriteU(out, (u64)location * 4 + 1);
+			}
+
+			switch(inst.op)
+			{
+				case IrOp::Const:
+				{
+					if(inst.type == IrType::F64)
+					{
+						SilcodeWriteU(out, this->constant(inst.imm.f));
+					}
+					else
+					{
+						SilcodeWriteS(out, inst.imm.i);
+					}
+					break;
+				}
+				case IrOp::Undef:  { break; }
+				case IrOp::Str:    { SilcodeWriteU(out, this->constant(code.symbolName(inst.symbol))); break; }
+				case IrOp::Arg:    { SilcodeWriteU(out, inst.imm.i); break; }
+				case IrOp::Load:   { memory(i); SilcodeWriteS(out, inst.imm.i); address(i); break; }
+				case IrOp::Store:  { memory(i); SilcodeWriteS(out, inst.imm.i); value(code.operand(i, 0)); address(i); break; }
+				case IrOp::Addr:   { symbol(inst.symbol, true); break; }
+				case IrOp::Copy:   { memory(i); value(code.operand(i, 0)); SilcodeWriteU(out, inst.imm.i); address(i); break; }
+				case IrOp::Call:
+				{
+					symbol(inst.symbol, false);
+					SilcodeWriteU(out, inst.count);
+					for(u32 o = 0; o < inst.count; o++)
+					{
+						value(code.operand(i, o));
+					}
+					break;
+				}
+				case IrOp::Result: { value(code.operand(i, 0)); SilcodeWriteU(out, inst.imm.i); break; }
+				case IrOp::Ret:
+				{
+					SilcodeWriteU(out, inst.count);
+					for(u32 o = 0; o < inst.count; o++)
+					{
+						value(code.operand(i, o));
+					}
+					break;
+				}
+				case IrOp::Jump:   { block(bb.succ[0]); break; }
+				case IrOp::Branch: { value(code.operand(i, 0)); block(bb.succ[0]); block(bb.succ[1]); break; }
+				//phi (one value per predecessor), conversion and binary operations
+				default:
+				{
+					for(u32 o = 0; o < inst.count; o++)
+					{
+						value(code.operand(i, o));
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	u32            index = this->symbol(code.name());
+	SilcodeSymbol& s     = this->pSymbols[index];
+	s.kind  = SilcodeSymbolKind::Function;
+	s.value = this->pCode;
+	s.size  = out.size();
+	this->pLines.push_back({ index, 0, code.source(), this->pCode });
+
+	this->pCode += out.size();
+	this->append(out.data(), out.size());
+}
+
+/**
+ * \brief global variable and its initial memory
+ */
+void EmitterBinary::global(const std::string& name, u64 size, u64 align, const void* value)
+{
+	if(this->pSegment)
+	{
+		this->pRecords.emplace_back();
+		Record& r  = this->pRecords.back();
+		r.name     = name;
+		r.align    = align;
+		r.function = false;
+		r.literal  = false;
+		r.zero     = value == nullptr;
+		r.value    = value != nullptr ? std::string((const char*)value, size) : std::string(size, '\0');
+		return;
+	}
+
+	this->pData.resize((this->pData.size() + align - 1) / align * align, '\0');
+
+	SilcodeSymbol& s = this->pSymbols[this->symbol(name)];
+	s.kind  = SilcodeSymbolKind::Data;
+	s.align = align;
+	s.value = this->pData.size();
+	s.size  = size;
+
+	if(value != nullptr)
+	{
+		this->pData.append((const char*)value, size);
+	}
+	else
+	{
+		this->pData.resize(this->pData.size() + size, '\0');
+	}
+}
+
+/**
+ * \brief global variable initialized with address of string literal
+ * \note data holds offset of the literal in constants section, loader relocates it into address
+ */
+void EmitterBinary::global(const std::string& name, const std::string& literal)
+{
+	if(this->pSegment)
+	{
+		this->pRecords.emplace_back();
+		Record& r  = this->pRecords.back();
+		r.name     = name;
+		r.value    = literal;
+		r.function = false;
+		r.literal  = true;
+		return;
+	}
+
+	u64 offset = this->constant(literal);
+	this->global(name, sizeof(offset), sizeof(offset), &offset);
+	this->pSymbols[this->symbol(name)].flags |= SilcodeSymbolConstant;
+}
+
+/**
+ * \brief encode functions and globals recorded by segment
+ */
+void EmitterBinary::merge(Emitter& segment)
+{
+	for(const Record& r : ((EmitterBinary&)segment).pRecords)
+	{
+		if(r.function)
+		{
+			this->function(r.code);
+		}
+		else if(r.literal)
+		{
+			this->global(r.name, r.value);
+		}
+		else
+		{
+			this->global(r.name, r.value.size(), r.align, r.zero ? nullptr : r.value.data());
+		}
+	}
+}
+
+/**
+ * \brief write sections after the code, then header and section table at the start of file
+ */
+void EmitterBinary::finish()
+{
+	if(this->pOut == nullptr)
+	{
+		return;
+	}
+
+	SilcodeSectionEntry table[(u32)SilcodeSection::Count];
+	u64                 offset = EmitterBinary::start();
+
+	//every section starts naturally aligned, code is already in the file or in the buffer
+	auto section = [&](SilcodeSection kind, const char* data, u64 size)
+	{
+		SilcodeSectionEntry& e = table[(u32)kind];
+		e.kind   = kind;
+		e.align  = SilcodeAlign;
+		e.offset = offset;
+		e.size   = size;
+
+		u64 padding = (SilcodeAlign - size % SilcodeAlign) % SilcodeAlign;
+		this->append(data, data != nullptr ? size : 0);
+		this->append("\0\0\0\0\0\0\0", padding);
+		offset += size + padding;
+	};
+
+	//symbols used only as memory of functions are their local variables
+	for(u32 i = 0; i < this->pSymbols.size(); i++)
+	{
+		if(this->pSymbols[i].kind == SilcodeSymbolKind::Extern && this->pMemory[i])
+		{
+			this->pSymbols[i].kind = SilcodeSymbolKind::Local;
+		}
+	}
+
+	section(SilcodeSection::Code, nullptr, this->pCode);
+	section(SilcodeSection::Constants, this->pConstants.data(), this->pConstants.size());
+	section(SilcodeSection::Data, this->pData.data(), this->pData.size());
+	section(SilcodeSection::Symbols, (const char*)this->pSymbols.data(), this->pSymbols.size() * sizeof(SilcodeSymbol));
+	section(SilcodeSection::Strings, this->pStrings.data(), this->pStrings.size());
+	section(SilcodeSection::Lines, (const char*)this->pLines.data(), this->pLines.size() * sizeof(SilcodeLine));
+
+	SilcodeHeader header;
+	std::memcpy(header.magic, SilcodeMagic, sizeof(header.magic));
+	header.major    = SilcodeVersionMajor;
+	header.minor    = SilcodeVersionMinor;
+	header.sections = (u32)SilcodeSection::Count;
+	header.flags    = 0;
+	header.table    = sizeof(SilcodeHeader);
+	header.size     = offset;
+	header.entry    = SilcodeNone;
+	header.init     = SilcodeNone;
+
+	auto main = this->pSymbolIndex.find("main");
+	if(main != this->pSymbolIndex.end() && this->pSymbols[main->second].kind == SilcodeSymbolKind::Function)
+	{
+		header.entry = main->second;
+	}
+	auto init = this->pSymbolIndex.find("__init");
+	if(init != this->pSymbolIndex.end() && this->pSymbols[init->second].kind == SilcodeSymbolKind::Function)
+	{
+		header.init = init->second;
+	}
+
+	//header is still in the buffer when nothing was written yet, otherwise it is at the start of file
+	std::string start((const char*)&header, sizeof(header));
+	start.append((const char*)table, sizeof(table));
+	if(this->pWritten == 0)
+	{
+		this->pBuffer.replace(0, start.size(), start);
+		this->flush();
+	}
+	else
+	{
+		this->flush();
+		std::fseek(this->pOut, 0, SEEK_SET);
+		std::fwrite(start.data(), 1, start.size(), this->pOut);
+		std::fseek(this->pOut, 0, SEEK_END);
+	}
+}
+
+/**
+ * \brief nothing is written
+ */
+class EmitterNull : public Emitter
+{
+public:
+	EmitterNull(FILE* out, u64 block) : Emitter(out, block) {}
+
+	void text(const char*, u64) override
+	{
+	}
+
+	void function(const Codegen&) override
+	{
+	}
+
+	Emitter* segment() override
+	{
+		return new EmitterNull(nullptr, this->pBlock);
+	}
+};
+
+/**
+ * \brief create emitter of given sink writing into file
+ */
+Emitter* Emitter::create(EmitterSink sink, FILE* out, u64 block)
+{
+	switch(sink)
+	{
+		case EmitterSink::Binary: { return new EmitterBinary(out, block, false); }
+		case EmitterSink::Null:   { return new EmitterNull(out, block); }
+		default:                  { return new EmitterText(out, block); }
+	}
+}
+
+/**
+ * \brief shortest text form of float which reads back to the same value
+ */
+void EmitterFloat(std::string& out, f64 value)
+{
+	char buffer[32];
+	std::to_chars_result r = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+	out.append(buffer, r.ptr - buffer);
+
+	//integral value is still printed as float (1.0, not 1)
+	if(std::memchr(buffer, '.', r.ptr - buffer) == nullptr && std::memchr(buffer, 'e', r.ptr - buffer) == nullptr &&
+	   std::memchr(buffer, 'n', r.ptr - buffer) == nullptr)
+	{
+		out.append(".0");
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstdio>
+#include <string>
+
+class Codegen;
+
+/**
+ * \brief output is written into file in blocks of this size
+ */
+static constexpr u64 EmitterBlock = 1024 * 1024;
+
+/**
+ * \brief format of generated output
+ */
+enum class EmitterSink : u8
+{
+	//printed intermediate code and trace messages
+	Text,
+	//.silcode file (see Silcode.hpp), trace messages are dropped
+	Binary,
+	//nothing is written (benchmarking of the compiler)
+	Null,
+};
+
+/**
+ * \brief buffered output of generated code
+ * \note output is collected in memory and written into file by one call per block,
+ *       emitter without file keeps everything in memory (output segments of parallel parsing)
+ */
+class Emitter
+{
+public:
+	/**
+	 * \brief create emitter of given sink writing into file
+	 */
+	static Emitter* create(EmitterSink sink, FILE* out, u64 block = EmitterBlock);
+
+	virtual ~Emitter() {}
+
+	/**
+	 * \brief trace message or other text output of the compiler
+	 */
+	virtual void text(const char* data, u64 size) = 0;
+	/**
+	 * \brief code of finished function
+	 */
+	virtual void function(const Codegen& code) = 0;
+	/**
+	 * \brief global variable and its initial memory (value = nullptr for zeroed memory)
+	 */
+	virtual void global(const std::string& /* name */, u64 /* size */, u64 /* align */, const void* /* value */) {}
+	/**
+	 * \brief global variable initialized with address of string literal
+	 */
+	virtual void global(const std::string& /* name */, const std::string& /* literal */) {}
+
+	/**
+	 * \brief emitter collecting output in memory, the output is merged later in order (parallel parsing)
+	 * \note segments can be used by other threads than the emitter which created them
+	 */
+	virtual Emitter* segment() = 0;
+	/**
+	 * \brief append output of segment created by this emitter
+	 */
+	virtual void merge(Emitter& segment);
+	/**
+	 * \brief write rest of the output, file is complete
+	 */
+	virtual void finish() { this->flush(); }
+
+protected:
+	Emitter(FILE* out, u64 block) { this->pOut = out; this->pBlock = block; this->pWritten = 0; }
+
+	/**
+	 * \brief append bytes, full block is written into file
+	 */
+	void append(const char* data, u64 size);
+	/**
+	 * \brief write collected output into file
+	 */
+	void flush();
+
+	FILE*       pOut;
+	u64         pBlock;
+	std::string pBuffer;
+	//bytes already written into file
+	u64         pWritten;
+};
+
+/**
+ * \brief shortest text form of float which reads back to the same value (always contains "." or exponent)
+ */
+void EmitterFloat(std::string& out, f64 value);
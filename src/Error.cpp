@@ -1,22 +1,248 @@
 #include "Error.hpp"
 
-#include <cstdarg>
-#include <cstdio>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
 
-Error::Error(Error::Type t, const char* msg, ...)
+//diagnostics of the current thread
+static thread_local Diagnostics* gDiagnostics = nullptr;
+
+//arguments of diagnostics of all threads, id of argument is its index
+//(only names of symbols and tokens, so there are few of them)
+static std::mutex                           gArgumentsLock;
+static std::unordered_map<std::string, u32> gArgumentIds;
+static std::vector<const std::string*>      gArguments;
+
+//type and message of every diagnostic code
+#define ERROR_CODE_TYPE(code, type, message) Error::Type::type,
+static constexpr Error::Type ErrorCodeType[] =
+{
+	ERROR_CODES(ERROR_CODE_TYPE)
+};
+#undef ERROR_CODE_TYPE
+
+#define ERROR_CODE_MESSAGE(code, type, message) message,
+static constexpr const char* ErrorCodeMessage[] =
+{
+	ERROR_CODES(ERROR_CODE_MESSAGE)
+};
+#undef ERROR_CODE_MESSAGE
+
+/**
+ * \brief record diagnostic at byte offset of the source file into diagnostics of the calling thread
+ */
+Error::Error(Error::Code code, u64 offset, const char* a, const char* b, const char* c)
+{
+	this->type = ErrorCodeType[(u32)code];
+
+	if(gDiagnostics != nullptr)
+	{
+		gDiagnostics->record(code, offset, a, b, c);
+	}
+	else
+	{
+		Diagnostics immediate;
+		immediate.record(code, offset, a, b, c);
+		immediate.flush(nullptr);
+	}
+}
+
+/**
+ * \brief diagnostics of the calling thread receive records of Error constructor (nullptr prints them immediately)
+ */
+void Diagnostics::use(Diagnostics* diagnostics)
+{
+	gDiagnostics = diagnostics;
+}
+
+/**
+ * \brief record diagnostic
+ */
+void Diagnostics::record(Error::Code code, u64 offset, const char* a, const char* b, const char* c)
 {
-	this->type = t;
+	Record r;
+	r.code   = code;
+	r.argc   = 0;
+	r.offset = offset;
 
-	if(t != Error::Type::Ok)
+	std::lock_guard<std::mutex> lock(gArgumentsLock);
+	for(const char* arg : { a, b, c })
 	{
-		std::printf("error: ");
+		if(arg == nullptr)
+		{
+			break;
+		}
+		auto it = gArgumentIds.emplace(arg, (u32)gArguments.size());
+		if(it.second)
+		{
+			gArguments.push_back(&it.first->first);
+		}
+		r.args[r.argc++] = it.first->second;
 	}
 
-	va_list args;
+	this->pRecords.push_back(r);
+}
 
-	va_start(args, msg);
-	std::vprintf(msg, args);
-	va_end(args);
+/**
+ * \brief move diagnostics of other buffer into this one
+ */
+void Diagnostics::append(Diagnostics& other)
+{
+	this->pRecords.insert(this->pRecords.end(), other.pRecords.begin(), other.pRecords.end());
+	other.pRecords.clear();
+}
+
+/**
+ * \brief diagnostics have the same code, location and arguments
+ */
+bool Diagnostics::same(const Record& a, const Record& b)
+{
+	return a.code == b.code && a.offset == b.offset && a.argc == b.argc && std::equal(a.args, a.args + a.argc, b.args);
+}
+
+/**
+ * \brief keep only the first max errors in order of their location
+ */
+void Diagnostics::limit(u64 max)
+{
+	std::stable_sort(this->pRecords.begin(), this->pRecords.end(),
+		[](const Record& a, const Record& b) { return a.offset < b.offset; });
+
+	//every part stopped at its own limit, the limit is applied again to all of them
+	u64 count = 0;
+	for(const Record& r : this->pRecords)
+	{
+		if(r.code != Error::Code::TooManyErrors && (count == 0 || !Diagnostics::same(this->pRecords[count - 1], r)))
+		{
+			this->pRecords[count++] = r;
+		}
+	}
+	this->pRecords.resize(count);
+
+	if(count < max)
+	{
+		return;
+	}
+
+	this->pRecords.resize(max);
+
+	if(max > 1)
+	{
+		Record r;
+		r.code   = Error::Code::TooManyErrors;
+		r.argc   = 0;
+		r.offset = this->pRecords.back().offset;
+		this->pRecords.push_back(r);
+	}
+}
 
+/**
+ * \brief format one diagnostic
+ */
+void Diagnostics::print(const Record& r, const char* file, u64 line, u64 column)
+{
+	const char* args[3] = { "", "", "" };
+	{
+		std::lock_guard<std::mutex> lock(gArgumentsLock);
+		for(u8 i = 0; i < r.argc; i++)
+		{
+			args[i] = gArguments[r.args[i]]->c_str();
+		}
+	}
+
+	std::printf("error: ");
+	if(file != nullptr)
+	{
+		std::printf("%s:", file);
+	}
+	if(line != 0)
+	{
+		std::printf("%llu:%llu: ", (unsigned long long)line, (unsigned long long)column);
+	}
+	std::printf(ErrorCodeMessage[(u32)r.code], args[0], args[1], args[2]);
 	std::printf("\n");
-}
\ No newline at end of file
+}
+
+/**
+ * \brief format all diagnostics in order of their location and clear the buffer
+ * \note parsed source file is used to compute line and column of the location (can be nullptr),
+ *       source map translates them into position in the preprocessed file
+ */
+void Diagnostics::flush(FILE* source, const SourceMap* map)
+{
+	if(this->pRecords.empty())
+	{
+		return;
+	}
+
+	std::stable_sort(this->pRecords.begin(), this->pRecords.end(),
+		[](const Record& a, const Record& b) { return a.offset < b.offset; });
+
+	//walk the source once to translate offsets into lines and columns
+	long position = source != nullptr ? std::ftell(source) : -1;
+	if(position >= 0)
+	{
+		std::fseek(source, 0, SEEK_SET);
+	}
+
+	u64         offset = 0;
+	u64         line   = 1;
+	u64         column = 1;
+	const char* file   = nullptr;
+
+	//text from entry of source map on is copied from position of the entry
+	u64  entry  = 0;
+	auto follow = [&]()
+	{
+		while(map != nullptr && entry < map->entries.size() && map->entries[entry].offset <= offset)
+		{
+			const SourceMap::Entry& e = map->entries[entry++];
+			file   = map->files[e.file].c_str();
+			line   = e.line;
+			column = e.column;
+		}
+	};
+
+	for(u64 i = 0; i < this->pRecords.size(); i++)
+	{
+		//lexical errors of source scanned again are recorded again
+		const Record& r = this->pRecords[i];
+		if(i != 0 && Diagnostics::same(this->pRecords[i - 1], r))
+		{
+			continue;
+		}
+
+		if(position < 0)
+		{
+			Diagnostics::print(r, nullptr, 0, 0);
+			continue;
+		}
+
+		follow();
+		while(offset < r.offset)
+		{
+			int c = std::fgetc(source);
+			if(c == EOF)
+			{
+				break;
+			}
+			if(c == '\n')
+			{
+				line++;
+				column = 0;
+			}
+			column++;
+			offset++;
+			follow();
+		}
+
+		Diagnostics::print(r, file, line, column);
+	}
+
+	if(position >= 0)
+	{
+		std::fseek(source, position, SEEK_SET);
+	}
+
+	this->pRecords.clear();
+}
@@ -1,14 +1,148 @@
 #pragma once
 
+#include "types.hpp"
+#include "SourceMap.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+/**
+ * \brief all diagnostics of the compiler
+ * \note X(code, type, message), message arguments are strings only
+ */
+#define ERROR_CODES(X) \
+	/* scanner */ \
+	X(UnexpectedSymbol,         Lexical,  "Unexpected symbol") \
+	X(HexPrefix,                Lexical,  "Number in hex base must be lead by: \"0x\"") \
+	X(OctPrefix,                Lexical,  "Number in oct base must be lead by: \"0o\"") \
+	X(BinPrefix,                Lexical,  "Number in bin base must be lead by: \"0b\"") \
+	X(FloatFraction,            Lexical,  "Unexpected symbol near number, after floating point should be digit") \
+	X(ExponentSymbol,           Lexical,  "Unexpected symbol near exponential number, after \"e\" symbol should be digit or sign") \
+	X(ExponentSign,             Lexical,  "Unexpected symbol near exponential number, after exponential sign should be digit") \
+	X(StringNonAscii,           Lexical,  "Non ascii symbol inside a string") \
+	X(UnknownEscape,            Lexical,  "Unknown escape sequence") \
+	X(HexEscape,                Lexical,  "Hex escape sequence expects two heaxadecimal numbers") \
+	X(NonEqu,                   Lexical,  "Unexpected symbol after \"!\"") \
+	/* parser */ \
+	X(ExpectedAfter,            Syntax,   "Expected %s after %s") \
+	X(UnexpectedAfter,          Syntax,   "Unexpected %s after %s, expected %s") \
+	X(TooManyErrors,            Syntax,   "Too many errors, stopping") \
+	/* expressions */ \
+	X(ExpectedCallBracket,      Syntax,   "Expected left bracket after function identificator") \
+	X(UndefinedReference,       Syntax,   "Refering to variable or function in expression that doesn't exists") \
+	X(OperationArguments,       Syntax,   "Expected 2 arguments for operation") \
+	X(OperatorConstants,        Syntax,   "Unexpected operator between constants") \
+	X(BracketBalance,           Syntax,   "Invalid balance of parentheses") \
+	X(DivisionByZero,           Semantic, "Cannot divide by zero") \
+	/* declarations */ \
+	X(VariableRedefinition,     Semantic, "Cannot redefine variable") \
+	X(VariableFunctionName,     Semantic, "Cannot define variable with same name as function") \
+	X(FunctionVariableName,     Semantic, "Cannot define function with same name as variable [%s]") \
+	X(FunctionRedefinition,     Semantic, "Cannot redefine function [%s]") \
+	X(PackageRedefinition,      Semantic, "Cannot redefine package with the same name [%s]") \
+	X(PackageItemRedefinition,  Semantic, "Cannot have same identificator for two package items [%s]") \
+	X(AssignUndefined,          Semantic, "Cannot assign expression to a undefined variable") \
+	X(CallUndefined,            Semantic, "Calling undefined function [%s]") \
+	X(CallArguments,            Semantic, "Wrong number of arguments in call of function [%s]") \
+	X(VoidValue,                Semantic, "Function [%s] doesn't return a value") \
+	X(UndefinedPackage,         Semantic, "Using undefined package") \
+	X(FieldNotPack,             Semantic, "Variable [%s] is not a package") \
+	X(FieldUndefined,           Semantic, "Package [%s] has no item [%s]") \
+	X(PackValue,                Semantic, "Package variable [%s] can be used only by its items") \
+	X(PackExpected,             Semantic, "Expected variable or function call of package [%s]") \
+	X(NotImplemented,           Semantic, "NYI")
+
+/**
+ * \brief status of compilation step
+ * \note on success it is only the type, the message is recorded by Diagnostics
+ */
 struct Error
 {
-	enum class Type
+	enum class Type : u8
 	{
 		Ok,
 		Lexical,
 		Syntax,
+		Semantic,
 	} type;
 
+	#define ERROR_CODE_ENUM(code, type, message) code,
+	enum class Code : u16
+	{
+		ERROR_CODES(ERROR_CODE_ENUM)
+	};
+	#undef ERROR_CODE_ENUM
+
 	Error(Error::Type t) { this->type = t; }
-	Error(Error::Type t, const char* msg, ...);
-};
\ No newline at end of file
+	/**
+	 * \brief record diagnostic at byte offset of the source file into diagnostics of the calling thread
+	 */
+	Error(Error::Code code, u64 offset, const char* a = nullptr, const char* b = nullptr, const char* c = nullptr);
+};
+
+/**
+ * \brief deferred diagnostics
+ * \note records only code, location and argument ids, messages are formatted when flushed
+ */
+class Diagnostics
+{
+public:
+
+	/**
+	 * \brief record diagnostic
+	 */
+	void record(Error::Code code, u64 offset, const char* a, const char* b, const char* c);
+	/**
+	 * \brief move diagnostics of other buffer into this one
+	 */
+	void append(Diagnostics& other);
+	/**
+	 * \brief keep only the first max errors in order of their location
+	 * \note merged diagnostics of separately parsed parts end like diagnostics of one parser,
+	 *       with "too many errors" after the last kept error when there were more than one allowed,
+	 *       diagnostics recorded by more parts (lexical errors of scanned again source) are kept once
+	 */
+	void limit(u64 max);
+	/**
+	 * \brief format all diagnostics in order of their location and clear the buffer
+	 * \note parsed source file is used to compute line and column of the location (can be nullptr),
+	 *       source map translates them into position in the preprocessed file (nullptr = the position
+	 *       in parsed source), the same diagnostic recorded more times is printed once
+	 */
+	void flush(FILE* source, const SourceMap* map = nullptr);
+	/**
+	 * \brief number of recorded diagnostics
+	 */
+	u64  size() const { return this->pRecords.size(); }
+
+	/**
+	 * \brief diagnostics of the calling thread receive records of Error constructor (nullptr prints them immediately)
+	 */
+	static void use(Diagnostics* diagnostics);
+
+private:
+
+	/**
+	 * \brief compact diagnostic
+	 */
+	struct Record
+	{
+		Error::Code code;
+		u8          argc;
+		u64         offset;
+		u32         args[3];
+	};
+
+	//arguments are ids of strings shared by diagnostics of all threads
+	std::vector<Record> pRecords;
+
+	/**
+	 * \brief diagnostics have the same code, location and arguments
+	 */
+	static bool same(const Record& a, const Record& b);
+	/**
+	 * \brief format one diagnostic (file is nullptr when it is not known)
+	 */
+	static void print(const Record& r, const char* file, u64 line, u64 column);
+};
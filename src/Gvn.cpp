@@ -0,0 +1,415 @@
+#include "Gvn.hpp"
+
+#include <algorithm>
+
+/**
+ * \brief instruction without side effects whose value depends only on its operands
+ *        (and on memory for load)
+ */
+static bool GvnNumbered(IrOp op)
+{
+	switch(op)
+	{
+		case IrOp::Const: case IrOp::Str:   case IrOp::Addr: case IrOp::Load:
+		case IrOp::Add:   case IrOp::Sub:   case IrOp::Mul:  case IrOp::Div:
+		case IrOp::Shl:   case IrOp::Shr:   case IrOp::Sar:  case IrOp::MulHi:
+		case IrOp::Lt:    case IrOp::Le:    case IrOp::Gt:   case IrOp::Ge:
+		case IrOp::Eq:    case IrOp::Ne:    case IrOp::Cvt:  case IrOp::Phi: { return true; }
+		default:                                                            { return false; }
+	}
+}
+
+/**
+ * \brief operands can be swapped
+ */
+static bool GvnCommutative(IrOp op)
+{
+	return op == IrOp::Add || op == IrOp::Mul || op == IrOp::MulHi || op == IrOp::Eq || op == IrOp::Ne;
+}
+
+/**
+ * \brief store makes its value available as load of the same location
+ */
+static IrOp GvnOp(IrOp op)
+{
+	return op == IrOp::Store ? IrOp::Load : op;
+}
+
+/**
+ * \brief bytes of memory accessed by value of type
+ */
+static i64 GvnSize(IrType type)
+{
+	return type == IrType::U8 ? 1 : 8;
+}
+
+/**
+ * \brief replace redundant computations by values computed before
+ */
+void Gvn::run(Codegen& code)
+{
+	this->pCode = &code;
+	this->pDom.run(code);
+	this->pTable.clear();
+	this->pUndo.clear();
+	this->pLoads.clear();
+	this->pScopes.clear();
+	this->pLeader.resize(code.instCount());
+	this->pVisited.assign(code.instCount(), 0);
+	for(IrId i = 0; i < code.instCount(); i++)
+	{
+		this->pLeader[i] = i;
+	}
+
+	//writes of variables by every block
+	this->pWritesAll.assign(code.blockCount(), 0);
+	this->pWriteStart.assign(code.blockCount() + 1, 0);
+	this->pWrites.clear();
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		this->pWriteStart[b] = this->pWrites.size();
+		for(IrId i = this->pDom.reached(b) ? code.block(b).first : IrNone; i != IrNone; i = code.inst(i).next)
+		{
+			//memory at address can be any variable
+			switch(code.inst(i).op)
+			{
+				case IrOp::Store: case IrOp::Copy:
+				{
+					if(code.inst(i).symbol == IrNone)
+					{
+						this->pWritesAll[b] = 1;
+						break;
+					}
+					this->pWrites.push_back(i);
+					break;
+				}
+				case IrOp::Call: { this->pWritesAll[b] = 1; break; }
+				default:         { break; }
+			}
+		}
+	}
+	this->pWriteStart[code.blockCount()] = this->pWrites.size();
+	this->pMark.assign(code.blockCount(), 0);
+	this->pSymbolMark.assign(code.symbolCount(), 0);
+	this->pStamp = 0;
+
+	for(IrId b : this->pDom.preorder())
+	{
+		//leave blocks which don't dominate the block, their changes of table are undone
+		while(this->pScopes.size() != 0 && !this->pDom.dominates(this->pScopes.back().block, b))
+		{
+			const Scope& scope = this->pScopes.back();
+			while(this->pUndo.size() > scope.undo)
+			{
+				const Undo& undo = this->pUndo.back();
+				if(undo.inserted)
+				{
+					auto range = this->pTable.equal_range(undo.hash);
+					for(auto it = range.first; it != range.second; it++)
+					{
+						if(it->second.key == undo.entry.key)
+						{
+							this->pTable.erase(it);
+							break;
+						}
+					}
+				}
+				else
+				{
+					this->pTable.emplace(undo.hash, undo.entry);
+				}
+				this->pUndo.pop_back();
+			}
+			this->pLoads.resize(scope.loads);
+			this->pScopes.pop_back();
+		}
+		this->pScopes.push_back({ b, (u32)this->pUndo.size(), (u32)this->pLoads.size() });
+
+		IrId idom = this->pDom.idom(b);
+		if(b != 0 && (code.block(b).predCount != 1 || code.edgeFrom(code.block(b).preds) != idom))
+		{
+			this->join(b);
+		}
+
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			const IrInst& inst = code.inst(i);
+			this->pVisited[i]  = 1;
+
+			switch(inst.op)
+			{
+				case IrOp::Store:
+				{
+					this->kill(i);
+					if(inst.symbol != IrNone)
+					{
+						this->insert(i, this->pLeader[code.operand(i, 0)]);
+					}
+					continue;
+				}
+				case IrOp::Copy:  { this->kill(i); continue; }
+				case IrOp::Call:  { this->kill(IrNone); continue; }
+				default:          { break; }
+			}
+			//only loads of variables are numbered, memory at address is loaded every time
+			if(!GvnNumbered(inst.op) || (inst.op == IrOp::Load && inst.symbol == IrNone))
+			{
+				continue;
+			}
+
+			//phi is numbered only when values of all its predecessors are known
+			bool known = true;
+			for(u32 o = 0; o < inst.count && inst.op == IrOp::Phi; o++)
+			{
+				known = known && this->pVisited[code.operand(i, o)] != 0;
+			}
+			if(!known)
+			{
+				continue;
+			}
+
+			IrId found = this->find(i);
+			if(found != IrNone)
+			{
+				this->pLeader[i] = found;
+			}
+			else
+			{
+				this->insert(i, i);
+			}
+		}
+	}
+
+	//uses of redundant values use their leaders, finish removes redundant values
+	for(IrId b : this->pDom.order())
+	{
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			for(u32 o = 0; o < code.inst(i).count; o++)
+			{
+				IrId v = code.operand(i, o);
+				if(v != IrNone && this->pLeader[v] != v)
+				{
+					code.setOperand(i, o, this->pLeader[v]);
+				}
+			}
+		}
+	}
+	code.finish();
+}
+
+/**
+ * \brief value number of instruction from operation and leaders of its operands
+ */
+u64 Gvn::hash(IrId id) const
+{
+	const Codegen& code = *this->pCode;
+	const IrInst&  inst = code.inst(id);
+	IrOp           op   = GvnOp(inst.op);
+
+	u64 h = (u64)op * 0x9e3779b97f4a7c15ull;
+	h     = (h ^ (u64)inst.type) * 0x100000001b3ull;
+	h     = (h ^ (u64)inst.symbol) * 0x100000001b3ull;
+	h     = (h ^ (u64)inst.imm.i) * 0x100000001b3ull;
+	if(op == IrOp::Load)
+	{
+		return h;
+	}
+	if(op == IrOp::Phi)
+	{
+		h = (h ^ (u64)inst.block) * 0x100000001b3ull;
+	}
+
+	//commutative operands are hashed in any order
+	u64 sum = 0;
+	for(u32 o = 0; o < inst.count; o++)
+	{
+		u64 v = (u64)this->pLeader[code.operand(id, o)] * 0x9e3779b97f4a7c15ull;
+		if(GvnCommutative(op))
+		{
+			sum += v;
+		}
+		else
+		{
+			h = (h ^ v) * 0x100000001b3ull;
+		}
+	}
+	return h ^ sum;
+}
+
+bool Gvn::equal(IrId a, IrId b) const
+{
+	const Codegen& code = *this->pCode;
+	const IrInst&  x    = code.inst(a);
+	const IrInst&  y    = code.inst(b);
+	IrOp           op   = GvnOp(x.op);
+
+	if(op != GvnOp(y.op) || x.type != y.type || x.symbol != y.symbol || x.imm.i != y.imm.i)
+	{
+		return false;
+	}
+	if(op == IrOp::Load)
+	{
+		return true;
+	}
+	if(x.count != y.count || (op == IrOp::Phi && x.block != y.block))
+	{
+		return false;
+	}
+
+	bool same = true;
+	for(u32 o = 0; o < x.count; o++)
+	{
+		same = same && this->pLeader[code.operand(a, o)] == this->pLeader[code.operand(b, o)];
+	}
+	if(!same && GvnCommutative(op))
+	{
+		same = this->pLeader[code.operand(a, 0)] == this->pLeader[code.operand(b, 1)] &&
+		       this->pLeader[code.operand(a, 1)] == this->pLeader[code.operand(b, 0)];
+	}
+	return same;
+}
+
+/**
+ * \brief available value equal to instruction (IrNone when there is none)
+ */
+IrId Gvn::find(IrId id) const
+{
+	auto range = this->pTable.equal_range(this->hash(id));
+	for(auto it = range.first; it != range.second; it++)
+	{
+		if(this->equal(it->second.key, id))
+		{
+			return it->second.value;
+		}
+	}
+	return IrNone;
+}
+
+/**
+ * \brief value becomes available in the current scope
+ */
+void Gvn::insert(IrId key, IrId value)
+{
+	Undo undo;
+	undo.hash     = this->hash(key);
+	undo.entry    = { key, value };
+	undo.inserted = true;
+	this->pTable.emplace(undo.hash, undo.entry);
+	this->pUndo.push_back(undo);
+	if(GvnOp(this->pCode->inst(key).op) == IrOp::Load)
+	{
+		this->pLoads.push_back(key);
+	}
+}
+
+/**
+ * \brief value of key is not available in the current scope
+ */
+void Gvn::remove(IrId key)
+{
+	u64  hash  = this->hash(key);
+	auto range = this->pTable.equal_range(hash);
+	for(auto it = range.first; it != range.second; it++)
+	{
+		if(it->second.key == key)
+		{
+			Undo undo;
+			undo.hash     = hash;
+			undo.entry    = it->second;
+			undo.inserted = false;
+			this->pUndo.push_back(undo);
+			this->pTable.erase(it);
+			return;
+		}
+	}
+}
+
+/**
+ * \brief loads overlapped by write (IrNone = all memory) are not available
+ * \note store or copy at address can write any memory
+ */
+void Gvn::kill(IrId write)
+{
+	bool all = write == IrNone || this->pCode->inst(write).symbol == IrNone;
+	for(IrId key : this->pLoads)
+	{
+		if(all || this->overlaps(key, write))
+		{
+			this->remove(key);
+		}
+	}
+}
+
+/**
+ * \brief load and write access overlapping bytes of the same variable
+ * \note load key is load or store, copy writes size bytes from the start of variable
+ */
+bool Gvn::overlaps(IrId load, IrId write) const
+{
+	const IrInst& l = this->pCode->inst(load);
+	const IrInst& w = this->pCode->inst(write);
+	if(l.symbol != w.symbol)
+	{
+		return false;
+	}
+
+	i64 start = w.op == IrOp::Copy ? 0 : w.imm.i;
+	i64 end   = w.op == IrOp::Copy ? w.imm.i : w.imm.i + GvnSize(w.type);
+	return l.imm.i < end && start < l.imm.i + GvnSize(l.type);
+}
+
+/**
+ * \brief loads overlapped by writes on any path from immediate dominator to block are not available
+ */
+void Gvn::join(IrId block)
+{
+	Codegen& code = *this->pCode;
+	IrId     idom = this->pDom.idom(block);
+	bool     all  = false;
+	bool     any  = false;
+
+	this->pStamp++;
+	this->pWork.clear();
+	this->pJoinWrites.clear();
+	this->pWork.push_back(block);
+	while(this->pWork.size() != 0)
+	{
+		IrId b = this->pWork.back();
+		this->pWork.pop_back();
+		for(u32 e = code.block(b).preds; e != IrNone; e = code.edgeNext(e))
+		{
+			IrId p = code.edgeFrom(e);
+			if(p == idom || !this->pDom.reached(p) || this->pMark[p] == this->pStamp)
+			{
+				continue;
+			}
+			this->pMark[p] = this->pStamp;
+			this->pWork.push_back(p);
+
+			all = all || this->pWritesAll[p] != 0;
+			for(u32 w = this->pWriteStart[p]; w < this->pWriteStart[p + 1]; w++)
+			{
+				this->pSymbolMark[code.inst(this->pWrites[w]).symbol] = this->pStamp;
+				this->pJoinWrites.push_back(this->pWrites[w]);
+				any = true;
+			}
+		}
+	}
+
+	for(IrId key : this->pLoads)
+	{
+		bool written = all;
+		if(!written && any && this->pSymbolMark[code.inst(key).symbol] == this->pStamp)
+		{
+			for(IrId w : this->pJoinWrites)
+			{
+				written = written || this->overlaps(key, w);
+			}
+		}
+		if(written)
+		{
+			this->remove(key);
+		}
+	}
+}
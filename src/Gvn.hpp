@@ -0,0 +1,101 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+#include "Dominator.hpp"
+
+#include <vector>
+#include <unordered_map>
+
+/**
+ * \brief global value numbering of finished function
+ * \note blocks are visited in preorder of the dominator tree with scoped table of available values,
+ *       pure instruction equal to an available one (the same operation, type, symbol, immediate and
+ *       operands, commutative operands in any order) is replaced by it, so computation which is
+ *       already done on every path is reused. Loads are available until memory of their variable
+ *       is written: load is keyed by variable, offset and type (its size), store or copy
+ *       invalidates only loads of bytes overlapping bytes it writes and store makes its value available
+ *       as load of the same location, call or store at address (which can write any memory) invalidate
+ *       all loads. Block with other predecessors than its immediate dominator keeps loads which
+ *       are not overlapped by a write on any path from the dominator to the block.
+ */
+class Gvn
+{
+public:
+	/**
+	 * \brief replace redundant computations by values computed before
+	 */
+	void run(Codegen& code);
+
+private:
+	/**
+	 * \brief available value of instruction equal to key
+	 */
+	struct Entry
+	{
+		IrId key;
+		IrId value;
+	};
+
+	/**
+	 * \brief change of table undone at the end of scope
+	 */
+	struct Undo
+	{
+		u64   hash;
+		Entry entry;
+		bool  inserted;
+	};
+
+	/**
+	 * \brief block whose dominated blocks are being visited, changes and loads of its table from undo and loads
+	 */
+	struct Scope
+	{
+		IrId block;
+		u32  undo;
+		u32  loads;
+	};
+
+	/**
+	 * \brief value number of instruction from operation and leaders of its operands
+	 */
+	u64  hash(IrId id) const;
+	bool equal(IrId a, IrId b) const;
+	IrId find(IrId id) const;
+	void insert(IrId key, IrId value);
+	void remove(IrId key);
+	/**
+	 * \brief loads overlapped by write (IrNone = all memory) or by writes on paths into block
+	 *        are not available
+	 */
+	void kill(IrId write);
+	void join(IrId block);
+	/**
+	 * \brief load and write access overlapping bytes of the same variable
+	 */
+	bool overlaps(IrId load, IrId write) const;
+
+	Codegen*                            pCode;
+	Dominator                           pDom;
+
+	//available values by hash, their changes and keys of available loads
+	std::unordered_multimap<u64, Entry> pTable;
+	std::vector<Undo>                   pUndo;
+	std::vector<IrId>                   pLoads;
+	std::vector<Scope>                  pScopes;
+	//value replacing every instruction, instructions already visited
+	std::vector<IrId>                   pLeader;
+	std::vector<u8>                     pVisited;
+
+	//memory written by every block: any memory (call) and writes of variables grouped by block
+	std::vector<u8>                     pWritesAll;
+	std::vector<u32>                    pWriteStart;
+	std::vector<IrId>                   pWrites;
+	//blocks on paths into join, variables written by them and their writes
+	std::vector<u32>                    pMark;
+	std::vector<u32>                    pSymbolMark;
+	std::vector<IrId>                   pJoinWrites;
+	u32                                 pStamp;
+	std::vector<IrId>                   pWork;
+};
@@ -0,0 +1,65 @@
+#include "Layout.hpp"
+
+#include <algorithm>
+
+/**
+ * \brief round offset up to multiple of alignment (power of two)
+ */
+static u64 LayoutAlign(u64 offset, u64 align)
+{
+	return (offset + align - 1) & ~(align - 1);
+}
+
+/**
+ * \brief compute offsets of fields, size and alignment
+ * \note in declaration order or, with reorder, by decreasing alignment to minimize padding
+ *       (order of the field list is kept, only offsets change)
+ */
+void Layout::compute(bool reorder)
+{
+	//order in which the fields are placed in memory
+	std::vector<u64> order(this->fields.size());
+	for(u64 i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+
+	//fields with the same alignment stay in declaration order
+	if(reorder)
+	{
+		std::stable_sort(order.begin(), order.end(), [this](u64 a, u64 b)
+		{
+			return this->fields[a].align > this->fields[b].align;
+		});
+	}
+
+	u64 offset  = 0;
+	this->align = 1;
+
+	for(u64 i : order)
+	{
+		Field& field = this->fields[i];
+
+		offset       = LayoutAlign(offset, field.align);
+		field.offset = offset;
+		offset      += field.size;
+
+		this->align  = std::max(this->align, field.align);
+	}
+
+	//aggregates placed one after another keep the alignment
+	this->size = LayoutAlign(offset, this->align);
+}
+
+/**
+ * \brief bytes wasted by alignment
+ */
+u64 Layout::padding() const
+{
+	u64 used = 0;
+	for(const Field& field : this->fields)
+	{
+		used += field.size;
+	}
+	return this->size - used;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <vector>
+
+/**
+ * \brief memory layout of aggregate (pack)
+ */
+struct Layout
+{
+	/**
+	 * \brief field of aggregate
+	 */
+	struct Field
+	{
+		u64 size;
+		u64 align;
+		u64 offset;
+	};
+
+	//fields in declaration order, offsets are computed by compute()
+	std::vector<Field> fields;
+
+	//size of the aggregate (multiple of its alignment) and its alignment
+	u64 size;
+	u64 align;
+
+	Layout() { size = 0; align = 1; }
+
+	/**
+	 * \brief compute offsets of fields, size and alignment
+	 * \note in declaration order or, with reorder, by decreasing alignment to minimize padding
+	 *       (order of the field list is kept, only offsets change)
+	 */
+	void compute(bool reorder);
+	/**
+	 * \brief bytes wasted by alignment
+	 */
+	u64  padding() const;
+};
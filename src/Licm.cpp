@@ -0,0 +1,298 @@
+#include "Licm.hpp"
+#include "Operator.hpp"
+
+#include <algorithm>
+
+/**
+ * \brief move invariant code out of loops and reduce multiplications of induction variables
+ */
+void Licm::run(Codegen& code, const Target& target)
+{
+	static constexpr std::array<Reduce, TargetCount> instances = Licm::reductions(std::make_index_sequence<TargetCount>());
+	this->pCode   = &code;
+	this->pReduce = instances[&target - Targets];
+	this->pDom.run(code);
+	this->pLoops.run(code, this->pDom);
+	if(this->pLoops.count() == 0)
+	{
+		return;
+	}
+
+	this->pWritten.assign(code.symbolCount(), 0);
+	this->pStamp = 0;
+	for(u32 l = 0; l < this->pLoops.count(); l++)
+	{
+		const LoopItem& loop = this->pLoops.loop(l);
+		if(loop.preheader == IrNone)
+		{
+			continue;
+		}
+		this->hoist(loop);
+		(this->*pReduce)(loop);
+	}
+	code.finish();
+}
+
+/**
+ * \brief value is computed inside of loop
+ */
+bool Licm::inside(const LoopItem& loop, IrId value) const
+{
+	return this->pLoops.contains(loop, this->pCode->inst(value).block);
+}
+
+/**
+ * \brief pure instruction with operands from outside of loop which can be computed in preheader
+ *        (constants move too, so their users can follow them)
+ */
+bool Licm::invariant(const LoopItem& loop, IrId id) const
+{
+	const Codegen& code = *this->pCode;
+	const IrInst&  inst = code.inst(id);
+
+	switch(inst.op)
+	{
+		case IrOp::Const: case IrOp::Str:
+		case IrOp::Add:   case IrOp::Sub: case IrOp::Mul: case IrOp::MulHi:
+		case IrOp::Shl:   case IrOp::Shr: case IrOp::Sar: case IrOp::Addr:
+		case IrOp::Lt:    case IrOp::Le:  case IrOp::Gt:  case IrOp::Ge:
+		case IrOp::Eq:    case IrOp::Ne:
+		{
+			break;
+		}
+		case IrOp::Cvt:
+		{
+			//float out of integer range has no defined conversion
+			if(inst.type != IrType::F64 && code.valueType(code.operand(id, 0)) == IrType::F64)
+			{
+				return false;
+			}
+			break;
+		}
+		case IrOp::Div:
+		{
+			//integer division by zero fails at runtime, the loop may not divide at all
+			const IrInst& divisor = code.inst(code.operand(id, 1));
+			if(inst.type != IrType::F64 && (divisor.op != IrOp::Const || divisor.imm.i == 0))
+			{
+				return false;
+			}
+			break;
+		}
+		case IrOp::Load:
+		{
+			//memory at address may be a variable written by the loop
+			if(inst.symbol == IrNone || this->pWritesAll || this->pWritten[inst.symbol] == this->pStamp)
+			{
+				return false;
+			}
+			//memory of local variable may not exist before the loop
+			for(u32 l = 0; l < code.localCount(); l++)
+			{
+				const std::vector<IrId>& blocks = code.local(l).blocks;
+				if(code.local(l).symbol == inst.symbol && std::find(blocks.begin(), blocks.end(), loop.preheader) == blocks.end())
+				{
+					return false;
+				}
+			}
+			break;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+
+	for(u32 o = 0; o < inst.count; o++)
+	{
+		if(this->inside(loop, code.operand(id, o)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief move invariant instructions to preheader in order of the loop, so invariant
+ *        operands move before their users
+ */
+void Licm::hoist(const LoopItem& loop)
+{
+	Codegen&    code   = *this->pCode;
+	const IrId* blocks = this->pLoops.blocks(loop);
+
+	this->pStamp++;
+	this->pWritesAll = false;
+	for(u32 b = 0; b < loop.count; b++)
+	{
+		for(IrId i = code.block(blocks[b]).first; i != IrNone; i = code.inst(i).next)
+		{
+			switch(code.inst(i).op)
+			{
+				case IrOp::Store: case IrOp::Copy:
+				{
+					//memory at address can be any variable
+					if(code.inst(i).symbol == IrNone)
+					{
+						this->pWritesAll = true;
+						break;
+					}
+					this->pWritten[code.inst(i).symbol] = this->pStamp;
+					break;
+				}
+				case IrOp::Call: { this->pWritesAll = true; break; }
+				default:         { break; }
+			}
+		}
+	}
+
+	for(u32 b = 0; b < loop.count; b++)
+	{
+		IrId i = code.block(blocks[b]).first;
+		while(i != IrNone)
+		{
+			IrId next = code.inst(i).next;
+			if(this->invariant(loop, i))
+			{
+				code.move(i, loop.preheader);
+			}
+			i = next;
+		}
+	}
+}
+
+/**
+ * \brief multiplications of basic induction variables become induction variables
+ */
+template<u32 T>
+void Licm::reduce(const LoopItem& loop)
+{
+	Codegen& code   = *this->pCode;
+	IrId     header = loop.header;
+	if(loop.latch == IrNone || code.block(header).predCount != 2)
+	{
+		return;
+	}
+
+	//operand of phi from preheader and from latch
+	u32 entry = code.edgeFrom(code.block(header).preds) == loop.preheader ? 0 : 1;
+	u32 back  = 1 - entry;
+
+	for(IrId p = code.block(header).first; p != IrNone; p = code.inst(p).next)
+	{
+		const IrInst& phi = code.inst(p);
+		if(phi.op != IrOp::Phi || (phi.type != IrType::I64 && phi.type != IrType::U8))
+		{
+			continue;
+		}
+
+		//i = i + c or i = i - c on the back edge
+		IrId          next = code.operand(p, back);
+		const IrInst& step = code.inst(next);
+		if((step.op != IrOp::Add && step.op != IrOp::Sub) || step.type != phi.type || code.operand(next, 0) != p ||
+		   code.inst(code.operand(next, 1)).op != IrOp::Const)
+		{
+			continue;
+		}
+		i64 c = code.inst(code.operand(next, 1)).imm.i;
+		c     = step.op == IrOp::Add ? c : (i64)(0 - (u64)c);
+
+		//i * k with invariant k, shift by constant is multiplication too
+		this->pUsers.clear();
+		const IrId* blocks = this->pLoops.blocks(loop);
+		for(u32 b = 0; b < loop.count; b++)
+		{
+			for(IrId i = code.block(blocks[b]).first; i != IrNone; i = code.inst(i).next)
+			{
+				const IrInst& m = code.inst(i);
+				if((m.op != IrOp::Mul && m.op != IrOp::Shl) || m.type != phi.type ||
+				   Targets[T].cost(m.op, m.type) <= Targets[T].cost(IrOp::Add, m.type))
+				{
+					continue;
+				}
+				IrId a = code.operand(i, 0);
+				IrId k = code.operand(i, 1);
+				if(m.op == IrOp::Mul && k == p)
+				{
+					std::swap(a, k);
+				}
+				if(a == p && !this->inside(loop, k) && (m.op == IrOp::Mul || code.inst(k).op == IrOp::Const))
+				{
+					this->pUsers.push_back(i);
+				}
+			}
+		}
+
+		for(IrId m : this->pUsers)
+		{
+			IrOp   op   = code.inst(m).op;
+			IrType type = code.inst(m).type;
+			IrId   k    = code.operand(m, 0) == p ? code.operand(m, 1) : code.operand(m, 0);
+			IrId   pre  = code.block(loop.preheader).last;
+
+			IrId operands[2];
+			operands[entry] = this->emit(pre, op, type, code.operand(p, entry), k);
+			operands[back]  = IrNone;
+			IrId stride     = this->emit(pre, op, type, this->constant(pre, type, c), k);
+			IrId reduced    = code.phi(header, type, operands, 2);
+			IrId add[2]     = { reduced, stride };
+			code.setOperand(reduced, back, code.insert(code.inst(next).next, IrOp::Add, type, add, 2));
+
+			//users of multiplication use the new variable, multiplication is removed by finish
+			for(IrId b : this->pDom.order())
+			{
+				for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+				{
+					for(u32 o = 0; o < code.inst(i).count; o++)
+					{
+						if(code.operand(i, o) == m)
+						{
+							code.setOperand(i, o, reduced);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * \brief operation of two values inserted before instruction, constants are folded
+ *        and multiplication by 0 or 1 is simplified
+ */
+IrId Licm::emit(IrId before, IrOp op, IrType type, IrId a, IrId b)
+{
+	Codegen&      code = *this->pCode;
+	OperatorValue r;
+	for(u32 o = 0; o < 2 && op == IrOp::Mul; o++)
+	{
+		const IrInst& c = code.inst(o == 0 ? a : b);
+		if(c.op == IrOp::Const && c.imm.i == 0)
+		{
+			return this->constant(before, type, 0);
+		}
+		if(c.op == IrOp::Const && c.imm.i == 1)
+		{
+			return o == 0 ? b : a;
+		}
+	}
+	if(code.inst(a).op == IrOp::Const && code.inst(b).op == IrOp::Const)
+	{
+		bool folded = type == IrType::U8 ? OperatorEval(op, (u8)code.inst(a).imm.i, (u8)code.inst(b).imm.i, r) :
+		                                   OperatorEval(op, code.inst(a).imm.i, code.inst(b).imm.i, r);
+		if(folded)
+		{
+			return this->constant(before, r.type, r.i);
+		}
+	}
+	IrId operands[2] = { a, b };
+	return code.insert(before, op, type, operands, 2);
+}
+
+IrId Licm::constant(IrId before, IrType type, i64 value)
+{
+	IrId id = this->pCode->insert(before, IrOp::Const, type, nullptr, 0);
+	this->pCode->setConstant(id, type, value);
+	return id;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+#include "Target.hpp"
+#include "Dominator.hpp"
+#include "Loops.hpp"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief loop invariant code motion and strength reduction of induction variables
+ * \note loops are processed from the innermost. Pure instruction whose operands are defined
+ *       outside of the loop moves to the preheader and is computed once, so invariant expression
+ *       of inner loop can move further out of the outer loop. Load moves when the loop doesn't
+ *       write its variable and has no calls, division only by nonzero constant and conversion only
+ *       when it is not from float to integer, so moved code never fails when the loop runs zero times.
+ *       Basic induction variable is phi of header stepped by constant on the back edge (i = i + c),
+ *       its multiplication by invariant k becomes new induction variable starting at init * k
+ *       stepped by c * k, when the target costs make multiplication slower than addition.
+ *       Strength reduction is instantiated for every target, run selects the instance of the target.
+ */
+class Licm
+{
+public:
+	/**
+	 * \brief move invariant code out of loops and reduce multiplications of induction variables
+	 */
+	void run(Codegen& code, const Target& target);
+
+private:
+	/**
+	 * \brief value is computed inside of loop
+	 */
+	bool inside(const LoopItem& loop, IrId value) const;
+	bool invariant(const LoopItem& loop, IrId id) const;
+	void hoist(const LoopItem& loop);
+	/**
+	 * \brief strength reduction for costs of target Targets[T] and instances for all targets
+	 */
+	template<u32 T>
+	void reduce(const LoopItem& loop);
+	using Reduce = void (Licm::*)(const LoopItem& loop);
+	template<std::size_t... T>
+	static constexpr std::array<Reduce, sizeof...(T)> reductions(std::index_sequence<T...>) { return {{ &Licm::reduce<T>... }}; }
+	/**
+	 * \brief operation of two values inserted before instruction, constants are folded
+	 */
+	IrId emit(IrId before, IrOp op, IrType type, IrId a, IrId b);
+	IrId constant(IrId before, IrType type, i64 value);
+
+	Codegen*          pCode;
+	Reduce            pReduce;
+	Dominator         pDom;
+	Loops             pLoops;
+
+	//variables written by the current loop (marked by stamp), loop has call
+	std::vector<u32>  pWritten;
+	u32               pStamp;
+	bool              pWritesAll;
+	//multiplications of the current induction variable
+	std::vector<IrId> pUsers;
+};
@@ -0,0 +1,116 @@
+#include "Loops.hpp"
+
+#include <algorithm>
+
+/**
+ * \brief find loops of function with computed dominator tree
+ */
+void Loops::run(const Codegen& code, const Dominator& dom)
+{
+	this->pLoops.clear();
+	this->pBlocks.clear();
+	this->pNumber.assign(code.blockCount(), IrNone);
+	this->pMark.assign(code.blockCount(), IrNone);
+	for(u32 i = 0; i < dom.order().size(); i++)
+	{
+		this->pNumber[dom.order()[i]] = i;
+	}
+
+	for(IrId h : dom.order())
+	{
+		LoopItem loop;
+		loop.header    = h;
+		loop.preheader = IrNone;
+		loop.latch     = IrNone;
+		loop.first     = this->pBlocks.size();
+		loop.count     = 0;
+
+		//blocks reaching back edges, marked by index of the loop
+		u32 index   = this->pLoops.size();
+		u32 latches = 0;
+		this->pWork.clear();
+		for(u32 e = code.block(h).preds; e != IrNone; e = code.edgeNext(e))
+		{
+			IrId p = code.edgeFrom(e);
+			if(dom.reached(p) && dom.dominates(h, p))
+			{
+				loop.latch = p;
+				latches++;
+				this->pWork.push_back(p);
+			}
+		}
+		if(latches == 0)
+		{
+			continue;
+		}
+
+		this->pMark[h] = index;
+		this->pBlocks.push_back(h);
+		while(this->pWork.size() != 0)
+		{
+			IrId b = this->pWork.back();
+			this->pWork.pop_back();
+			if(this->pMark[b] == index)
+			{
+				continue;
+			}
+			this->pMark[b] = index;
+			this->pBlocks.push_back(b);
+			for(u32 e = code.block(b).preds; e != IrNone; e = code.edgeNext(e))
+			{
+				IrId p = code.edgeFrom(e);
+				if(dom.reached(p) && this->pMark[p] != index)
+				{
+					this->pWork.push_back(p);
+				}
+			}
+		}
+		loop.count = this->pBlocks.size() - loop.first;
+		loop.latch = latches == 1 ? loop.latch : IrNone;
+		std::sort(this->pBlocks.begin() + loop.first, this->pBlocks.end(), [this](IrId a, IrId b)
+		{
+			return this->pNumber[a] < this->pNumber[b];
+		});
+
+		//the only edge entering the loop comes from block which only jumps to the header
+		u32 entries = 0;
+		for(u32 e = code.block(h).preds; e != IrNone; e = code.edgeNext(e))
+		{
+			IrId p = code.edgeFrom(e);
+			if(this->pMark[p] != index)
+			{
+				loop.preheader = p;
+				entries++;
+			}
+		}
+		if(entries != 1 || code.block(loop.preheader).succ[1] != IrNone)
+		{
+			loop.preheader = IrNone;
+		}
+
+		this->pLoops.push_back(loop);
+	}
+
+	std::stable_sort(this->pLoops.begin(), this->pLoops.end(), [](const LoopItem& a, const LoopItem& b)
+	{
+		return a.count < b.count;
+	});
+}
+
+/**
+ * \brief block is part of loop
+ */
+bool Loops::contains(const LoopItem& loop, IrId block) const
+{
+	if(this->pNumber[block] == IrNone)
+	{
+		return false;
+	}
+	const IrId* first = this->pBlocks.data() + loop.first;
+	const IrId* last  = first + loop.count;
+	const IrId* it    = std::lower_bound(first, last, block, [this](IrId a, IrId b)
+	{
+		return this->pNumber[a] < this->pNumber[b];
+	});
+	return it != last && *it == block;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+#include "Dominator.hpp"
+
+#include <vector>
+
+/**
+ * \brief natural loop
+ * \note blocks are in pBlocks of Loops from first in reverse postorder (header first),
+ *       preheader is the only predecessor of header outside of the loop when it ends with jump
+ *       to the header, latch is the only block with back edge (IrNone when there is none)
+ */
+struct LoopItem
+{
+	IrId header;
+	IrId preheader;
+	IrId latch;
+	u32  first;
+	u32  count;
+};
+
+/**
+ * \brief natural loops of finished function
+ * \note edge is back edge when its target dominates its source, loop of header is the header
+ *       and blocks which reach its back edges without passing through the header.
+ *       Loops are ordered from the innermost (smaller loop first), so pass which changes
+ *       inner loop has done it before it looks at the outer loop.
+ */
+class Loops
+{
+public:
+	/**
+	 * \brief find loops of function with computed dominator tree
+	 */
+	void run(const Codegen& code, const Dominator& dom);
+
+	u32             count() const                { return this->pLoops.size(); }
+	const LoopItem& loop(u32 index) const        { return this->pLoops[index]; }
+	const IrId*     blocks(const LoopItem& loop) const { return this->pBlocks.data() + loop.first; }
+	bool            contains(const LoopItem& loop, IrId block) const;
+
+private:
+	std::vector<LoopItem> pLoops;
+	std::vector<IrId>     pBlocks;
+	//position of every block in reverse postorder (blocks of loop are sorted by it)
+	std::vector<u32>      pNumber;
+	std::vector<u32>      pMark;
+	std::vector<IrId>     pWork;
+};
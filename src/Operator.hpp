@@ -0,0 +1,219 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+
+#include <type_traits>
+
+/**
+ * \brief semantics of binary operators
+ * \note the only definition of what operators compute, used by constant folding of the parser
+ *       and of the code generator and by anything which runs the operations, so folded values
+ *       and computed values are the same bit for bit.
+ *
+ *       operands are byte (u8), int (i64) or float (f64), both are converted to the type
+ *       with higher rank (byte < int < float) before the operation
+ *       integer arithmetic wraps around, byte is unsigned, division rounds toward zero
+ *       and INT64_MIN / -1 is INT64_MIN
+ *       comparisons give int 0 or 1
+ *       shifts take the count modulo the width, mulh is the high half of the signed product
+ *       (they are used only by the code generator on integers)
+ *       division by zero has no result (the parser reports it, the code generator keeps it for runtime)
+ */
+
+/**
+ * \brief type of operation with operands of types L and R
+ */
+template<class L, class R>
+using OperatorCommon = typename std::conditional<std::is_same<L, f64>::value || std::is_same<R, f64>::value, f64,
+                       typename std::conditional<std::is_same<L, i64>::value || std::is_same<R, i64>::value, i64, u8>::type>::type;
+
+/**
+ * \brief operator compares its operands
+ */
+static constexpr bool OperatorComparison(IrOp op)
+{
+	return op == IrOp::Lt || op == IrOp::Le || op == IrOp::Gt || op == IrOp::Ge || op == IrOp::Eq || op == IrOp::Ne;
+}
+
+/**
+ * \brief type of result of operator Op with operands of types L and R
+ */
+template<IrOp Op, class L, class R>
+using OperatorResult = typename std::conditional<OperatorComparison(Op), i64, OperatorCommon<L, R>>::type;
+
+/**
+ * \brief IrType of value type
+ */
+template<class T>
+static constexpr IrType OperatorType = std::is_same<T, f64>::value ? IrType::F64 : std::is_same<T, u8>::value ? IrType::U8 : IrType::I64;
+
+/**
+ * \brief integer arithmetic is computed unsigned so it wraps around
+ */
+template<class T, bool Integral = std::is_integral<T>::value>
+struct OperatorUnsigned
+{
+	using type = T;
+};
+template<class T>
+struct OperatorUnsigned<T, true>
+{
+	using type = typename std::make_unsigned<T>::type;
+};
+
+/**
+ * \brief high half of signed product
+ */
+static constexpr i64 OperatorMulHi(i64 a, i64 b)
+{
+	u64 x  = (u64)a;
+	u64 y  = (u64)b;
+	u64 lo = (x & 0xffffffff) * (y & 0xffffffff);
+	u64 m1 = (x >> 32) * (y & 0xffffffff) + (lo >> 32);
+	u64 m2 = (x & 0xffffffff) * (y >> 32) + (m1 & 0xffffffff);
+	u64 hi = (x >> 32) * (y >> 32) + (m1 >> 32) + (m2 >> 32);
+
+	//unsigned product corrected for negative operands
+	hi -= a < 0 ? y : 0;
+	hi -= b < 0 ? x : 0;
+	return (i64)hi;
+}
+
+/**
+ * \brief result of operator Op for operands of types L and R (false when it has no result)
+ */
+template<IrOp Op, class L, class R>
+constexpr bool OperatorApply(L lhs, R rhs, OperatorResult<Op, L, R>& result)
+{
+	using T = OperatorCommon<L, R>;
+	using U = typename OperatorUnsigned<T>::type;
+
+	T a = (T)lhs;
+	T b = (T)rhs;
+
+	if constexpr(Op == IrOp::Add) { result = (T)((U)a + (U)b); }
+	if constexpr(Op == IrOp::Sub) { result = (T)((U)a - (U)b); }
+	if constexpr(Op == IrOp::Mul) { result = (T)((U)a * (U)b); }
+	if constexpr(Op == IrOp::Div)
+	{
+		if(b == 0)
+		{
+			return false;
+		}
+		if constexpr(std::is_signed<T>::value && std::is_integral<T>::value)
+		{
+			result = b == -1 ? (T)(0 - (U)a) : a / b;
+		}
+		else
+		{
+			result = a / b;
+		}
+	}
+	if constexpr(Op == IrOp::Shl || Op == IrOp::Shr || Op == IrOp::Sar || Op == IrOp::MulHi)
+	{
+		if constexpr(std::is_integral<T>::value)
+		{
+			u32 count = (u32)b & (sizeof(T) * 8 - 1);
+			if constexpr(Op == IrOp::Shl)   { result = (T)((U)a << count); }
+			if constexpr(Op == IrOp::Shr)   { result = (T)((U)a >> count); }
+			if constexpr(Op == IrOp::Sar)   { result = (T)(a >> count); }
+			if constexpr(Op == IrOp::MulHi) { result = sizeof(T) == 8 ? (T)OperatorMulHi((i64)a, (i64)b) : (T)(((u32)a * (u32)b) >> 8); }
+		}
+		else
+		{
+			return false;
+		}
+	}
+	if constexpr(Op == IrOp::Lt) { result = a < b; }
+	if constexpr(Op == IrOp::Le) { result = a <= b; }
+	if constexpr(Op == IrOp::Gt) { result = a > b; }
+	if constexpr(Op == IrOp::Ge) { result = a >= b; }
+	if constexpr(Op == IrOp::Eq) { result = a == b; }
+	if constexpr(Op == IrOp::Ne) { result = a != b; }
+	return true;
+}
+
+/**
+ * \brief constant computed by operator
+ */
+struct OperatorValue
+{
+	IrType type;
+	i64    i;
+	f64    f;
+};
+
+/**
+ * \brief result of operator stored as constant
+ */
+template<IrOp Op, class L, class R>
+constexpr bool OperatorStore(L lhs, R rhs, OperatorValue& value)
+{
+	using T = OperatorResult<Op, L, R>;
+
+	T result = 0;
+	if(!OperatorApply<Op>(lhs, rhs, result))
+	{
+		return false;
+	}
+	value.type = OperatorType<T>;
+	value.i    = std::is_same<T, f64>::value ? 0 : (i64)result;
+	value.f    = std::is_same<T, f64>::value ? (f64)result : 0.0;
+	return true;
+}
+
+/**
+ * \brief result of operator known at runtime (false when the operator has no result for the operands
+ *        or it is not a binary operator of the language)
+ */
+template<class L, class R>
+constexpr bool OperatorEval(IrOp op, L lhs, R rhs, OperatorValue& value)
+{
+	switch(op)
+	{
+		case IrOp::Add:    { return OperatorStore<IrOp::Add>(lhs, rhs, value); }
+		case IrOp::Sub:    { return OperatorStore<IrOp::Sub>(lhs, rhs, value); }
+		case IrOp::Mul:    { return OperatorStore<IrOp::Mul>(lhs, rhs, value); }
+		case IrOp::Div:    { return OperatorStore<IrOp::Div>(lhs, rhs, value); }
+		case IrOp::Shl:    { return OperatorStore<IrOp::Shl>(lhs, rhs, value); }
+		case IrOp::Shr:    { return OperatorStore<IrOp::Shr>(lhs, rhs, value); }
+		case IrOp::Sar:    { return OperatorStore<IrOp::Sar>(lhs, rhs, value); }
+		case IrOp::MulHi:  { return OperatorStore<IrOp::MulHi>(lhs, rhs, value); }
+		case IrOp::Lt:     { return OperatorStore<IrOp::Lt>(lhs, rhs, value); }
+		case IrOp::Le:     { return OperatorStore<IrOp::Le>(lhs, rhs, value); }
+		case IrOp::Gt:     { return OperatorStore<IrOp::Gt>(lhs, rhs, value); }
+		case IrOp::Ge:     { return OperatorStore<IrOp::Ge>(lhs, rhs, value); }
+		case IrOp::Eq:     { return OperatorStore<IrOp::Eq>(lhs, rhs, value); }
+		case IrOp::Ne:     { return OperatorStore<IrOp::Ne>(lhs, rhs, value); }
+		default:           { return false; }
+	}
+}
+
+/**
+ * \brief constant converted to type (false when float is out of integer range)
+ * \note byte is integer truncated to 8 bits, float is truncated toward zero
+ */
+static constexpr bool OperatorConvert(const OperatorValue& value, IrType to, OperatorValue& result)
+{
+	result.type = to;
+	result.i    = 0;
+	result.f    = 0.0;
+	if(to == IrType::F64)
+	{
+		result.f = value.type == IrType::F64 ? value.f : (f64)value.i;
+		return true;
+	}
+
+	i64 i = value.i;
+	if(value.type == IrType::F64)
+	{
+		if(!(value.f > -9223372036854775808.0 && value.f < 9223372036854775808.0))
+		{
+			return false;
+		}
+		i = (i64)value.f;
+	}
+	result.i = to == IrType::U8 ? (i & 0xff) : i;
+	return true;
+}
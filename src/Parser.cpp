@@ -1,16 +1,166 @@
 #include "Parser.hpp"
 
+#include <cstdarg>
+#include <thread>
+
 /**
- * ybrief debug messages
+ * \brief initialize parser
  */
-static const char* ParserReturnTypeString[] =
+Parser::Parser()
 {
-	[(u32)Parser::ReturnType::Byte] = "ReturnType::Byte",
-	[(u32)Parser::ReturnType::Int] = "ReturnType::Int",
-	[(u32)Parser::ReturnType::Float] = "ReturnType::Float",
-	[(u32)Parser::ReturnType::Void] = "ReturnType::Void",
-	[(u32)Parser::ReturnType::Pack] = "ReturnType::Pack",
-};
+	this->pPipeline     = false;
+	this->pRing         = nullptr;
+	this->pBatchPos     = 0;
+	this->pPrepared     = true;
+	this->pEmitter      = nullptr;
+	this->pSink         = EmitterSink::Text;
+	this->pTarget       = &Targets[0];
+	this->pJobs         = 1;
+	this->pSkipBodies   = false;
+	this->pLazy         = false;
+	this->pUnrollFactor = 4;
+	this->pStream       = false;
+	this->pPackReorder  = false;
+	this->pGlobal       = nullptr;
+	this->pSourceMap    = nullptr;
+	this->pVisible      = 0;
+	this->pErrorCount   = 0;
+	this->pMaxErrors    = 20;
+	this->pScope        = 0;
+	this->pExprTarget   = Parser::ValueType::None;
+	this->pExprType     = Parser::ValueType::None;
+	this->pExprPackSink = Parser::PackSink::Var;
+	this->pExprConstant = false;
+	this->pCode         = &this->pBody;
+	this->pInitUsed     = false;
+	this->pBodyErrors   = 0;
+	this->pExprResult   = IrNone;
+	this->pRetMemory    = IrNone;
+	this->pPackOpen     = false;
+
+	this->pInit.setTarget(this->pTarget);
+	this->pInit.begin("__init");
+}
+
+/**
+ * \brief fetch next token from scanner thread or directly from scanner
+ */
+Scanner::Token Parser::nextToken()
+{
+	if(this->pRing != nullptr)
+	{
+		return this->ringToken();
+	}
+
+	return this->pScanner.getToken();
+}
+
+/**
+ * \brief print trace message into output
+ */
+void Parser::emit(const char* fmt, ...)
+{
+	va_list args;
+	char    buffer[512];
+
+	va_start(args, fmt);
+	int size = std::vsnprintf(buffer, sizeof(buffer), fmt, args);
+	va_end(args);
+
+	//message didn't fit into the buffer -> format it again into temporary string
+	if(size >= (int)sizeof(buffer))
+	{
+		std::string message(size + 1, '\0');
+
+		va_start(args, fmt);
+		std::vsnprintf(&message[0], size + 1, fmt, args);
+		va_end(args);
+
+		this->pEmitter->text(message.data(), size);
+	}
+	else if(size > 0)
+	{
+		this->pEmitter->text(buffer, size);
+	}
+}
+
+/**
+ * \brief release memory used by finished function (its code was already written by emitter)
+ */
+void Parser::flushStream()
+{
+	//large function shouldn't keep its memory until the end of compilation
+	if(this->pStack.capacity() > 1024)
+	{
+		this->pStack.shrink_to_fit();
+	}
+	if(this->pVariables.bucket_count() > 4 * this->pVariables.size() + 1024)
+	{
+		this->pVariables.rehash(0);
+	}
+}
+
+/**
+ * \brief symbol lookup in local tables and in global tables of parent parser
+ */
+const Parser::VariableItem* Parser::findVariable(const std::string& name) const
+{
+	auto it = this->pVariables.find(name);
+	if(it != this->pVariables.end())
+	{
+		return &it->second;
+	}
+	const VariableItem* global = this->pGlobal != nullptr ? this->pGlobal->findVariable(name) : nullptr;
+	return global != nullptr && global->offset < this->pVisible ? global : nullptr;
+}
+const Parser::FunctionItem* Parser::findFunction(const std::string& name) const
+{
+	auto it = this->pFunctions.find(name);
+	if(it != this->pFunctions.end())
+	{
+		return &it->second;
+	}
+	const FunctionItem* global = this->pGlobal != nullptr ? this->pGlobal->findFunction(name) : nullptr;
+	return global != nullptr && global->offset < this->pVisible ? global : nullptr;
+}
+const Parser::PackItem* Parser::findPackage(const std::string& name) const
+{
+	auto it = this->pPackages.find(name);
+	if(it != this->pPackages.end())
+	{
+		return &it->second;
+	}
+	const PackItem* global = this->pGlobal != nullptr ? this->pGlobal->findPackage(name) : nullptr;
+	return global != nullptr && global->offset < this->pVisible ? global : nullptr;
+}
+
+/**
+ * \brief resolve item of package variable
+ */
+Error Parser::findField(const std::string& var, const std::string& name, u64 offset, VarType& type, u64& index) const
+{
+	const VariableItem* v = this->findVariable(var);
+	if(v == nullptr)
+	{
+		return Error(Error::Code::UndefinedReference, offset);
+	}
+	if(v->varType != Parser::VarType::Pack)
+	{
+		return Error(Error::Code::FieldNotPack, offset, var.c_str());
+	}
+
+	const PackItem* pack = this->findPackage(v->pack);
+	auto            it   = pack->index.find(name);
+	if(it == pack->index.end())
+	{
+		return Error(Error::Code::FieldUndefined, offset, v->pack.c_str(), name.c_str());
+	}
+
+	type  = pack->items[it->second].type;
+	index = it->second;
+
+	return Error(Error::Type::Ok);
+}
 
 /**
  * \brief manage creating of variable
@@ -18,26 +168,25 @@ static const char* ParserReturnTypeString[] =
 Error Parser::createVar(std::string& name, Parser::VarType type, u64 scope)
 {
 	//if the identificator is not already in the functions table -> continute
-	if(this->pFunctions.find(name) == this->pFunctions.end())
+	if(this->findFunction(name) == nullptr)
 	{
-		auto it = this->pVariables.find(name);
-
 		//if there is no variable with the same name -> add it into the table
-		if(it == this->pVariables.end())
+		if(this->findVariable(name) == nullptr)
 		{
 			this->pVariables[name] = VariableItem();
 			this->pVariables[name].varType = type;
 			this->pVariables[name].scope   = scope;
+			this->pVariables[name].offset  = this->pPrevToken.offset;
 		}
 		//TODO: allow global and local variables with same name
 		else
 		{
-			return Error(Error::Type::Syntax, "Cannot redefine variable");
+			return Error(Error::Code::VariableRedefinition, this->pPrevToken.offset);
 		}
 	}
 	else
 	{
-		return Error(Error::Type::Syntax, "Cannot define variable with same name as function");
+		return Error(Error::Code::VariableFunctionName, this->pPrevToken.offset);
 	}
 
 	return Error(Error::Type::Ok);
@@ -64,1126 +213,1453 @@ void Parser::exitScope()
 	}
 }
 
-#define ParserProcessState(s) do { Error e = s; if(e.type != Error::Type::Ok) { return e; } } while(0)
-
 /**
- * \brief implementation of <prog> rule
- * \note see ll.grammar
+ * \brief start code of function body, arguments become SSA variables
+ * \note small package argument arrives as one argument per item, large package is in memory,
+ *       memory for large returned package is passed as hidden first argument
  */
-//TODO: when calling another state, check its return value
-Error Parser::prog()
+void Parser::bodyBegin()
 {
-	this->pToken = this->pScanner.getToken();
-
-	/* <prog> -> FUNC ID ( <def-args> : <type> { <body> <prog> */
-	if(this->pToken.type              == Scanner::TokenType::Keyword && 
-	   this->pToken.attribute.keyword == Scanner::KeywordType::Func)
+	this->pBodyErrors = this->pErrorCount;
+	this->pCode       = &this->pBody;
+	this->pExprResult = IrNone;
+	this->pRetMemory  = IrNone;
+	this->pBranches.clear();
+	this->pBody.setTarget(this->pTarget);
+	this->pBody.begin(this->pCurrFunctionName, this->pToken.offset);
+
+	const FunctionItem* function = this->findFunction(this->pCurrFunctionName);
+	if(function == nullptr)
 	{
-		this->pToken = this->pScanner.getToken();
-		//after FUNC must be ID
-		if(this->pToken.type == Scanner::TokenType::Id)
-		{
-			//save function id
-			this->pCurrFunctionName = this->pToken.attribute.litString;
-
-			//check if function name isn't in variable table
-			if(this->pVariables.find(this->pCurrFunctionName) == this->pVariables.end())
-			{
-				//check if function isn't already defined
-				if(this->pFunctions.find(this->pCurrFunctionName) == this->pFunctions.end())
-				{
-					//create new function in symbol table
-					//its' attributes will be set later
-					this->pFunctions[this->pCurrFunctionName] = FunctionItem();
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Cannot redefine function [%s]", this->pCurrFunctionName.c_str());
-				}
-			}
-			else
-			{	
-				return Error(Error::Type::Syntax, "Cannot define function with same name as variable [%s]", this->pCurrFunctionName.c_str());
-			}
-
-			this->pToken = this->pScanner.getToken();
-			//after ID must be LEFT BRACKET
-			if(this->pToken.type == Scanner::TokenType::LeftBracket)
-			{
-				//after LEFT BRACKET are argument definitions
-				//it will modify the function in function table
-				ParserProcessState(this->defArgs());
-
-				this->pToken = this->pScanner.getToken();
-				//after argument definitions must be COLON
-				if(this->pToken.type == Scanner::TokenType::Colon)
-				{
-					//acter COLON must function TYPE
-					//it will modify the function in symbol table
-					ParserProcessState(this->funcType());
+		return;
+	}
 
-					this->pToken = this->pScanner.getToken();
-					//after function TYPE must be CURLY LEFT BRACKET
-					if(this->pToken.type == Scanner::TokenType::LeftCurlyBracket)
-					{
-						std::printf("Create function \"%s\" with return value of type \"%s\" and %llu arguments\n", 
-							this->pCurrFunctionName.c_str(), 
-							ParserReturnTypeString[(u32)this->pCurrFunctionReturnType], 
-							this->pCurrFunctionArgumentNum);
-
-						//after CURLY LEFT BRACKET must be function BODY
-						pScope++;
-						std::printf("Change scope to %llu\n", pScope);
-						ParserProcessState(this->body());
-						this->exitScope();
-						pScope--;
-						std::printf("Change scope to %llu\n", pScope);
-
-						//continue with the PROGRAM
-						ParserProcessState(this->prog());
-					}
-					else
-					{
-						return Error(Error::Type::Syntax, "Expected \"{\" after function type [%s]", this->pCurrFunctionName.c_str());
-					}
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expected \":\" after argument definitions [%s]", this->pCurrFunctionName.c_str());
-				}
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected \"(\" after function identificator [%s]", this->pCurrFunctionName.c_str());
-			}
-		}
-		else
-		{
-			return Error(Error::Type::Syntax, "Expected identificator after \"func\" keyword");
-		}
+	//large package is returned into memory of the caller, its address is the first argument
+	u32 index = 0;
+	if(function->retType == Parser::ReturnType::Pack && !this->findPackage(function->retPack)->registers)
+	{
+		this->pRetMemory = this->pBody.argument(index++, IrType::I64);
 	}
-	/* <prog> -> PACK ID { <pack-item> <prog> */
-	else if(this->pToken.type              == Scanner::TokenType::Keyword &&
-		    this->pToken.attribute.keyword == Scanner::KeywordType::Pack)
+
+	for(const FunctionItem::Arg& arg : function->args)
 	{
-		this->pToken = this->pScanner.getToken();
-		//after PACK must be ID
-		if(this->pToken.type == Scanner::TokenType::Id)
+		auto var = this->pVariables.find(arg.name);
+		if(var == this->pVariables.end())
 		{
-			//save package item
-			std::printf("Create new package %s\n", this->pToken.attribute.litString.c_str());
-			this->pCurrPackageName = this->pToken.attribute.litString;
-
-			//check if we haven't already defined package with the same name
-			if(this->pPackages.find(this->pCurrPackageName) == this->pPackages.end())
-			{
-				//insert package into package table
-				this->pPackages.insert({this->pCurrPackageName, PackItem()});
-
-				this->pToken = this->pScanner.getToken();
-				//after ID must be LEFT CURLY BRACK
-				if(this->pToken.type == Scanner::TokenType::LeftCurlyBracket)
-				{
-					ParserProcessState(this->packItem());
-					ParserProcessState(this->prog());
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expected \"{\" after package identificator [%s]", this->pCurrPackageName.c_str());
-				}
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Cannot redefine package with the same name [%s]", this->pCurrPackageName.c_str());
-			}
+			continue;
 		}
-		else
+
+		if(arg.type != Parser::VarType::Pack)
 		{
-			return Error(Error::Type::Syntax, "Expected identificator after \"pack\" keyword");
+			IrType type = (IrType)Parser::valueType(arg.type);
+			var->second.ir = this->pBody.variable(type);
+			this->pBody.write(var->second.ir, this->pBody.argument(index++, type));
 		}
-	}
-	/* <prog> -> BYTE   ID ; <prog> */
-	/* <prog> -> BYTE   ID = <expr> ; <prog> */
-	/* <prog> -> INT    ID ; <prog> */
-	/* <prog> -> INT    ID = <expr> ; <prog> */
-	/* <prog> -> FLOAT  ID ; <prog> */
-	/* <prog> -> FLOAT  ID = <expr> ; <prog> */
-	else if(this->pToken.type == Scanner::TokenType::Keyword)
-	{
-		if(this->pToken.attribute.keyword == Scanner::KeywordType::Byte  ||
-		   this->pToken.attribute.keyword == Scanner::KeywordType::Int   ||
-		   this->pToken.attribute.keyword == Scanner::KeywordType::Float)
+		else
 		{
-			switch(this->pToken.attribute.keyword)
-			{
-				case Scanner::KeywordType::Byte:   { this->pCurrVariableType = Parser::VarType::Byte;   break; }
-				case Scanner::KeywordType::Int:    { this->pCurrVariableType = Parser::VarType::Int;    break; }
-				case Scanner::KeywordType::Float:  { this->pCurrVariableType = Parser::VarType::Float;  break; }
-				default: { break; }
-			}
-
-			this->pToken = this->pScanner.getToken();
-			//after TYPE must be ID
-			if(this->pToken.type == Scanner::TokenType::Id)
+			//items of large package are loaded from the copy made by the caller
+			const PackItem* pack    = this->findPackage(arg.pack);
+			IrId            address = pack->registers ? IrNone : this->pBody.argument(index++, IrType::I64);
+			for(u64 i = 0; i < pack->items.size(); i++)
 			{
-				//save variable name
-				this->pCurrVariableName = this->pToken.attribute.litString;
-
-				this->pToken = this->pScanner.getToken();
-				/* <prog> -> BYTE/INT/FLOAT/STRING ID ; <prog> */
-				if(this->pToken.type == Scanner::TokenType::SemiColon)
-				{
-					//add variable into variable pool
-					this->createVar(this->pCurrVariableName, this->pCurrVariableType, 0);
-
-					switch(this->pCurrVariableType)
-					{
-						case Parser::VarType::Byte:   { std::printf("Define new variable \"%s\" of type \"byte\" in scope %llu\n",   this->pCurrVariableName.c_str(), this->pScope); break; }
-						case Parser::VarType::Int:    { std::printf("Define new variable \"%s\" of type \"int\" in scope %llu\n",    this->pCurrVariableName.c_str(), this->pScope); break; }
-						case Parser::VarType::Float:  { std::printf("Define new variable \"%s\" of type \"float\" in scope %llu\n",  this->pCurrVariableName.c_str(), this->pScope); break; }
-						default: { break; }
-					}
-
-					ParserProcessState(this->prog());
-				}
-				/* <prog> -> BYTE/INT/FLOAT/STRING ID = <expr> ; <prog> */
-				else if(this->pToken.type == Scanner::TokenType::Assign)
-				{
-					this->pToken = this->pScanner.getToken();
-					ParserProcessState(this->expr());
-
-					if(this->pToken.type == Scanner::TokenType::SemiColon)
-					{
-						//add variable into variable pool
-						this->createVar(this->pCurrVariableName, this->pCurrVariableType, 0);
-
-						switch(this->pCurrVariableType)
-						{
-							case Parser::VarType::Byte:   { std::printf("Define new variable \"%s\" of type \"byte\" and initialize with r0 in scope %llu\n",   this->pCurrVariableName.c_str(), this->pScope); break; }
-							case Parser::VarType::Int:    { std::printf("Define new variable \"%s\" of type \"int\" and initialize with r0 in scope %llu\n",    this->pCurrVariableName.c_str(), this->pScope); break; }
-							case Parser::VarType::Float:  { std::printf("Define new variable \"%s\" of type \"float\" and initialize with r0 in scope %llu\n",  this->pCurrVariableName.c_str(), this->pScope); break; }
-							default: { break; }
-						}
-
-						ParserProcessState(this->prog());
-					}
-					else
-					{
-						return Error(Error::Type::Syntax, "Expected \";\" after expression");
-					}
-				}
-				else
+				IrType type = (IrType)Parser::valueType(pack->items[i].type);
+				IrId   ir   = this->pBody.variable(type);
+				if(var->second.ir == IrNone)
 				{
-					return Error(Error::Type::Syntax, "Expected \";\" or assignment after variable declaration");
+					var->second.ir = ir;
 				}
+				IrId value = address == IrNone ? this->pBody.argument(index++, type) :
+					this->pBody.load(address, pack->layout.fields[i].offset, type);
+				this->pBody.write(ir, value);
 			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected identificator after type");
-			}
-		}
-		else
-		{
-			return Error(Error::Type::Syntax, "Unexpected keyword in the global scope");
 		}
 	}
-	/* <prog> -> ID     ID ; <prog> */
-	else if(this->pToken.type == Scanner::TokenType::Id)
+}
+
+/**
+ * \brief finish code of function body and write it out (body with errors is dropped)
+ */
+void Parser::bodyEnd()
+{
+	if(!this->pBody.terminated() && !this->pBody.unreachable())
 	{
-		return Error(Error::Type::Syntax, "NYI");
+		this->pBody.ret(nullptr, 0);
 	}
-	/* <prog> -> EOF */
-	else if(this->pToken.type == Scanner::TokenType::Eof)
+	if(this->pErrorCount != this->pBodyErrors)
 	{
-		return Error(Error::Type::Ok, "Reached the end of the source file");
+		return;
 	}
-	else
+
+	this->pBody.finish();
+	this->pSccp.run(this->pBody);
+	this->pGvn.run(this->pBody);
+	this->pLicm.run(this->pBody, *this->pTarget);
+	if(this->pUnroll.run(this->pBody, this->pUnrollFactor))
 	{
-		return Error(Error::Type::Syntax, "Unexpected token in the global scope");
+		this->pSccp.run(this->pBody);
+		this->pBody.resimplify();
+		this->pGvn.run(this->pBody);
 	}
-
-	return Error(Error::Type::Ok);
+	this->pRegalloc.run(this->pBody, *this->pTarget);
+	this->pEmitter->function(this->pBody);
 }
+
 /**
- * \brief implementation of <def-args> rule
- * \note see ll.grammar
+ * \brief string form of variable type for debug purposes
  */
-Error Parser::defArgs()
+static const char* ParserVarTypeString[] =
 {
-	//reset current function
-	this->pCurrFunctionArgumentNum = 0;
-
-	this->pToken = this->pScanner.getToken();
+	"byte", "int", "float", "pack",
+};
 
-	/* <def-args> -> BYTE   ID <def-args-list> */
-	/* <def-args> -> INT    ID <def-args-list> */
-	/* <def-args> -> FLOAT  ID <def-args-list> */
-	/* <def-args> -> STRING ID <def-args-list> */
-	if(this->pToken.type == Scanner::TokenType::Keyword)
+/**
+ * \brief convert token into terminal of the grammar
+ */
+static ParserTerminal ParserTerminalOf(const Scanner::Token& token)
+{
+	switch(token.type)
 	{
-		if(this->pToken.attribute.keyword == Scanner::KeywordType::Byte  ||
-	       this->pToken.attribute.keyword == Scanner::KeywordType::Int   ||
-	   	   this->pToken.attribute.keyword == Scanner::KeywordType::Float)
+		case Scanner::TokenType::Keyword:
 		{
-			switch(this->pToken.attribute.keyword)
-			{
-				case Scanner::KeywordType::Byte:   { this->pCurrVariableType = Parser::VarType::Byte;   break; }
-				case Scanner::KeywordType::Int:    { this->pCurrVariableType = Parser::VarType::Int;    break; }
-				case Scanner::KeywordType::Float:  { this->pCurrVariableType = Parser::VarType::Float;  break; }
-				default: { break; }
-			}
-
-			this->pToken = this->pScanner.getToken();
-			//after argument TYPE must be argument ID
-			if(this->pToken.type == Scanner::TokenType::Id)
-			{
-				//add argument into symbol table function
-				this->pFunctions[this->pCurrFunctionName].args.emplace_back(this->pCurrVariableType);
-				//add argument into local variable pool
-				this->createVar(this->pToken.attribute.litString, this->pCurrVariableType, this->pScope + 1);
-
-				switch(this->pCurrVariableType)
-				{
-					case Parser::VarType::Byte:   { std::printf("Define new argument \"%s\" of type \"byte\" in scope %llu\n",   this->pToken.attribute.litString.c_str(), this->pScope + 1); break; }
-					case Parser::VarType::Int:    { std::printf("Define new argument \"%s\" of type \"int\" in scope %llu\n",    this->pToken.attribute.litString.c_str(), this->pScope + 1); break; }
-					case Parser::VarType::Float:  { std::printf("Define new argument \"%s\" of type \"float\" in scope %llu\n",  this->pToken.attribute.litString.c_str(), this->pScope + 1); break; }
-					default: { break; }
-				}
-
-				this->pCurrFunctionArgumentNum++;
-				//process next argument definition or end
-				ParserProcessState(this->defArgsList());
-			}
-			else
+			switch(token.attribute.keyword)
 			{
-				return Error(Error::Type::Syntax, "Expected identificator after type when defining function argument");
+				case Scanner::KeywordType::Func:   { return ParserTerminal::Func; }
+				case Scanner::KeywordType::Pack:   { return ParserTerminal::Pack; }
+				case Scanner::KeywordType::Byte:   { return ParserTerminal::Byte; }
+				case Scanner::KeywordType::Int:    { return ParserTerminal::Int; }
+				case Scanner::KeywordType::Float:  { return ParserTerminal::Float; }
+				case Scanner::KeywordType::Void:   { return ParserTerminal::Void; }
+				case Scanner::KeywordType::Return: { return ParserTerminal::Return; }
+				case Scanner::KeywordType::If:     { return ParserTerminal::If; }
+				case Scanner::KeywordType::Else:   { return ParserTerminal::Else; }
+				case Scanner::KeywordType::While:  { return ParserTerminal::While; }
+				case Scanner::KeywordType::For:    { return ParserTerminal::For; }
+				default:                           { return ParserTerminal::Other; }
 			}
 		}
-		else 
-		{
-			return Error(Error::Type::Syntax, "Expected type when defining function argument");
-		}
+		case Scanner::TokenType::Id:                { return ParserTerminal::Id; }
+		case Scanner::TokenType::Int:               { return ParserTerminal::Number; }
+		case Scanner::TokenType::Float:             { return ParserTerminal::Number; }
+		case Scanner::TokenType::String:            { return ParserTerminal::String; }
+		case Scanner::TokenType::LeftBracket:       { return ParserTerminal::LeftBracket; }
+		case Scanner::TokenType::RightBracket:      { return ParserTerminal::RightBracket; }
+		case Scanner::TokenType::LeftCurlyBracket:  { return ParserTerminal::LeftCurlyBracket; }
+		case Scanner::TokenType::RightCurlyBracket: { return ParserTerminal::RightCurlyBracket; }
+		case Scanner::TokenType::Colon:             { return ParserTerminal::Colon; }
+		case Scanner::TokenType::SemiColon:         { return ParserTerminal::SemiColon; }
+		case Scanner::TokenType::Comma:             { return ParserTerminal::Comma; }
+		case Scanner::TokenType::Dot:               { return ParserTerminal::Dot; }
+		case Scanner::TokenType::Assign:            { return ParserTerminal::Assign; }
+		case Scanner::TokenType::Eof:               { return ParserTerminal::Eof; }
+		default:                                    { return ParserTerminal::Other; }
 	}
-	/* <def-args> -> ID ID <def-args-list> */
-	/*else if(this->pToken.type == Scanner::TokenType::Id)
-	{
-		//save structure name
-		std::string structName = this->pToken.attribute.litString;
-		
-		this->pToken = this->pScanner.getToken();
-		//after argument TYPE must be argument ID
-		if(this->pToken.type == Scanner::TokenType::Id)
-		{
-			//add argument into symbol table function
-			this->pFunctions[this->pCurrFunctionName].args.emplace_back(Parser::VarType::Struct);
-			//add argument into local variable pool
-			this->createVar(this->pToken.attribute.litString, Parser::VarType::Struct, this->pScope + 1);
-
-			std::printf("Define argument of type \"%s\" and name \"%s\"\n", structName.c_str(), this->pToken.attribute.litString.c_str());
+}
 
-			this->pCurrFunctionArgumentNum++;
-			//process next argument definition or end
-			this->defArgsList();
-		}
-		else
-		{
-			throw std::runtime_error("Expected identificator after type\n");
-		}
-	}*/
-	/* <def-args> -> ) */
-	else if(this->pToken.type == Scanner::TokenType::RightBracket)
-	{
-		return Error(Error::Type::Ok);
-	}
-	else
+/**
+ * \brief name of the token for error messages
+ */
+static std::string ParserTokenName(const Scanner::Token& token)
+{
+	if(token.type == Scanner::TokenType::Id)
 	{
-		return Error(Error::Type::Syntax, "Unexpected symbol near function argument definition e");
+		return "\"" + token.attribute.litString + "\"";
 	}
-
-	return Error(Error::Type::Ok);
+	return ParserTerminalName[(u32)ParserTerminalOf(token)];
 }
+
 /**
- * \brief implementation of <def-args-list> rule
- * \note see ll.grammar
+ * \brief table driven LL(1) parsing of rule
+ * \note the lookahead token is expected to be fetched
  */
-//TODO: check names of packages, functions and variables
-Error Parser::defArgsList()
+Error Parser::derive(ParserRule rule)
 {
-	this->pToken = this->pScanner.getToken();
-	
-	/* <def-args-list> -> , BYTE   ID <def-args-list> */
-	/* <def-args-list> -> , INT    ID <def-args-list> */
-	/* <def-args-list> -> , FLOAT  ID <def-args-list> */
-	/* <def-args-list> -> , ID     ID <def-args-list> */
-	if(this->pToken.type == Scanner::TokenType::Comma)
+	//nested derivations (call arguments) share the stack above this base
+	u64 base = this->pStack.size();
+	this->pStack.push_back(ParserSymbolRule | (ParserSymbol)rule);
+
+	while(this->pStack.size() > base)
 	{
-		this->pToken = this->pScanner.getToken();
+		ParserSymbol symbol = this->pStack.back();
+		ParserSymbol index  = symbol & ~ParserSymbolKind;
+		this->pStack.pop_back();
 
-		/* <def-args-list> -> , BYTE   ID <def-args-list> */
-		/* <def-args-list> -> , INT    ID <def-args-list> */
-		/* <def-args-list> -> , FLOAT  ID <def-args-list> */
-		if(this->pToken.type == Scanner::TokenType::Keyword)
+		switch(symbol & ParserSymbolKind)
 		{
-			if(this->pToken.attribute.keyword == Scanner::KeywordType::Byte  ||
-		       this->pToken.attribute.keyword == Scanner::KeywordType::Int   ||
-		   	   this->pToken.attribute.keyword == Scanner::KeywordType::Float)
+			//terminal must match the lookahead token
+			case ParserSymbolTerminal:
 			{
-				switch(this->pToken.attribute.keyword)
+				if((ParserSymbol)ParserTerminalOf(this->pToken) != index)
 				{
-					case Scanner::KeywordType::Byte:   { this->pCurrVariableType = Parser::VarType::Byte;   break; }
-					case Scanner::KeywordType::Int:    { this->pCurrVariableType = Parser::VarType::Int;    break; }
-					case Scanner::KeywordType::Float:  { this->pCurrVariableType = Parser::VarType::Float;  break; }
-					default: { break; }
+					ParserProcessState(this->fail(Error(Error::Code::ExpectedAfter, this->pToken.offset, 
+						ParserTerminalName[index], ParserTokenName(this->pPrevToken).c_str()), base, true));
+					break;
 				}
 
-				this->pToken = this->pScanner.getToken();
-				//after argument TYPE must be argument ID
-				if(this->pToken.type == Scanner::TokenType::Id)
-				{
-					//add argument into symbol table function
-					this->pFunctions[this->pCurrFunctionName].args.emplace_back(this->pCurrVariableType);
-					//add argument into local variable pool
-					this->createVar(this->pToken.attribute.litString, this->pCurrVariableType, this->pScope + 1);
-
-					switch(this->pCurrVariableType)
-					{
-						case Parser::VarType::Byte:   { std::printf("Define new argument \"%s\" of type \"byte\" and initialize with r0 in scope %llu\n",   this->pToken.attribute.litString.c_str(), this->pScope + 1); break; }
-						case Parser::VarType::Int:    { std::printf("Define new argument \"%s\" of type \"int\" and initialize with r0 in scope %llu\n",    this->pToken.attribute.litString.c_str(), this->pScope + 1); break; }
-						case Parser::VarType::Float:  { std::printf("Define new argument \"%s\" of type \"float\" and initialize with r0 in scope %llu\n",  this->pToken.attribute.litString.c_str(), this->pScope + 1); break; }
-						default: { break; }
-					}
-
-					this->pCurrFunctionArgumentNum++;
-					//process next argument definition or end
-					ParserProcessState(this->defArgsList());
-				}
-				else
+				this->pPrevToken = std::move(this->pToken);
+				this->pToken     = this->nextToken();
+				break;
+			}
+			//rule is replaced by the production selected by the lookahead token
+			case ParserSymbolRule:
+			{
+				u8 production = ParserTable[index][(u32)ParserTerminalOf(this->pToken)];
+				if(production == ParserNoProduction)
 				{
-					return Error(Error::Type::Syntax, "Expected identificator after type");
+					//the rule stays on the stack, recovery can continue with it (statement of the same block)
+					this->pStack.push_back(symbol);
+					ParserProcessState(this->fail(Error(Error::Code::UnexpectedAfter, this->pToken.offset, 
+						ParserTokenName(this->pToken).c_str(), ParserTokenName(this->pPrevToken).c_str(), ParserRuleExpected[index]), base, true));
+					break;
 				}
+
+				this->pStack.insert(this->pStack.end(), 
+					&ParserProductionSymbols[ParserProductionStart[production]], 
+					&ParserProductionSymbols[ParserProductionStart[production + 1]]);
+				break;
 			}
-			else 
+			//semantic action
+			default:
 			{
-				return Error(Error::Type::Syntax, "Expected type when defining function argument");
-			}
-		}
-
-		/* <def-args-list> -> , ID ID <def-args-list> */
-		else if(this->pToken.type == Scanner::TokenType::Id)
-		{
-			return Error(Error::Type::Syntax, "Creating packages as arguments is not yet implemented");
-			//save structure name
-			/*std::string structName = this->pToken.attribute.litString;
+				Error e = this->action((ParserAction)index);
+				if(e.type != Error::Type::Ok)
+				{
+					//expressions stop in the middle of the token sequence,
+					//other semantic errors leave the parser in consistent state
+					bool resync = e.type != Error::Type::Semantic || 
+						(ParserAction)index == ParserAction::Expr || (ParserAction)index == ParserAction::Arg ||
+						(ParserAction)index == ParserAction::AssignCheck || (ParserAction)index == ParserAction::FieldName;
 
-			this->pToken = this->pScanner.getToken();
-			//after argument TYPE must be argument ID
-			if(this->pToken.type == Scanner::TokenType::Id)
-			{
-				//add argument into symbol table function
-				this->pFunctions[this->pCurrFunctionName].args.emplace_back(Parser::VarType::Struct);
-				//add argument into local variable pool
-				this->createVar(this->pToken.attribute.litString, Parser::VarType::Struct, this->pScope + 1);
-	
-				std::printf("Define argument of type \"%s\" and name \"%s\"\n", structName.c_str(), this->pToken.attribute.litString.c_str());
-
-				this->pCurrFunctionArgumentNum++;
-				//process next argument definition or end
-				this->defArgsList();
+					ParserProcessState(this->fail(e, base, resync));
+				}
+				break;
 			}
-			else
-			{
-				throw std::runtime_error("Expected identificator after type\n");
-			}*/
 		}
-		else
-		{
-			return Error(Error::Type::Syntax, "Unexpected symbol near function argument definition c");
-		}
-	}
-	else if(this->pToken.type == Scanner::TokenType::RightBracket)
-	{
-		return Error(Error::Type::Ok);
 	}
-	else
+
+	//the outermost derivation reports whether there were any errors
+	if(base == 0 && this->pErrorCount != 0)
 	{
-		return Error(Error::Type::Syntax, "Unexpected symbol near function argument definition a");
+		return Error(Error::Type::Syntax);
 	}
 
 	return Error(Error::Type::Ok);
 }
+
 /**
- * \brief implementation of <pack-item> rule
- * \note see ll.grammar
+ * \brief count error and try to continue parsing
+ * \note returns Ok when parsing can continue
  */
-Error Parser::packItem()
+Error Parser::fail(Error e, u64 base, bool resync)
 {
-	this->pToken = this->pScanner.getToken();
-	/* <pack-item> -> BYTE ID <pack-item-list> */
-	/* <pack-item> -> INT ID <pack-item-list> */
-	/* <pack-item> -> FLOAT ID <pack-item-list> */
-	if(this->pToken.type == Scanner::TokenType::Keyword)
+	//nested derivations leave the recovery to the outermost one
+	if(base != 0)
 	{
-		if(this->pToken.attribute.keyword == Scanner::KeywordType::Byte ||
-		   this->pToken.attribute.keyword == Scanner::KeywordType::Int  ||
-		   this->pToken.attribute.keyword == Scanner::KeywordType::Float)
-		{
-			switch(this->pToken.attribute.keyword)
-			{
-				case Scanner::KeywordType::Byte:   { this->pCurrVariableType = Parser::VarType::Byte;   break; }
-				case Scanner::KeywordType::Int:    { this->pCurrVariableType = Parser::VarType::Int;    break; }
-				case Scanner::KeywordType::Float:  { this->pCurrVariableType = Parser::VarType::Float;  break; }
-				default: { break; }
-			}
-
-			this->pToken = this->pScanner.getToken();
-			//after package item TYPE must be package item ID
-			if(this->pToken.type == Scanner::TokenType::Id)
-			{
-				//check if there are unique names for each package item
-				auto it = this->pPackages[this->pCurrPackageName].items.find(this->pToken.attribute.litString);
-				if(it == this->pPackages[this->pCurrPackageName].items.end())
-				{
-					std::printf("Add item into package \"%s\" <- \"%s\"\n", this->pCurrPackageName.c_str(), this->pToken.attribute.litString.c_str());
+		this->pStack.resize(base);
+		return e;
+	}
 
-					//add item into the package
-					this->pPackages[this->pCurrPackageName].items.insert({this->pToken.attribute.litString, this->pCurrVariableType});
+	this->pErrorCount++;
 
-					//scan for other items
-					ParserProcessState(this->packItemList());
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Cannot have same identificator for two package items [%s]", this->pToken.attribute.litString.c_str());
-				}
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected identificator after package item type");
-			}
-		}
-		else
+	if(this->pErrorCount >= this->pMaxErrors)
+	{
+		this->pStack.clear();
+		if(this->pMaxErrors > 1)
 		{
-			return Error(Error::Type::Syntax, "Expected item type when defining package item");
+			return Error(Error::Code::TooManyErrors, this->pToken.offset);
 		}
+		return e;
 	}
-	else if(this->pToken.type == Scanner::TokenType::RightCurlyBracket)
-	{
-		return Error(Error::Type::Syntax, "Expected at least one item in package");
-	}
-	else
+
+	if(resync && !this->recover())
 	{
-		return Error(Error::Type::Syntax, "Expected item type when defining package item");
+		this->pStack.clear();
+		return e;
 	}
 
 	return Error(Error::Type::Ok);
 }
+
 /**
- * \brief implementation of <pack-item-list> rule
- * \note see ll.grammar
+ * \brief panic mode recovery, skip tokens up to synchronizing token and unwind parse stack
+ * \note synchronizes at ";", "}", "func", "pack" and end of file
  */
-Error Parser::packItemList()
+bool Parser::recover()
 {
-	this->pToken = this->pScanner.getToken();
-	//after package item ID must be SEMICOLON
-	if(this->pToken.type == Scanner::TokenType::SemiColon)
+	static const ParserSymbol body         = ParserSymbolRule | (ParserSymbol)ParserRule::Body;
+	static const ParserSymbol prog         = ParserSymbolRule | (ParserSymbol)ParserRule::Prog;
+	static const ParserSymbol packItemList = ParserSymbolRule | (ParserSymbol)ParserRule::PackItemList;
+	static const ParserSymbol packItemTail = ParserSymbolRule | (ParserSymbol)ParserRule::PackItemTail;
+	static const ParserSymbol ifTail       = ParserSymbolRule | (ParserSymbol)ParserRule::IfTail;
+	static const ParserSymbol elseTail     = ParserSymbolRule | (ParserSymbol)ParserRule::Else;
+
+	//find the nearest of rules which can continue after synchronizing token
+	auto find = [this](ParserSymbol a, ParserSymbol b, ParserSymbol c) -> u64
 	{
-		this->pToken = this->pScanner.getToken();
-		/* <pack-item-list> -> ; } */
-		if(this->pToken.type == Scanner::TokenType::RightCurlyBracket)
+		for(u64 i = this->pStack.size(); i-- > 0;)
 		{
-			return Error(Error::Type::Ok);
+			if(this->pStack[i] == a || this->pStack[i] == b || this->pStack[i] == c)
+			{
+				return i;
+			}
 		}
-		else
+		return (u64)-1;
+	};
+
+	while(true)
+	{
+		u64 target = (u64)-1;
+		bool eat   = false;
+
+		switch(ParserTerminalOf(this->pToken))
 		{
-			/* <pack-item-list> -> ; BYTE ID <pack-item-list> */
-			/* <pack-item-list> -> ; INT ID <pack-item-list> */
-			/* <pack-item-list> -> ; FLOAT ID <pack-item-list> */
-			if(this->pToken.type == Scanner::TokenType::Keyword)
+			//continue with the next statement or declaration
+			case ParserTerminal::SemiColon:
+			{
+				target = find(body, prog, packItemList);
+				eat    = target != (u64)-1 && this->pStack[target] != packItemList;
+				break;
+			}
+			//close the block
+			case ParserTerminal::RightCurlyBracket:
+			{
+				target = find(body, packItemTail, packItemTail);
+				//item list of package was already discarded, "}" ends the package
+				if(target == (u64)-1 && this->pPackOpen)
+				{
+					target = find(prog, prog, prog);
+					eat    = true;
+				}
+				break;
+			}
+			//continue with the next global declaration
+			case ParserTerminal::Func:
+			case ParserTerminal::Pack:
+			case ParserTerminal::Eof:
 			{
-				if(this->pToken.attribute.keyword == Scanner::KeywordType::Byte ||
-				   this->pToken.attribute.keyword == Scanner::KeywordType::Int  ||
-				   this->pToken.attribute.keyword == Scanner::KeywordType::Float)
+				target = find(prog, prog, prog);
+				if(target == (u64)-1)
 				{
+					return false;
+				}
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
 
-					switch(this->pToken.attribute.keyword)
-					{
-						case Scanner::KeywordType::Byte:   { this->pCurrVariableType = Parser::VarType::Byte;   break; }
-						case Scanner::KeywordType::Int:    { this->pCurrVariableType = Parser::VarType::Int;    break; }
-						case Scanner::KeywordType::Float:  { this->pCurrVariableType = Parser::VarType::Float;  break; }
-						default: { break; }
-					}
+		if(target != (u64)-1)
+		{
+			//unwind the stack, scopes entered or exited by discarded actions must stay balanced,
+			//branches and loops opened by discarded actions too (they are closed below)
+			while(this->pStack.size() > target + 1)
+			{
+				ParserSymbol symbol = this->pStack.back();
+				this->pStack.pop_back();
 
-					this->pToken = this->pScanner.getToken();
-					//after package item TYPE must be package item ID
-					if(this->pToken.type == Scanner::TokenType::Id)
+				switch(symbol & ~ParserSymbolKind)
+				{
+					case (ParserSymbol)ParserAction::ScopeEnter: case (ParserSymbol)ParserAction::ScopeExit:
+					case (ParserSymbol)ParserAction::IfHead:     case (ParserSymbol)ParserAction::ElseIfHead:
+					case (ParserSymbol)ParserAction::ElseBegin:  case (ParserSymbol)ParserAction::WhileBegin:
+					case (ParserSymbol)ParserAction::WhileHead:  case (ParserSymbol)ParserAction::ForInit:
+					case (ParserSymbol)ParserAction::ForCond:    case (ParserSymbol)ParserAction::ForHead:
 					{
-						//check if there are unique names for each package item
-						auto it = this->pPackages[this->pCurrPackageName].items.find(this->pToken.attribute.litString);
-						if(it == this->pPackages[this->pCurrPackageName].items.end())
+						if((symbol & ParserSymbolKind) == ParserSymbolAction)
 						{
-							std::printf("Add item into package \"%s\" <- \"%s\"\n", this->pCurrPackageName.c_str(), this->pToken.attribute.litString.c_str());
-
-							//add item into the package
-							this->pPackages[this->pCurrPackageName].items.insert({this->pToken.attribute.litString, this->pCurrVariableType});
-
-							//scan for other items
-							ParserProcessState(this->packItemList());
+							this->action((ParserAction)(symbol & ~ParserSymbolKind));
 						}
-						else
+						break;
+					}
+					//variable with invalid initializer is declared without it, so its uses report no more errors
+					case (ParserSymbol)ParserAction::VarDeclInit:
+					{
+						if((symbol & ParserSymbolKind) == ParserSymbolAction && 
+							this->findVariable(this->pCurrVariableName) == nullptr && this->findFunction(this->pCurrVariableName) == nullptr)
 						{
-							return Error(Error::Type::Syntax, "Cannot have same identificator for two package items [%s]", this->pToken.attribute.litString.c_str());
+							this->actVarDecl();
 						}
+						break;
 					}
-					else
+					default:
 					{
-						return Error(Error::Type::Syntax, "Expected identificator after package item type [%s]", this->pCurrPackageName.c_str());
+						break;
 					}
 				}
+			}
+
+			//branches and loops enclosing the synchronizing rule stay open, each of them has one
+			//symbol below the rule which closes it, the others lost their ends and are closed now
+			//from the innermost one
+			u64 depth = 0;
+			for(u64 i = 0; i < target; i++)
+			{
+				ParserSymbol s = this->pStack[i];
+				depth += s == ifTail || s == elseTail ||
+				         s == (ParserSymbolAction | (ParserSymbol)ParserAction::IfEnd) ||
+				         s == (ParserSymbolAction | (ParserSymbol)ParserAction::ElseEnd) ||
+				         s == (ParserSymbolAction | (ParserSymbol)ParserAction::WhileEnd) ||
+				         s == (ParserSymbolAction | (ParserSymbol)ParserAction::ForEnd) ? 1 : 0;
+			}
+			while(this->pBranches.size() > depth)
+			{
+				this->closeBranch();
+			}
+
+			//package whose item list was discarded continues with the next item after ";",
+			//otherwise it is completed with the items defined so far
+			if(this->pPackOpen && this->pStack[target] == prog)
+			{
+				if(ParserTerminalOf(this->pToken) == ParserTerminal::SemiColon)
+				{
+					this->pStack.push_back(packItemTail);
+				}
 				else
 				{
-					return Error(Error::Type::Syntax, "Expected item type when defining package item [%s]", this->pCurrPackageName.c_str());
+					this->actPackEnd();
 				}
 			}
-			else
+
+			//all synchronizing rules are outside of function calls and expressions
+			this->pCalls.clear();
+			this->pExprPack.clear();
+
+			if(eat)
 			{
-				return Error(Error::Type::Syntax, "Expected item type when defining package item [%s]", this->pCurrPackageName.c_str());
+				this->pPrevToken = std::move(this->pToken);
+				this->pToken     = this->nextToken();
 			}
+
+			return true;
 		}
+
+		//skip the token
+		this->pPrevToken = std::move(this->pToken);
+		this->pToken     = this->nextToken();
+	}
+}
+
+/**
+ * \brief close the innermost branch or loop (after an error discarded its end)
+ * \note plain else has no next condition, loop has its header, for loop with step its latch
+ */
+void Parser::closeBranch()
+{
+	const BranchItem& branch = this->pBranches.back();
+	if(branch.head == IrNone)
+	{
+		branch.next == IrNone ? this->actElseEnd() : this->actIfEnd();
 	}
 	else
 	{
-		return Error(Error::Type::Syntax, "Expected \";\" after package item identificator [%s]", this->pCurrPackageName.c_str());
+		branch.latch == IrNone ? this->actWhileEnd() : this->actForEnd();
+	}
+}
+
+/**
+ * \brief execute semantic action
+ */
+Error Parser::action(ParserAction a)
+{
+	switch(a)
+	{
+		#define PARSER_ACTION_CASE(n) case ParserAction::n: { return this->act##n(); }
+		PARSER_ACTIONS(PARSER_ACTION_CASE)
+		#undef PARSER_ACTION_CASE
 	}
 
 	return Error(Error::Type::Ok);
 }
+
 /**
- * \brief implementation of <args> rule
- * \note see ll.grammar
+ * \brief <expr>
  */
-Error Parser::args()
+Error Parser::actExpr()
 {
-	this->pToken = this->pScanner.getToken();
+	//target type is inherited only by the expression following its declaration
+	Parser::ValueType target = this->pExprTarget;
+	std::string       pack   = std::move(this->pExprPack);
+	this->pExprTarget = Parser::ValueType::None;
+	this->pExprPack.clear();
+
+	ParserTerminal t = ParserTerminalOf(this->pToken);
+	if(t != ParserTerminal::Id && t != ParserTerminal::Number && t != ParserTerminal::String && t != ParserTerminal::LeftBracket)
+	{
+		return Error(Error::Code::UnexpectedAfter, this->pToken.offset, 
+			ParserTokenName(this->pToken).c_str(), ParserTokenName(this->pPrevToken).c_str(), ParserRuleExpected[(u32)ParserRule::Expr]);
+	}
+
+	//package value is assigned to package variable or returned
+	if(!pack.empty())
+	{
+		return this->packValue(pack, this->pExprPackSink, this->pCurrVariableName);
+	}
+
+	this->pExprResult   = IrNone;
+	this->pExprConstant = false;
 
-	if(this->pToken.type != Scanner::TokenType::RightBracket)
+	//global initializer is evaluated into data section, only dynamic one generates startup code
+	if(this->pScope == 0)
 	{
-		ParserProcessState(this->expr(true));
-		ParserProcessState(this->argsList());
+		this->pCode = &this->pInit;
+		Error e = this->expr(false, target);
+		this->pCode = &this->pBody;
+		return e;
 	}
 
-	return Error::Type::Ok;
+	return this->expr(false, target);
 }
+
 /**
- * \brief implementation of <args-list> rule
- * \note see ll.grammar
+ * \brief <arg>
  */
-Error Parser::argsList()
+Error Parser::actArg()
 {
-	if(this->pToken.type == Scanner::TokenType::Comma)
+	//argument is converted to type of the parameter
+	Parser::ValueType target = Parser::ValueType::None;
+	std::string       pack;
+	if(this->pCalls.size() != 0)
 	{
-		this->pToken = this->pScanner.getToken();
+		CallItem& call = this->pCalls.back();
+		if(call.function != nullptr && call.args < call.function->args.size())
+		{
+			target = Parser::valueType(call.function->args[call.args].type);
+			pack   = call.function->args[call.args].pack;
+		}
+		call.args++;
+	}
 
-		ParserProcessState(this->expr(true));
-		ParserProcessState(this->argsList());
+	ParserTerminal t = ParserTerminalOf(this->pToken);
+	if(t != ParserTerminal::Id && t != ParserTerminal::Number && t != ParserTerminal::String && t != ParserTerminal::LeftBracket)
+	{
+		return Error(Error::Code::UnexpectedAfter, this->pToken.offset, 
+			ParserTokenName(this->pToken).c_str(), ParserTokenName(this->pPrevToken).c_str(), ParserRuleExpected[(u32)ParserRule::Arg]);
 	}
-	else if(this->pToken.type == Scanner::TokenType::RightBracket)
+
+	if(!pack.empty())
 	{
-		return Error(Error::Type::Ok);
+		return this->packValue(pack, PackSink::Arg, std::string());
 	}
-	else
+
+	return this->expr(true, target);
+}
+
+/**
+ * \brief <func-body>
+ */
+Error Parser::actFuncBody()
+{
+	//record the body for worker thread and continue after its matching "}"
+	if(this->pSkipBodies)
 	{
-		return Error(Error::Type::Syntax, "Expected \",\" after function argument");
+		return this->skipBody();
 	}
 
+	//the body is parsed by the current derivation
+	this->pStack.push_back(ParserSymbolRule | (ParserSymbol)ParserRule::Body);
+	this->bodyBegin();
+
 	return Error(Error::Type::Ok);
 }
+
 /**
- * \brief implementation of <func-type> rule
- * \note see ll.grammar
+ * \brief FUNC ID @funcName
  */
-Error Parser::funcType()
+Error Parser::actFuncName()
 {
-	this->pToken = this->pScanner.getToken();
+	//save function id
+	this->pCurrFunctionName        = this->pPrevToken.attribute.litString;
+	this->pCurrFunctionArgumentNum = 0;
 
-	if(this->pToken.type == Scanner::TokenType::Keyword)
+	//check if function name isn't in variable table
+	if(this->findVariable(this->pCurrFunctionName) != nullptr)
 	{
-		if(this->pToken.attribute.keyword == Scanner::KeywordType::Byte)
-		{
-			this->pCurrFunctionReturnType = Parser::ReturnType::Byte;
-		}
-		else if(this->pToken.attribute.keyword == Scanner::KeywordType::Int)
-		{
-			this->pCurrFunctionReturnType = Parser::ReturnType::Int;
-		}
-		else if(this->pToken.attribute.keyword == Scanner::KeywordType::Float)
-		{
-			this->pCurrFunctionReturnType = Parser::ReturnType::Float;
-		}
-		else if(this->pToken.attribute.keyword == Scanner::KeywordType::Void)
-		{
-			this->pCurrFunctionReturnType = Parser::ReturnType::Void;
-		}
-		else 
-		{
-			return Error(Error::Type::Syntax, "Unexpected function return type");
-		}
+		return Error(Error::Code::FunctionVariableName, this->pPrevToken.offset, this->pCurrFunctionName.c_str());
 	}
-	/*else if(this->pToken.type == Scanner::TokenType::Id)
-	{
-		this->pCurrFunctionReturnType = Parser::ReturnType::Pack;
-	}*/
-	else
+	//check if function isn't already defined
+	if(this->findFunction(this->pCurrFunctionName) != nullptr)
 	{
-		return Error(Error::Type::Syntax, "Unexpected function return type");
+		return Error(Error::Code::FunctionRedefinition, this->pPrevToken.offset, this->pCurrFunctionName.c_str());
 	}
 
-	//modify the return value of the function
-	this->pFunctions[this->pCurrFunctionName].retType = this->pCurrFunctionReturnType;
+	//create new function in symbol table
+	//its' attributes will be set later
+	this->pFunctions[this->pCurrFunctionName] = FunctionItem();
+	this->pFunctions[this->pCurrFunctionName].offset = this->pPrevToken.offset;
 
 	return Error(Error::Type::Ok);
 }
-/**
- * \brief implementation of <body> rule
- * \note see ll.grammar
- */
-Error Parser::body()
-{
-	this->pToken = this->pScanner.getToken();
-
-	/* <body> -> BYTE   ID ; <body> */
-	/* <body> -> BYTE   ID = <expr> ; <body> */
-	/* <body> -> INT    ID ; <body> */
-	/* <body> -> INT    ID = <expr> ; <body> */
-	/* <body> -> FLOAT  ID ; <body> */
-	/* <body> -> FLOAT  ID = <expr> ; <body> */
-	/* <body> -> RETURN <expr> ; <body> */
-	/* <body> -> IF    ( <expr> ) { <body> */
-	/* <body> -> WHILE ( <expr> ) { <body> */
-	/* <body> -> FOR   ( <expr> ; <expr> ; <expr> ) : { <body */
-	if(this->pToken.type == Scanner::TokenType::Keyword)
-	{
-		/* <body> -> BYTE   ID ; <body> */
-		/* <body> -> BYTE   ID = <expr> ; <body> */
-		/* <body> -> INT    ID ; <body> */
-		/* <body> -> INT    ID = <expr> ; <body> */
-		/* <body> -> FLOAT  ID ; <body> */
-		/* <body> -> FLOAT  ID = <expr> ; <body> */
-		if(this->pToken.attribute.keyword == Scanner::KeywordType::Byte  ||
-		   this->pToken.attribute.keyword == Scanner::KeywordType::Int   ||
-		   this->pToken.attribute.keyword == Scanner::KeywordType::Float)
-		{
-			switch(this->pToken.attribute.keyword)
-			{
-				case Scanner::KeywordType::Byte:   { pCurrVariableType = Parser::VarType::Byte;   break; }
-				case Scanner::KeywordType::Int:    { pCurrVariableType = Parser::VarType::Int;    break; }
-				case Scanner::KeywordType::Float:  { pCurrVariableType = Parser::VarType::Float;  break; }
-				default: { break; }
-			}
 
-			this->pToken = this->pScanner.getToken();
-			//after TYPE must be ID
-			if(this->pToken.type == Scanner::TokenType::Id)
-			{
-				//save variable name
-				this->pCurrVariableName = this->pToken.attribute.litString;
 
-				this->pToken = this->pScanner.getToken();
-				/* <body> -> BYTE/INT/FLOAT/STRING ID ; <body> */
-				if(this->pToken.type == Scanner::TokenType::SemiColon)
-				{
-					//add variable into variable pool
-					this->createVar(this->pCurrVariableName, this->pCurrVariableType, this->pScope);
+/**
+ * \brief @funcEnd
+ */
+Error Parser::actFuncEnd()
+{
+	if(!this->pSkipBodies)
+	{
+		this->bodyEnd();
+	}
+	if(this->pStream)
+	{
+		this->flushStream();
+	}
 
-					switch(this->pCurrVariableType)
-					{
-						case Parser::VarType::Byte:   { std::printf("Define new variable \"%s\" of type \"byte\" in scope %llu\n",   this->pCurrVariableName.c_str(), this->pScope); break; }
-						case Parser::VarType::Int:    { std::printf("Define new variable \"%s\" of type \"int\" in scope %llu\n",    this->pCurrVariableName.c_str(), this->pScope); break; }
-						case Parser::VarType::Float:  { std::printf("Define new variable \"%s\" of type \"float\" in scope %llu\n",  this->pCurrVariableName.c_str(), this->pScope); break; }
-						default: { break; }
-					}
+	return Error(Error::Type::Ok);
+}
 
-					ParserProcessState(this->body());
-				}
-				/* <body> -> BYTE/INT/FLOAT/STRING ID = <expr> ; <body> */
-				else if(this->pToken.type == Scanner::TokenType::Assign)
-				{
-					this->pToken = this->pScanner.getToken();
-					ParserProcessState(this->expr());
+/**
+ * \brief @scopeEnter
+ */
+Error Parser::actScopeEnter()
+{
+	this->pScope++;
 
-					if(this->pToken.type == Scanner::TokenType::SemiColon)
-					{
-						//add variable into variable pool
-						this->createVar(this->pCurrVariableName, this->pCurrVariableType, this->pScope);
+	return Error(Error::Type::Ok);
+}
 
-						switch(this->pCurrVariableType)
-						{
-							case Parser::VarType::Byte:   { std::printf("Define new variable \"%s\" of type \"byte\" and initialize with r0 in scope %llu\n",   this->pCurrVariableName.c_str(), this->pScope); break; }
-							case Parser::VarType::Int:    { std::printf("Define new variable \"%s\" of type \"int\" and initialize with r0 in scope %llu\n",    this->pCurrVariableName.c_str(), this->pScope); break; }
-							case Parser::VarType::Float:  { std::printf("Define new variable \"%s\" of type \"float\" and initialize with r0 in scope %llu\n",  this->pCurrVariableName.c_str(), this->pScope); break; }
-							default: { break; }
-						}
+/**
+ * \brief @scopeExit
+ */
+Error Parser::actScopeExit()
+{
+	this->exitScope();
+	this->pScope--;
 
-						ParserProcessState(this->body());
-					}
-					else
-					{
-						return Error(Error::Type::Syntax, "Expected \";\" after expression");
-					}
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expected \";\" or assignment after variable declaration");
-				}
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected identificator after type");
-			}
-		}
-		/* <body> -> RETURN <expr> ; <body> */
-		else if(this->pToken.attribute.keyword == Scanner::KeywordType::Return)
-		{
-			this->pToken = this->pScanner.getToken();
+	return Error(Error::Type::Ok);
+}
 
-			if(this->pToken.type == Scanner::TokenType::SemiColon)
-			{
-				std::printf("Return from function \"%s\"\n", this->pCurrFunctionName.c_str());
+/**
+ * \brief <var-type> ID @varName
+ */
+Error Parser::actVarName()
+{
+	this->pCurrVariableName = this->pPrevToken.attribute.litString;
+	this->pExprTarget       = Parser::valueType(this->pCurrVariableType);
 
-				ParserProcessState(this->body());
-			}
-			else
-			{
-				ParserProcessState(this->expr());
+	return Error(Error::Type::Ok);
+}
 
-				if(this->pToken.type == Scanner::TokenType::SemiColon)
-				{
-					std::printf("Return from function \"%s\" with r0\n", this->pCurrFunctionName.c_str());
+/**
+ * \brief ID @packType ID
+ */
+Error Parser::actPackType()
+{
+	this->pCurrVariablePack = this->pPrevToken.attribute.litString;
 
-					ParserProcessState(this->body());
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expected \";\" after return");
-				}
-			}
-		}
-		/* <body> -> IF ( <expr> ) : { <body>  */
-		else if(this->pToken.attribute.keyword == Scanner::KeywordType::If)
-		{
-			this->pToken = this->pScanner.getToken();
-			//after IF must be LEFT BRACKET
-			if(this->pToken.type == Scanner::TokenType::LeftBracket)
-			{
-				this->pToken = this->pScanner.getToken();
-				ParserProcessState(this->expr());
+	if(this->findPackage(this->pCurrVariablePack) == nullptr)
+	{
+		this->pCurrVariablePack.clear();
+		return Error(Error::Code::UndefinedPackage, this->pPrevToken.offset);
+	}
 
-				if(this->pToken.type == Scanner::TokenType::RightBracket)
-				{
-					this->pToken = this->pScanner.getToken();
-					//after RIGHT BRACKET must be LEFT CURLY BRACKET
-					if(this->pToken.type == Scanner::TokenType::LeftCurlyBracket)
-					{
-						std::printf("Generate if head\n");
-
-						pScope++;
-						std::printf("Change scope to %llu\n", pScope);
-						ParserProcessState(this->body());
-						this->exitScope();
-						pScope--;
-						std::printf("Change scope to %llu\n", pScope);
-						ParserProcessState(this->body());
-					}
-					else
-					{
-						return Error(Error::Type::Syntax, "Expected \"{\" after \")\"");
-					}
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expected \")\" after expression");
-				}
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected \"(\" after if");
-			}
-		}
-		/* <body> -> ELSE IF ( <expr> ) { <body> <body> */
-		/* <body> -> ELSE { <body> <body> */
-		else if(this->pToken.attribute.keyword == Scanner::KeywordType::Else)
-		{
-			this->pToken = this->pScanner.getToken();
+	return Error(Error::Type::Ok);
+}
 
-			/* <body> -> ELSE IF ( <expr> ) { <body> <body> */
-			if(this->pToken.type == Scanner::TokenType::Keyword)
-			{
-				if(this->pToken.attribute.keyword == Scanner::KeywordType::If)
-				{
-					this->pToken = this->pScanner.getToken();
-					//after IF must be LEFT BRACKET
-					if(this->pToken.type == Scanner::TokenType::LeftBracket)
-					{
-						this->pToken = this->pScanner.getToken();
-						ParserProcessState(this->expr());
+/**
+ * \brief ID ID @globalPackVar ;
+ */
+Error Parser::actGlobalPackVar()
+{
+	std::string& name = this->pPrevToken.attribute.litString;
 
-						if(this->pToken.type == Scanner::TokenType::RightBracket)
-						{
-							this->pToken = this->pScanner.getToken();
-							//after RIGHT BRACKET must be LEFT CURLY BRACKET
-							if(this->pToken.type == Scanner::TokenType::LeftCurlyBracket)
-							{
-								std::printf("Generate else if head\n");
-
-								pScope++;
-								std::printf("Change scope to %llu\n", pScope);
-								ParserProcessState(this->body());
-								this->exitScope();
-								pScope--;
-								std::printf("Change scope to %llu\n", pScope);
-								ParserProcessState(this->body());
-							}
-							else
-							{
-								return Error(Error::Type::Syntax, "Expected \"{\" after \")\"");
-							}
-						}
-						else
-						{
-							return Error(Error::Type::Syntax, "Expected \")\" after expression");
-						}
-					}
-					else
-					{
-						return Error(Error::Type::Syntax, "Expected \"(\" after if");
-					}
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Unexpected symbol after else");
-				}
-			}
-			else if(this->pToken.type == Scanner::TokenType::LeftCurlyBracket)
-			{
-				std::printf("Generate else head\n");
-
-				pScope++;
-				std::printf("Change scope to %llu\n", pScope);
-				ParserProcessState(this->body());
-				this->exitScope();
-				pScope--;
-				std::printf("Change scope to %llu\n", pScope);
-				ParserProcessState(this->body());
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Unexpected symbol after else");
-			}
-		}
-		/* <body> -> WHILE ( <expr> ) : { <body> */
-		else if(this->pToken.attribute.keyword == Scanner::KeywordType::While)
-		{
-			this->pToken = this->pScanner.getToken();
-			//after WHILE must be LEFT BRACKET
-			if(this->pToken.type == Scanner::TokenType::LeftBracket)
-			{
-				this->pToken = this->pScanner.getToken();
-				ParserProcessState(this->expr());
+	//undefined package was already reported
+	const PackItem* pack = this->findPackage(this->pCurrVariablePack);
+	if(pack == nullptr)
+	{
+		return Error(Error::Type::Ok);
+	}
 
-				if(this->pToken.type == Scanner::TokenType::RightBracket)
-				{
-					this->pToken = this->pScanner.getToken();
-					//after RIGHT BRACKET must be LEFT CURLY BRACKET
-					if(this->pToken.type == Scanner::TokenType::LeftCurlyBracket)
-					{
-						std::printf("Generate while\n");
-						
-						pScope++;
-						std::printf("Change scope to %llu\n", pScope);
-						ParserProcessState(this->body());
-						this->exitScope();
-						pScope--;
-						std::printf("Change scope to %llu\n", pScope);
-						ParserProcessState(this->body());
-					}
-					else
-					{
-						return Error(Error::Type::Syntax, "Expected \"{\" after \")\"");
-					}
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expected \")\" after expression");
-				}
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected \"(\" after while");
-			}
-		}
-		/* <body> -> FOR ( <expr> ; <expr> ; <expr> ) : { <body */
-		else if(this->pToken.attribute.keyword == Scanner::KeywordType::For)
-		{
-			this->pToken = this->pScanner.getToken();
-			//after FOR must be LEFT BRACKET
-			if(this->pToken.type == Scanner::TokenType::LeftBracket)
-			{
-				this->pToken = this->pScanner.getToken();
-				ParserProcessState(this->expr());
+	//global variables always live in memory
+	ParserProcessState(this->createVar(name, Parser::VarType::Pack, this->pScope));
+	this->pVariables[name].pack = this->pCurrVariablePack;
+	this->pEmitter->global(name, pack->layout.size, pack->layout.align, nullptr);
 
-				//after first expression must be SEMICOLON
-				if(this->pToken.type == Scanner::TokenType::SemiColon)
-				{
-					this->pToken = this->pScanner.getToken();
-					ParserProcessState(this->expr());
+	this->emit("Define new global variable \"%s\" of package \"%s\" in memory (%llu bytes)\n", 
+		name.c_str(), this->pCurrVariablePack.c_str(), pack->layout.size);
 
-					//after second expression must be SEMICOLON
-					if(this->pToken.type == Scanner::TokenType::SemiColon)
-					{
-						this->pToken = this->pScanner.getToken();
-						ParserProcessState(this->expr());
+	return Error(Error::Type::Ok);
+}
 
-						//after third expression must be RIGHT BRACET
-						if(this->pToken.type == Scanner::TokenType::RightBracket)
-						{
-							this->pToken = this->pScanner.getToken();
-							//after RIGHT BRACKET must be LEFT CURLY BRACKET
-							if(this->pToken.type == Scanner::TokenType::LeftCurlyBracket)
-							{
-								std::printf("Generate for\n");
-
-								pScope++;
-								std::printf("Change scope to %llu\n", pScope);
-								ParserProcessState(this->body());
-								this->exitScope();
-								pScope--;
-								std::printf("Change scope to %llu\n", pScope);
-								ParserProcessState(this->body());
-							}
-							else
-							{
-								return Error(Error::Type::Syntax, "Expected \"{\" after \")\"");
-							}
-						}
-						else
-						{
-							return Error(Error::Type::Syntax, "Expected \")\" after third expression");
-						}
-					}
-					else
-					{
-						return Error(Error::Type::Syntax, "Expected \";\" after second expression");
-					}
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expected \";\" after first expression");
-				}
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected \"(\" after for");
-			}
-		}
-		else 
+/**
+ * \brief EOF @end
+ */
+Error Parser::actEnd()
+{
+	//values of constant globals are part of the output, startup does no work for them
+	if(this->pData.size() != 0)
+	{
+		this->emit("Data section\n");
+		for(DataItem& item : this->pData)
 		{
-			return Error(Error::Type::Syntax, "Unexpected keyword in function body");
+			this->emit("\t%s: %s = ", item.name.c_str(), ParserVarTypeString[(u32)item.type]);
+			this->exprTokenPrint(item.value);
+			this->emit("\n");
 		}
 	}
-	/* <body> -> } */
-	else if(this->pToken.type == Scanner::TokenType::RightCurlyBracket)
+	if(this->pInitUsed)
 	{
-		return Error(Error::Type::Ok);
+		this->pInit.ret(nullptr, 0);
+		this->pInit.finish();
+		this->pSccp.run(this->pInit);
+		this->pGvn.run(this->pInit);
+		this->pLicm.run(this->pInit, *this->pTarget);
+		if(this->pUnroll.run(this->pInit, this->pUnrollFactor))
+		{
+			this->pSccp.run(this->pInit);
+			this->pInit.resimplify();
+			this->pGvn.run(this->pInit);
+		}
+		this->pRegalloc.run(this->pInit, *this->pTarget);
+
+		this->emit("Startup function \"__init\" is called before \"main\"\n");
+		this->pEmitter->function(this->pInit);
 	}
-	/* <body> -> ID ID ; <body> */
-	/* <body> -> ID = <expr> ; <body> */
-	else if(this->pToken.type == Scanner::TokenType::Id)
-	{
-		//save the first identificator
-		this->pCurrVariableName = this->pToken.attribute.litString;
 
-		this->pToken = this->pScanner.getToken();
+	return Error(Error::Type::Ok);
+}
 
-		/* <body> -> ID = <expr> ; <body> */
-		if(this->pToken.type == Scanner::TokenType::Assign)
-		{
-			//check if the ID exists
-			if(this->pVariables.find(this->pCurrVariableName) == this->pVariables.end())
-			{
-				return Error(Error::Type::Syntax, "Cannot assign expression to a undefined variable");
-			}
+/**
+ * \brief PACK ID @packName
+ */
+Error Parser::actPackName()
+{
+	//save package item
+	this->pCurrPackageName = this->pPrevToken.attribute.litString;
+	this->emit("Create new package %s\n", this->pCurrPackageName.c_str());
 
-			//evaluate expression
-			this->pToken = this->pScanner.getToken();
-			ParserProcessState(this->expr());
+	//check if we haven't already defined package with the same name
+	if(this->findPackage(this->pCurrPackageName) != nullptr)
+	{
+		return Error(Error::Code::PackageRedefinition, this->pPrevToken.offset, this->pCurrPackageName.c_str());
+	}
 
-			//after expression must be SEMICOLON
-			if(this->pToken.type == Scanner::TokenType::SemiColon)
-			{
-				std::printf("Assign variable \"%s\" a new value r0\n", pCurrVariableName.c_str());
-				ParserProcessState(this->body());
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected \";\" after expression");
-			}
-		}
-		/* <body> -> ID ( <args> ; <body> */
-		else if(this->pToken.type == Scanner::TokenType::LeftBracket)
-		{
-			ParserProcessState(this->args());
+	//insert package into package table
+	this->pPackages.insert({this->pCurrPackageName, PackItem()});
+	this->pPackages[this->pCurrPackageName].offset = this->pPrevToken.offset;
+	this->pPackOpen = true;
 
-			this->pToken = this->pScanner.getToken();
-			//after args must be SEMICOLON
-			if(this->pToken.type == Scanner::TokenType::SemiColon)
-			{
+	return Error(Error::Type::Ok);
+}
 
-				std::printf("Call function \"%s\"\n", pCurrVariableName.c_str());
-				ParserProcessState(this->body());
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expected \";\" after arguments");
-			}
-		}
-		/* <body> -> ID ID ; <body> */
-		else if(this->pToken.type == Scanner::TokenType::Id)
-		{
-			if(this->pPackages.find(this->pCurrVariableName) != this->pPackages.end())
-			{
-				//add variable into variable pool
-				this->createVar(this->pCurrVariableName, Parser::VarType::Pack, this->pScope);
+/**
+ * \brief <var-type> ID @packItem
+ */
+Error Parser::actPackItem()
+{
+	const std::string& name = this->pPrevToken.attribute.litString;
+	PackItem&          pack = this->pPackages[this->pCurrPackageName];
 
-				std::printf("Declare variable \"%s\" of type \"%s\"\n", this->pToken.attribute.litString.c_str(), this->pCurrVariableName.c_str());
+	//check if there are unique names for each package item
+	if(pack.index.find(name) != pack.index.end())
+	{
+		return Error(Error::Code::PackageItemRedefinition, this->pPrevToken.offset, name.c_str());
+	}
 
-				this->pToken = this->pScanner.getToken();
-				//after ID must be SEMICOLON
-				if(this->pToken.type == Scanner::TokenType::SemiColon)
-				{
-					ParserProcessState(this->body());
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expected \";\" after identificator");
-				}
-			}
-			else
+	this->emit("Add item into package \"%s\" <- \"%s\"\n", this->pCurrPackageName.c_str(), name.c_str());
+
+	//add item into the package
+	pack.index.insert({name, pack.items.size()});
+	pack.items.emplace_back(name, this->pCurrVariableType);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief size and alignment of variable types in memory
+ */
+static const u64 ParserVarTypeSize[] =
+{
+	[(u32)Parser::VarType::Byte]  = 1,
+	[(u32)Parser::VarType::Int]   = 8,
+	[(u32)Parser::VarType::Float] = 8,
+};
+
+/**
+ * \brief } @packEnd
+ */
+Error Parser::actPackEnd()
+{
+	PackItem& pack  = this->pPackages[this->pCurrPackageName];
+	this->pPackOpen = false;
+
+	//layout is computed once, accesses use only the offsets
+	pack.layout.fields.clear();
+	for(const PackItem::Item& item : pack.items)
+	{
+		Layout::Field f;
+		f.size  = ParserVarTypeSize[(u32)item.type];
+		f.align = ParserVarTypeSize[(u32)item.type];
+		pack.layout.fields.push_back(f);
+	}
+	pack.layout.compute(this->pPackReorder);
+	pack.registers = pack.items.size() <= ParserPackRegisters;
+
+	this->emit("Package \"%s\" has size %llu, alignment %llu and padding %llu, passed in %s\n", this->pCurrPackageName.c_str(),
+		pack.layout.size, pack.layout.align, pack.layout.padding(), pack.registers ? "registers" : "memory");
+	for(u64 i = 0; i < pack.items.size(); i++)
+	{
+		this->emit("\t%s at offset %llu\n", pack.items[i].name.c_str(), pack.layout.fields[i].offset);
+	}
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief BYTE/INT/FLOAT @varType
+ */
+Error Parser::actVarType()
+{
+	switch(this->pPrevToken.attribute.keyword)
+	{
+		case Scanner::KeywordType::Byte:   { this->pCurrVariableType = Parser::VarType::Byte;   break; }
+		case Scanner::KeywordType::Int:    { this->pCurrVariableType = Parser::VarType::Int;    break; }
+		case Scanner::KeywordType::Float:  { this->pCurrVariableType = Parser::VarType::Float;  break; }
+		default: { break; }
+	}
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief initial memory of global variable with constant value
+ */
+void Parser::globalData(const std::string& name, Parser::VarType type, const Scanner::Token& value)
+{
+	if(value.type == Scanner::TokenType::String)
+	{
+		this->pEmitter->global(name, value.attribute.litString);
+		return;
+	}
+
+	bool isFloat = value.type == Scanner::TokenType::Float;
+	switch(type)
+	{
+		case Parser::VarType::Byte:
+		{
+			u8 data = isFloat ? (u8)value.attribute.litFloat : (u8)value.attribute.litInt;
+			this->pEmitter->global(name, sizeof(data), sizeof(data), &data);
+			break;
+		}
+		case Parser::VarType::Int:
+		{
+			i64 data = isFloat ? (i64)value.attribute.litFloat : value.attribute.litInt;
+			this->pEmitter->global(name, sizeof(data), sizeof(data), &data);
+			break;
+		}
+		default:
+		{
+			f64 data = isFloat ? value.attribute.litFloat : (f64)value.attribute.litInt;
+			this->pEmitter->global(name, sizeof(data), sizeof(data), &data);
+			break;
+		}
+	}
+}
+
+/**
+ * \brief ; @varDecl
+ */
+Error Parser::actVarDecl()
+{
+	this->pExprTarget = Parser::ValueType::None;
+
+	//add variable into variable pool
+	ParserProcessState(this->createVar(this->pCurrVariableName, this->pCurrVariableType, this->pScope));
+
+	//local variable lives in SSA values
+	if(this->pScope != 0)
+	{
+		this->pVariables[this->pCurrVariableName].ir = this->pCode->variable((IrType)Parser::valueType(this->pCurrVariableType));
+		return Error(Error::Type::Ok);
+	}
+
+	u64 size = ParserVarTypeSize[(u32)this->pCurrVariableType];
+	this->pEmitter->global(this->pCurrVariableName, size, size, nullptr);
+
+	this->emit("Define new variable \"%s\" of type \"%s\" in scope %llu\n", 
+		this->pCurrVariableName.c_str(), ParserVarTypeString[(u32)this->pCurrVariableType], this->pScope);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief = <expr> ; @varDeclInit
+ */
+Error Parser::actVarDeclInit()
+{
+	//add variable into variable pool
+	ParserProcessState(this->createVar(this->pCurrVariableName, this->pCurrVariableType, this->pScope));
+
+	if(this->pScope == 0)
+	{
+		if(this->pExprConstant)
+		{
+			this->pData.push_back({ this->pCurrVariableName, this->pCurrVariableType, this->pExprValue });
+			this->globalData(this->pCurrVariableName, this->pCurrVariableType, this->pExprValue);
+
+			this->emit("Define new global variable \"%s\" of type \"%s\" in data section\n", 
+				this->pCurrVariableName.c_str(), ParserVarTypeString[(u32)this->pCurrVariableType]);
+		}
+		else
+		{
+			if(this->pExprResult != IrNone)
 			{
-				return Error(Error::Type::Syntax, "Using undefined package");
+				this->pInit.store(this->pCurrVariableName, 0, (IrType)Parser::valueType(this->pCurrVariableType), this->pExprResult);
+				this->pInitUsed = true;
 			}
+			u64 size = ParserVarTypeSize[(u32)this->pCurrVariableType];
+			this->pEmitter->global(this->pCurrVariableName, size, size, nullptr);
+
+			this->emit("Define new global variable \"%s\" of type \"%s\" initialized by startup code\n", 
+				this->pCurrVariableName.c_str(), ParserVarTypeString[(u32)this->pCurrVariableType]);
 		}
-		else
+		return Error(Error::Type::Ok);
+	}
+
+	IrId var = this->pCode->variable((IrType)Parser::valueType(this->pCurrVariableType));
+	this->pVariables[this->pCurrVariableName].ir = var;
+	this->pCode->write(var, this->exprValue());
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief <var-type> ID @funcArg
+ */
+Error Parser::actFuncArg()
+{
+	std::string& name = this->pPrevToken.attribute.litString;
+
+	//add argument into symbol table function
+	this->pFunctions[this->pCurrFunctionName].args.emplace_back(this->pCurrVariableType, name);
+	//add argument into local variable pool
+	ParserProcessState(this->createVar(name, this->pCurrVariableType, this->pScope + 1));
+
+	this->pCurrFunctionArgumentNum++;
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief ID ID @funcPackArg
+ */
+Error Parser::actFuncPackArg()
+{
+	std::string& name = this->pPrevToken.attribute.litString;
+
+	//undefined package was already reported
+	const PackItem* pack = this->findPackage(this->pCurrVariablePack);
+	if(pack == nullptr)
+	{
+		return Error(Error::Type::Ok);
+	}
+
+	//add argument into symbol table function
+	this->pFunctions[this->pCurrFunctionName].args.emplace_back(Parser::VarType::Pack, name, this->pCurrVariablePack);
+	//items are used as scalars, small package arrives in registers, large one is loaded from a copy
+	//made by the caller
+	ParserProcessState(this->createVar(name, Parser::VarType::Pack, this->pScope + 1));
+	this->pVariables[name].pack   = this->pCurrVariablePack;
+	this->pVariables[name].scalar = true;
+
+	this->pCurrFunctionArgumentNum++;
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief BYTE/INT/FLOAT/ID/VOID @retType
+ */
+Error Parser::actRetType()
+{
+	if(this->pPrevToken.type == Scanner::TokenType::Id)
+	{
+		const std::string& name = this->pPrevToken.attribute.litString;
+		if(this->findPackage(name) == nullptr)
 		{
-			return Error(Error::Type::Syntax, "Unexpected symbol after identificator");
+			return Error(Error::Code::UndefinedPackage, this->pPrevToken.offset);
 		}
+
+		this->pCurrFunctionReturnType = Parser::ReturnType::Pack;
+		this->pFunctions[this->pCurrFunctionName].retType = this->pCurrFunctionReturnType;
+		this->pFunctions[this->pCurrFunctionName].retPack = name;
+
+		return Error(Error::Type::Ok);
+	}
+
+	switch(this->pPrevToken.attribute.keyword)
+	{
+		case Scanner::KeywordType::Byte:  { this->pCurrFunctionReturnType = Parser::ReturnType::Byte;  break; }
+		case Scanner::KeywordType::Int:   { this->pCurrFunctionReturnType = Parser::ReturnType::Int;   break; }
+		case Scanner::KeywordType::Float: { this->pCurrFunctionReturnType = Parser::ReturnType::Float; break; }
+		default:                          { this->pCurrFunctionReturnType = Parser::ReturnType::Void;  break; }
+	}
+
+	//modify the return value of the function
+	this->pFunctions[this->pCurrFunctionName].retType = this->pCurrFunctionReturnType;
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief ID @stmtId <id-stmt>
+ */
+Error Parser::actStmtId()
+{
+	//save the first identificator
+	this->pCurrVariableName = this->pPrevToken.attribute.litString;
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief = @assignCheck <expr> ;
+ */
+Error Parser::actAssignCheck()
+{
+	//check if the ID exists
+	const VariableItem* var = this->findVariable(this->pCurrVariableName);
+	if(var == nullptr)
+	{
+		return Error(Error::Code::AssignUndefined, this->pPrevToken.offset);
+	}
+
+	//assigned value is converted to type of the variable
+	this->pExprTarget = Parser::valueType(var->varType);
+	this->pExprPack     = var->pack;
+	this->pExprPackSink = Parser::PackSink::Var;
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief = <expr> ; @assign
+ */
+Error Parser::actAssign()
+{
+	//items of package were already copied
+	const VariableItem* var = this->findVariable(this->pCurrVariableName);
+	if(var == nullptr || var->varType == Parser::VarType::Pack)
+	{
+		return Error(Error::Type::Ok);
+	}
+
+	//local variable gets new SSA value, global one is stored into memory
+	if(var->ir != IrNone)
+	{
+		this->pCode->write(var->ir, this->exprValue());
 	}
 	else
 	{
-		return Error(Error::Type::Syntax, "Unexpected symbol while processing function body");
+		this->pCode->store(this->pCurrVariableName, 0, (IrType)Parser::valueType(var->varType), this->exprValue());
 	}
 
 	return Error(Error::Type::Ok);
 }
 
+/**
+ * \brief ( @callArgs <args>
+ */
+Error Parser::actCallArgs()
+{
+	return this->callBegin(this->pCurrVariableName, this->pPrevToken.offset);
+}
+
+/**
+ * \brief ( <args> ; @call
+ */
+Error Parser::actCall()
+{
+	if(this->pLazy)
+	{
+		this->pReferenced.push_back(this->pCurrVariableName);
+	}
+
+	//result of call statement is dropped
+	if(this->pCalls.size() != 0)
+	{
+		const CallItem& call = this->pCalls.back();
+		this->pCode->call(call.name, IrType::None, call.values.data(), (u16)call.values.size());
+	}
+
+	return this->callEnd();
+}
+
+/**
+ * \brief ID @packVar ;
+ */
+Error Parser::actPackVar()
+{
+	std::string& name = this->pPrevToken.attribute.litString;
+
+	const PackItem* pack = this->findPackage(this->pCurrVariableName);
+	if(pack == nullptr)
+	{
+		return Error(Error::Code::UndefinedPackage, this->pPrevToken.offset);
+	}
+
+	//add variable into variable pool
+	ParserProcessState(this->createVar(name, Parser::VarType::Pack, this->pScope));
+	VariableItem& var = this->pVariables[name];
+	var.pack   = this->pCurrVariableName;
+	var.scalar = true;
+
+	//address of variable is never taken (passed package is a copy), so every package is broken into scalars
+	for(const PackItem::Item& item : pack->items)
+	{
+		IrId ir = this->pCode->variable((IrType)Parser::valueType(item.type));
+		if(var.ir == IrNone)
+		{
+			var.ir = ir;
+		}
+	}
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief . ID @fieldName = <expr> ;
+ */
+Error Parser::actFieldName()
+{
+	ParserProcessState(this->findField(this->pCurrVariableName, this->pPrevToken.attribute.litString, this->pPrevToken.offset,
+		this->pCurrFieldType, this->pCurrFieldIndex));
+
+	//assigned value is converted to type of the item
+	this->pExprTarget = Parser::valueType(this->pCurrFieldType);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief . ID = <expr> ; @fieldAssign
+ */
+Error Parser::actFieldAssign()
+{
+	this->exprStore(this->pCurrVariableName, this->pCurrFieldIndex, this->exprValue());
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief RETURN @returnHead
+ */
+Error Parser::actReturnHead()
+{
+	//returned value is converted to return type of the function
+	this->pExprTarget = Parser::valueType(this->pCurrFunctionReturnType);
+	if(this->pCurrFunctionReturnType == Parser::ReturnType::Pack)
+	{
+		this->pExprPack     = this->findFunction(this->pCurrFunctionName)->retPack;
+		this->pExprPackSink = Parser::PackSink::Return;
+	}
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief RETURN ; @return
+ */
+Error Parser::actReturn()
+{
+	this->pExprTarget = Parser::ValueType::None;
+
+	this->pCode->ret(nullptr, 0);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief RETURN <expr> ; @returnValue
+ */
+Error Parser::actReturnValue()
+{
+	//package was returned by packValue
+	if(this->pCurrFunctionReturnType == Parser::ReturnType::Pack)
+	{
+		return Error(Error::Type::Ok);
+	}
+
+	IrId value = this->exprValue();
+	this->pCode->ret(&value, 1);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief IF ( <expr> ) { @ifHead
+ */
+Error Parser::actIfHead()
+{
+	IrId cond    = this->exprValue();
+	IrId ifTrue  = this->pCode->block();
+	IrId ifFalse = this->pCode->block();
+
+	this->pCode->branch(cond, ifTrue, ifFalse);
+	this->pCode->enter(ifTrue);
+	this->pCode->seal(ifTrue);
+
+	//false block continues the chain, join block is created by the first else
+	this->pBranches.push_back({ IrNone, ifFalse, IrNone, IrNone });
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief ELSE @elseBegin
+ */
+Error Parser::actElseBegin()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+	BranchItem& branch = this->pBranches.back();
+
+	if(branch.exit == IrNone)
+	{
+		branch.exit = this->pCode->block();
+	}
+	this->pCode->jump(branch.exit);
+
+	this->pCode->enter(branch.next);
+	this->pCode->seal(branch.next);
+	//else if creates its next condition, plain else has none
+	branch.next = IrNone;
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief ELSE IF ( <expr> ) { @elseIfHead
+ */
+Error Parser::actElseIfHead()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+
+	IrId cond    = this->exprValue();
+	IrId ifTrue  = this->pCode->block();
+	IrId ifFalse = this->pCode->block();
+
+	this->pCode->branch(cond, ifTrue, ifFalse);
+	this->pCode->enter(ifTrue);
+	this->pCode->seal(ifTrue);
+
+	this->pBranches.back().next = ifFalse;
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief @ifEnd (if without final else)
+ */
+Error Parser::actIfEnd()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+	BranchItem branch = this->pBranches.back();
+	this->pBranches.pop_back();
+
+	//false block of the last condition is the join block of if without else
+	if(branch.exit == IrNone)
+	{
+		this->pCode->jump(branch.next);
+		this->pCode->enter(branch.next);
+		this->pCode->seal(branch.next);
+	}
+	else
+	{
+		this->pCode->jump(branch.exit);
+		this->pCode->enter(branch.next);
+		this->pCode->seal(branch.next);
+		this->pCode->jump(branch.exit);
+		this->pCode->enter(branch.exit);
+		this->pCode->seal(branch.exit);
+	}
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief ELSE { <body> @elseEnd
+ */
+Error Parser::actElseEnd()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+	BranchItem branch = this->pBranches.back();
+	this->pBranches.pop_back();
+
+	this->pCode->jump(branch.exit);
+	this->pCode->enter(branch.exit);
+	this->pCode->seal(branch.exit);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief WHILE @whileBegin
+ */
+Error Parser::actWhileBegin()
+{
+	//header is sealed after the back edge is added
+	IrId head = this->pCode->block();
+	this->pCode->jump(head);
+	this->pCode->enter(head);
+
+	this->pBranches.push_back({ head, IrNone, IrNone, IrNone });
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief WHILE ( <expr> ) { @whileHead
+ */
+Error Parser::actWhileHead()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+	BranchItem& branch = this->pBranches.back();
+
+	IrId cond = this->exprValue();
+	IrId body = this->pCode->block();
+	branch.exit = this->pCode->block();
+
+	this->pCode->branch(cond, body, branch.exit);
+	this->pCode->enter(body);
+	this->pCode->seal(body);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief WHILE ( <expr> ) { <body> @whileEnd
+ */
+Error Parser::actWhileEnd()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+	BranchItem branch = this->pBranches.back();
+	this->pBranches.pop_back();
+
+	this->pCode->jump(branch.head);
+	this->pCode->seal(branch.head);
+
+	//condition may fail before the loop head was generated
+	if(branch.exit == IrNone)
+	{
+		branch.exit = this->pCode->block();
+	}
+	this->pCode->enter(branch.exit);
+	this->pCode->seal(branch.exit);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief FOR ( <expr> ; @forInit
+ */
+Error Parser::actForInit()
+{
+	IrId head = this->pCode->block();
+	this->pCode->jump(head);
+	this->pCode->enter(head);
+
+	this->pBranches.push_back({ head, IrNone, IrNone, IrNone });
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief FOR ( <expr> ; <expr> ; @forCond
+ */
+Error Parser::actForCond()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+	BranchItem& branch = this->pBranches.back();
+
+	//body is entered by forHead, step expression is generated into latch block
+	IrId cond = this->exprValue();
+	branch.next  = this->pCode->block();
+	branch.exit  = this->pCode->block();
+	branch.latch = this->pCode->block();
+
+	this->pCode->branch(cond, branch.next, branch.exit);
+	this->pCode->enter(branch.latch);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief FOR ( <expr> ; <expr> ; <expr> ) { @forHead
+ */
+Error Parser::actForHead()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+	const BranchItem& branch = this->pBranches.back();
+
+	//condition may fail before the loop head was generated
+	if(branch.next == IrNone)
+	{
+		return Error(Error::Type::Ok);
+	}
+
+	this->pCode->jump(branch.head);
+	this->pCode->enter(branch.next);
+	this->pCode->seal(branch.next);
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief FOR ( <expr> ; <expr> ; <expr> ) { <body> @forEnd
+ */
+Error Parser::actForEnd()
+{
+	if(this->pBranches.size() == 0)
+	{
+		return Error(Error::Type::Ok);
+	}
+	BranchItem branch = this->pBranches.back();
+	this->pBranches.pop_back();
+
+	//back edge goes through the latch (step expression)
+	if(branch.latch == IrNone)
+	{
+		this->pCode->jump(branch.head);
+		branch.exit = this->pCode->block();
+	}
+	else
+	{
+		this->pCode->jump(branch.latch);
+		this->pCode->seal(branch.latch);
+	}
+	this->pCode->seal(branch.head);
+
+	this->pCode->enter(branch.exit);
+	this->pCode->seal(branch.exit);
+
+	return Error(Error::Type::Ok);
+}
+
 /**
  * \brief main function -> generates output or throws an error
  */
@@ -1196,5 +1672,66 @@ Error Parser::parse(FILE* in, FILE* out)
 
 	this->pScope   = 0;
 
-	return this->prog();
-}
\ No newline at end of file
+	//diagnostics are formatted after the whole source is parsed
+	Diagnostics::use(&this->pDiagnostics);
+
+	//scanner runs on producer thread and publishes tokens into the ring
+	TokenRing   ring(ParserPipelineBatches);
+	std::thread producer;
+	if(this->pPipeline)
+	{
+		this->pRing     = &ring;
+		this->pBatchPos = 0;
+		producer        = std::thread(&Parser::produce, this);
+	}
+
+	//streamed code is written out in small blocks so only the current function is kept in memory
+	Emitter* emitter = Emitter::create(this->pSink, this->pOut, this->pStream ? ParserStreamChunk : EmitterBlock);
+	this->pEmitter   = emitter;
+
+	Error result(Error::Type::Ok);
+	if(!this->pStream && (this->pJobs > 1 || this->pLazy))
+	{
+		result = this->parseParallel();
+	}
+	else
+	{
+		this->pToken = this->nextToken();
+
+		//producer failed before publishing anything (preprocessor error)
+		if(!this->pPrepared)
+		{
+			result = Error(Error::Type::Lexical);
+		}
+		else
+		{
+			result = this->derive(ParserRule::Prog);
+		}
+	}
+
+	if(this->pPipeline)
+	{
+		//parser may stop before the end of the source
+		ring.cancel();
+		producer.join();
+
+		this->pRing = nullptr;
+		this->pBatch.clear();
+		this->pDiagnostics.append(this->pProducerDiagnostics);
+	}
+
+	emitter->finish();
+	delete emitter;
+	this->pEmitter = nullptr;
+
+	//recovered errors leave the result Ok, any recorded diagnostic fails the compilation
+	if(result.type == Error::Type::Ok && this->pDiagnostics.size() != 0)
+	{
+		result = Error(Error::Type::Syntax);
+	}
+
+	Diagnostics::use(nullptr);
+	this->pDiagnostics.flush(this->pIn, this->pSourceMap);
+
+	return result;
+}
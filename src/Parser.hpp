@@ -3,11 +3,45 @@
 #include "types.hpp"
 #include "Scanner.hpp"
 #include "Error.hpp"
+#include "SourceMap.hpp"
+#include "ParserTable.hpp"
+#include "TokenRing.hpp"
+#include "Layout.hpp"
+#include "Codegen.hpp"
+#include "Sccp.hpp"
+#include "Gvn.hpp"
+#include "Licm.hpp"
+#include "Unroll.hpp"
+#include "Regalloc.hpp"
+#include "Emitter.hpp"
 
 #include <cstdio>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <functional>
+
+/**
+ * \brief propagate error of parser state
+ */
+#define ParserProcessState(s) do { Error e = s; if(e.type != Error::Type::Ok) { return e; } } while(0)
+
+/**
+ * \brief pipelined scanning, tokens in one batch and batches in the ring
+ */
+static constexpr u64 ParserPipelineBatchSize = 1024;
+static constexpr u64 ParserPipelineBatches   = 16;
+
+/**
+ * \brief streaming compilation, output is written out after reaching this size
+ */
+static constexpr u64 ParserStreamChunk = 64 * 1024;
+
+/**
+ * \brief packages with at most this many items are passed and returned in registers,
+ *        larger ones in memory of the caller
+ */
+static constexpr u64 ParserPackRegisters = 4;
 
 /**
  * \brief parser
@@ -15,47 +49,262 @@
 class Parser
 {
 public:
-	Parser() {}
+	Parser();
 
 	/**
 	 * \brief main function -> generates output or throws an error
 	 */
 	Error parse(FILE* in, FILE* out);
 
+	/**
+	 * \brief number of threads used for parsing function bodies (1 = sequential)
+	 */
+	void setJobs(u64 jobs) { this->pJobs = jobs; }
+	/**
+	 * \brief compile function bodies only when they are referenced
+	 */
+	void setLazy(bool lazy) { this->pLazy = lazy; }
+	/**
+	 * \brief factor of partial unrolling of innermost loops (1 = loops are only unrolled fully and peeled)
+	 */
+	void setUnroll(u32 factor) { this->pUnrollFactor = factor; }
+	/**
+	 * \brief stop parsing after this many errors (1 = stop at the first error)
+	 */
+	void setMaxErrors(u64 max) { this->pMaxErrors = max; }
+	/**
+	 * \brief scan tokens on producer thread, prepare runs on that thread before scanning (preprocessor)
+	 */
+	void setPipeline(bool pipeline, std::function<bool()> prepare = nullptr) { this->pPipeline = pipeline; this->pPrepare = prepare; }
+	/**
+	 * \brief write code of every function into output file as soon as the function is parsed
+	 *        and release its memory (function bodies are parsed sequentially)
+	 */
+	void setStream(bool stream) { this->pStream = stream; }
+	/**
+	 * \brief place package items by decreasing alignment to minimize padding
+	 */
+	void setPackReorder(bool reorder) { this->pPackReorder = reorder; }
+	/**
+	 * \brief format of output (printed code, binary code or nothing)
+	 */
+	void setSink(EmitterSink sink) { this->pSink = sink; }
+	/**
+	 * \brief target architecture of register allocation
+	 */
+	void setTarget(const Target* target) { this->pTarget = target; this->pInit.setTarget(target); }
+	/**
+	 * \brief positions of parsed source in source files for diagnostics (nullptr = positions in parsed source)
+	 */
+	void setSourceMap(const SourceMap* map) { this->pSourceMap = map; }
+
 	//useful enums
 	enum class ReturnType { Byte, Int, Float, Pack, Void };
 	enum class VarType    { Byte, Int, Float, Pack };
+	//type of expression value, ordered by conversion rank (None = no value or keep the type)
+	enum class ValueType  { Byte, Int, Float, None };
 
 private:
 
 	/**
-	 * \brief parser states
+	 * \brief table driven LL(1) parsing of rule
+	 * \note the lookahead token is expected to be fetched
+	 */
+	Error derive(ParserRule rule);
+	/**
+	 * \brief execute semantic action
+	 */
+	Error action(ParserAction a);
+	/**
+	 * \brief count error and try to continue parsing
+	 * \note returns Ok when parsing can continue
 	 */
-	Error prog();
-	Error defArgs();
-	Error defArgsList();
-	Error packItem();
-	Error packItemList();
-	Error args();
-	Error argsList();
-	Error funcType();
-	Error body();
-	Error expr(bool resOnStack = false);
+	Error fail(Error e, u64 base, bool resync);
+	/**
+	 * \brief panic mode recovery, skip tokens up to synchronizing token and unwind parse stack
+	 * \note synchronizes at ";", "}", "func", "pack" and end of file
+	 */
+	bool  recover();
+	/**
+	 * \brief close the innermost branch or loop (after an error discarded its end)
+	 */
+	void  closeBranch();
+
+	/**
+	 * \brief semantic actions of the grammar
+	 * \note see ll.grammar
+	 */
+	#define PARSER_ACTION_DECL(a) Error act##a();
+	PARSER_ACTIONS(PARSER_ACTION_DECL)
+	#undef PARSER_ACTION_DECL
+
+	/**
+	 * \brief expression evaluation
+	 * \note result is converted to target type, type of the result is stored in pExprType
+	 */
+	Error expr(bool resOnStack = false, ValueType target = ValueType::None);
+	/**
+	 * \brief type of value stored in variable or returned from function
+	 */
+	static ValueType valueType(VarType t)    { return t == VarType::Pack ? ValueType::None : (ValueType)t; }
+	static ValueType valueType(ReturnType t) { return t == ReturnType::Pack || t == ReturnType::Void ? ValueType::None : (ValueType)t; }
+	/**
+	 * \brief type of expression operand
+	 */
+	ValueType exprTokenType(const Scanner::Token& token) const;
+	/**
+	 * \brief value of expression operand (nothing for constant, it is created by exprCoerce)
+	 */
+	IrId      exprOperand(const Scanner::Token& token);
+	/**
+	 * \brief convert operand to type, constant is created directly in the type
+	 */
+	IrId      exprCoerce(IrId value, const Scanner::Token& token, ValueType from, ValueType to);
+	/**
+	 * \brief value of the last parsed expression
+	 */
+	IrId      exprValue();
+	/**
+	 * \brief load of package item and store into package item
+	 * \note items of scalarized variables are SSA variables, other are accessed at constant offset
+	 */
+	IrId      exprLoad(const std::string& var, u64 item);
+	void      exprStore(const std::string& var, u64 item, IrId value);
+	/**
+	 * \brief temporary memory of large package (copy passed as argument or returned value)
+	 */
+	std::string packTemp(const std::string& pack);
+	/**
+	 * \brief destination of package value
+	 */
+	enum class PackSink
+	{
+		Var,
+		Return,
+		Arg,
+	};
+	/**
+	 * \brief package value (variable or call) copied into variable, returned or passed as argument
+	 * \note the first token is expected to be fetched and the token after the value is fetched
+	 */
+	Error     packValue(const std::string& pack, PackSink sink, const std::string& dest);
+	/**
+	 * \brief start parsing arguments of function call
+	 */
+	Error     callBegin(const std::string& name, u64 offset);
+	/**
+	 * \brief check number of parsed arguments and finish the call
+	 */
+	Error     callEnd();
 
 	/**
 	 * \brief utility for exiting scope
 	 */
 	void exitScope();
 
+	/**
+	 * \brief start code of function body (defines arguments) and write it out at the end of the body
+	 */
+	void bodyBegin();
+	void bodyEnd();
+	/**
+	 * \brief initial memory of global variable with constant value
+	 */
+	void globalData(const std::string& name, Parser::VarType type, const Scanner::Token& value);
+
+	/**
+	 * \brief fetch next token from scanner thread or directly from scanner
+	 */
+	Scanner::Token nextToken();
+
+	/**
+	 * \brief print trace message into output
+	 */
+	void emit(const char* fmt, ...);
+	/**
+	 * \brief release memory used by finished function (its code was already written by emitter)
+	 */
+	void flushStream();
+	/**
+	 * \brief print token as expression operand or operator
+	 */
+	void exprTokenPrint(Scanner::Token& token);
+
+	/**
+	 * \brief parse function bodies in parallel or lazily
+	 * \note first pass processes global declarations and records source offsets of bodies,
+	 *       bodies are then scanned again and parsed by worker parsers against read-only global tables
+	 */
+	Error parseParallel();
+	/**
+	 * \brief record function body for worker thread and skip it
+	 */
+	Error skipBody();
+
+	/**
+	 * \brief producer thread of pipelined parsing, publishes scanned tokens into the ring
+	 */
+	void  produce();
+	/**
+	 * \brief take token from the ring
+	 */
+	Scanner::Token ringToken();
+
 	//scanner for fetching tokens
 	Scanner pScanner;
 
+	//pipelined scanning (nullptr = scanner runs on the parser thread)
+	bool                  pPipeline;
+	std::function<bool()> pPrepare;
+	TokenRing*            pRing;
+	TokenRing::Batch      pBatch;
+	u64                   pBatchPos;
+	bool                  pPrepared;
+	Diagnostics           pProducerDiagnostics;
+
+	//output of generated code (output segment in memory when parsing in parallel)
+	EmitterSink pSink;
+	Emitter*    pEmitter;
+
+	//target architecture
+	const Target* pTarget;
+
+	//number of parsing threads
+	u64 pJobs;
+
+	//first pass of parallel parsing only records function bodies
+	bool pSkipBodies;
+
+	//compile only referenced function bodies
+	bool pLazy;
+
+	//factor of partial loop unrolling
+	u32 pUnrollFactor;
+
+	//code of every function is written into output file as soon as it is parsed
+	bool pStream;
+
+	//functions referenced by parsed code
+	std::vector<std::string> pReferenced;
+
 	//input/output
 	FILE* pIn;
 	FILE* pOut;
 
-	//current token
+	//current (lookahead) token and last matched token
 	Scanner::Token pToken;
+	Scanner::Token pPrevToken;
+
+	//parse stack
+	std::vector<ParserSymbol> pStack;
+
+	//reported errors and their limit
+	u64 pErrorCount;
+	u64 pMaxErrors;
+
+	//errors recorded while parsing and positions of the source they are reported at
+	Diagnostics      pDiagnostics;
+	const SourceMap* pSourceMap;
 
 	//temp information about defining function
 	std::string pCurrFunctionName;
@@ -65,9 +314,11 @@ private:
 	//temp information about defining variable
 	std::string pCurrVariableName;
 	VarType     pCurrVariableType;
+	std::string pCurrVariablePack;
 
-	//temp information about defining package
+	//temp information about defining package, its items are being defined
 	std::string pCurrPackageName;
+	bool        pPackOpen;
 
 	//keep track of scope depth
 	u64 pScope;
@@ -80,18 +331,92 @@ private:
 		struct Arg 
 		{ 
 			VarType     type;
+			std::string name;
+			std::string pack;
 			Arg() {} 
 			Arg(VarType t) { type = t; }
+			Arg(VarType t, const std::string& n) { type = t; name = n; }
+			Arg(VarType t, const std::string& n, const std::string& p) { type = t; name = n; pack = p; }
 		};
 		//argument list
 		std::vector<Arg> args;
 		//return type
 		ReturnType       retType;
+		//name of returned package
+		std::string      retPack;
+		//source offset of declaration
+		u64              offset;
 
-		FunctionItem() {}
+		FunctionItem() { offset = 0; }
 	};
 	std::unordered_map<std::string, Parser::FunctionItem> pFunctions;
 
+	/**
+	 * \brief function calls which arguments are being parsed
+	 */
+	struct CallItem
+	{
+		std::string         name;
+		const FunctionItem* function;
+		u64                 args;
+		u64                 offset;
+		//values of parsed arguments
+		std::vector<IrId>   values;
+		//temporary memory of large packages passed by value, released after the call
+		std::vector<std::string> temps;
+
+		CallItem(const std::string& n, const FunctionItem* f, u64 o) { name = n; function = f; args = 0; offset = o; }
+	};
+	std::vector<CallItem> pCalls;
+
+	//type expected by the next expression (inherited from declaration, assignment or return)
+	//and type of the last parsed expression
+	ValueType pExprTarget;
+	ValueType pExprType;
+
+	//last parsed expression was evaluated by the compiler and its value
+	bool           pExprConstant;
+	Scanner::Token pExprValue;
+
+	/**
+	 * \brief pre-initialized global variables (data section)
+	 */
+	struct DataItem
+	{
+		std::string    name;
+		VarType        type;
+		Scanner::Token value;
+	};
+	std::vector<DataItem> pData;
+
+	//code of function body and of dynamic global initializers (run once before main)
+	Codegen  pBody;
+	Codegen  pInit;
+	Codegen* pCode;
+	Sccp     pSccp;
+	Gvn      pGvn;
+	Licm     pLicm;
+	Unroll   pUnroll;
+	Regalloc pRegalloc;
+	bool     pInitUsed;
+	//errors counted before the body, code of body with errors is not written out
+	u64      pBodyErrors;
+	//value of the last parsed expression (IrNone for constant)
+	IrId     pExprResult;
+	//address of memory for returned large package passed by the caller
+	IrId     pRetMemory;
+
+	/**
+	 * \brief blocks of enclosing if (next condition, join) and loops (header, body, exit, latch of for)
+	 */
+	struct BranchItem
+	{
+		IrId head;
+		IrId next;
+		IrId exit;
+		IrId latch;
+	};
+	std::vector<BranchItem> pBranches;
 
 	/**
 	 * \brief variable table
@@ -99,11 +424,20 @@ private:
 	struct VariableItem
 	{
 		//variable type
-		VarType varType;
+		VarType     varType;
 		//living scope
-		u64     scope;
+		u64         scope;
+		//name of the package of package variable
+		std::string pack;
+		//items of package variable are independent scalars (scalar replacement of aggregate),
+		//every local and argument package is, its value is never addressed, only copied
+		bool        scalar;
+		//SSA variable of local scalar or the first item of scalarized package (IrNone for memory)
+		IrId        ir;
+		//source offset of declaration
+		u64         offset;
 
-		VariableItem() {}
+		VariableItem() { scalar = false; ir = IrNone; offset = 0; }
 	};
 	std::unordered_map<std::string, Parser::VariableItem> pVariables;
 	/**
@@ -116,8 +450,79 @@ private:
 	 */
 	struct PackItem
 	{
-		std::unordered_map<std::string, VarType> items;
-		PackItem() {}
+		struct Item
+		{
+			std::string name;
+			VarType     type;
+			Item(const std::string& n, VarType t) { name = n; type = t; }
+		};
+		//items in declaration order and their index by name
+		std::vector<Item>                    items;
+		std::unordered_map<std::string, u64> index;
+		//offsets of items, computed once at the end of the definition
+		Layout                               layout;
+		//values are passed in registers
+		bool                                 registers;
+		//source offset of declaration
+		u64                                  offset;
+
+		PackItem() { registers = false; offset = 0; }
 	};
 	std::unordered_map<std::string, Parser::PackItem> pPackages;
+
+	//reorder items of packages
+	bool pPackReorder;
+
+	//item of package variable being assigned
+	VarType     pCurrFieldType;
+	u64         pCurrFieldIndex;
+
+	//package of value expected by the next expression (empty for scalar value) and its destination
+	std::string pExprPack;
+	PackSink    pExprPackSink;
+
+	/**
+	 * \brief resolve item of package variable
+	 */
+	Error findField(const std::string& var, const std::string& name, u64 offset, VarType& type, u64& index) const;
+
+	/**
+	 * \brief symbol lookup in local tables and in global tables of parent parser
+	 */
+	const VariableItem* findVariable(const std::string& name) const;
+	const FunctionItem* findFunction(const std::string& name) const;
+	const PackItem*     findPackage(const std::string& name) const;
+
+	//read-only global tables when parsing function body on worker thread,
+	//only globals declared before the body (source offset) are visible like in sequential parsing
+	const Parser* pGlobal;
+	u64           pVisible;
+
+	/**
+	 * \brief function body recorded by the first pass of parallel parsing
+	 */
+	struct BodyJob
+	{
+		//function name
+		std::string name;
+		//source offset of the first token after "{"
+		u64         offset;
+		//index of output segment
+		u64         segment;
+		//result of parsing
+		Error       result;
+		Diagnostics diagnostics;
+		//body was requested by lazy compilation
+		bool        requested;
+		//body was already compiled
+		bool        compiled;
+		//functions referenced by the body
+		std::vector<std::string> referenced;
+
+		BodyJob() : result(Error::Type::Ok) { requested = false; compiled = false; }
+	};
+	std::vector<BodyJob> pBodyJobs;
+
+	//output segments in source order
+	std::vector<Emitter*> pSegments;
 };
\ No newline at end of file
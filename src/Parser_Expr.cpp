@@ -1,4 +1,5 @@
 #include "Parser.hpp"
+#include "Operator.hpp"
 
 #include <vector>
 #include <stack>
@@ -76,35 +77,491 @@ static void ParserExprOperation(Scanner::Token& token, std::vector<Scanner::Toke
 /**
  * \brief helper function to see better expr token content
  */
-static void ParserExprTokenPrint(Scanner::Token& token)
+void Parser::exprTokenPrint(Scanner::Token& token)
 {
 	switch(token.type)
 	{
 		case Scanner::TokenType::String:
-		case Scanner::TokenType::Id:  { std::printf("%s", token.attribute.litString.c_str()); break; }
-		case Scanner::TokenType::Int: { std::printf("%lli", token.attribute.litInt); break; }
-		case Scanner::TokenType::Float: { std::printf("%lf", token.attribute.litFloat); break; }
-		case Scanner::TokenType::Plus: { std::printf(" + "); break; }
-		case Scanner::TokenType::Minus: { std::printf(" - "); break; }
-		case Scanner::TokenType::Mul: { std::printf(" * "); break; }
-		case Scanner::TokenType::Div: { std::printf(" / "); break; }
-		case Scanner::TokenType::Less: { std::printf(" < "); break; }
-		case Scanner::TokenType::LessEqu: { std::printf(" <= "); break; }
-		case Scanner::TokenType::More: { std::printf(" > "); break; }
-		case Scanner::TokenType::MoreEqu: { std::printf(" >= "); break; }
-		case Scanner::TokenType::Equ: { std::printf(" == "); break; }
-		case Scanner::TokenType::NonEqu: { std::printf(" != "); break; }
-		case Scanner::TokenType::Acc: { std::printf("pop()"); break; }
-		case Scanner::TokenType::Ret: { std::printf("rr"); break; }
-		default: { std::printf(" NaR "); break; }
+		case Scanner::TokenType::Id:  { this->emit("%s", token.attribute.litString.c_str()); break; }
+		case Scanner::TokenType::Int: { this->emit("%lli", token.attribute.litInt); break; }
+		case Scanner::TokenType::Float:
+		{
+			std::string value;
+			EmitterFloat(value, token.attribute.litFloat);
+			this->emit("%s", value.c_str());
+			break;
+		}
+		case Scanner::TokenType::Plus: { this->emit(" + "); break; }
+		case Scanner::TokenType::Minus: { this->emit(" - "); break; }
+		case Scanner::TokenType::Mul: { this->emit(" * "); break; }
+		case Scanner::TokenType::Div: { this->emit(" / "); break; }
+		case Scanner::TokenType::Less: { this->emit(" < "); break; }
+		case Scanner::TokenType::LessEqu: { this->emit(" <= "); break; }
+		case Scanner::TokenType::More: { this->emit(" > "); break; }
+		case Scanner::TokenType::MoreEqu: { this->emit(" >= "); break; }
+		case Scanner::TokenType::Equ: { this->emit(" == "); break; }
+		case Scanner::TokenType::NonEqu: { this->emit(" != "); break; }
+		case Scanner::TokenType::Acc: { this->emit("pop()"); break; }
+		case Scanner::TokenType::Ret: { this->emit("rr"); break; }
+		default: { this->emit(" NaR "); break; }
+	}
+}
+
+/**
+ * \brief instruction of binary operator
+ */
+static IrOp ParserExprOpcode(Scanner::TokenType type)
+{
+	switch(type)
+	{
+		case Scanner::TokenType::Plus:    { return IrOp::Add; }
+		case Scanner::TokenType::Minus:   { return IrOp::Sub; }
+		case Scanner::TokenType::Mul:     { return IrOp::Mul; }
+		case Scanner::TokenType::Div:     { return IrOp::Div; }
+		case Scanner::TokenType::Less:    { return IrOp::Lt; }
+		case Scanner::TokenType::LessEqu: { return IrOp::Le; }
+		case Scanner::TokenType::More:    { return IrOp::Gt; }
+		case Scanner::TokenType::MoreEqu: { return IrOp::Ge; }
+		case Scanner::TokenType::Equ:     { return IrOp::Eq; }
+		default:                          { return IrOp::Ne; }
+	}
+}
+
+/**
+ * \brief operation of constants evaluated by semantics of the operator (false when it has no result)
+ */
+static bool ParserExprFold(IrOp op, const Scanner::Token& a, const Scanner::Token& b, Scanner::Token& result)
+{
+	OperatorValue value  = { IrType::I64, 0, 0.0 };
+	bool          folded = false;
+	if(a.type == Scanner::TokenType::Float)
+	{
+		folded = b.type == Scanner::TokenType::Float ? OperatorEval(op, a.attribute.litFloat, b.attribute.litFloat, value) :
+		                                                OperatorEval(op, a.attribute.litFloat, b.attribute.litInt, value);
+	}
+	else
+	{
+		folded = b.type == Scanner::TokenType::Float ? OperatorEval(op, a.attribute.litInt, b.attribute.litFloat, value) :
+		                                                OperatorEval(op, a.attribute.litInt, b.attribute.litInt, value);
+	}
+	if(!folded)
+	{
+		return false;
+	}
+
+	result.type               = value.type == IrType::F64 ? Scanner::TokenType::Float : Scanner::TokenType::Int;
+	result.attribute.litInt   = value.i;
+	result.attribute.litFloat = value.f;
+	return true;
+}
+
+/**
+ * \brief convert constant to another type in compile time by semantics of conversion
+ *        (false when float is out of integer range, it is converted at runtime)
+ * \note byte constant is integer truncated to 8 bits
+ */
+static bool ParserExprConstConvert(Scanner::Token& token, Parser::ValueType to)
+{
+	if(to == Parser::ValueType::None)
+	{
+		return true;
+	}
+
+	OperatorValue value;
+	OperatorValue result;
+	value.type = token.type == Scanner::TokenType::Float ? IrType::F64 : IrType::I64;
+	value.i    = token.type == Scanner::TokenType::Float ? 0 : token.attribute.litInt;
+	value.f    = token.type == Scanner::TokenType::Float ? token.attribute.litFloat : 0.0;
+	if(!OperatorConvert(value, (IrType)to, result))
+	{
+		return false;
+	}
+
+	token.type               = result.type == IrType::F64 ? Scanner::TokenType::Float : Scanner::TokenType::Int;
+	token.attribute.litInt   = result.i;
+	token.attribute.litFloat = result.f;
+	return true;
+}
+
+/**
+ * \brief type of expression operand
+ */
+Parser::ValueType Parser::exprTokenType(const Scanner::Token& token) const
+{
+	switch(token.type)
+	{
+		case Scanner::TokenType::Float:  { return Parser::ValueType::Float; }
+		case Scanner::TokenType::Id:     { return Parser::valueType(this->findVariable(token.attribute.litString)->varType); }
+		case Scanner::TokenType::Ret:    { return Parser::valueType(this->findFunction(token.attribute.litString)->retType); }
+		//item was already resolved when the token was created
+		case Scanner::TokenType::Field:
+		{
+			u64     dot  = token.attribute.litString.find('.');
+			VarType type = Parser::VarType::Int;
+			u64     at   = 0;
+			this->findField(token.attribute.litString.substr(0, dot), token.attribute.litString.substr(dot + 1), 
+				token.offset, type, at);
+			return Parser::valueType(type);
+		}
+		//strings are represented by their address
+		default:                         { return Parser::ValueType::Int; }
+	}
+}
+
+/**
+ * \brief value of expression operand (nothing for constant, it is created by exprCoerce)
+ */
+IrId Parser::exprOperand(const Scanner::Token& token)
+{
+	switch(token.type)
+	{
+		case Scanner::TokenType::String: { return this->pCode->string(token.attribute.litString); }
+		//value of call was stored into the token
+		case Scanner::TokenType::Ret:    { return (IrId)token.attribute.litInt; }
+		case Scanner::TokenType::Field:
+		{
+			u64 dot = token.attribute.litString.find('.');
+			return this->exprLoad(token.attribute.litString.substr(0, dot), (u64)token.attribute.litInt);
+		}
+		case Scanner::TokenType::Id:
+		{
+			//local variable is SSA variable, global one is in memory
+			const VariableItem* var = this->findVariable(token.attribute.litString);
+			if(var->ir != IrNone)
+			{
+				return this->pCode->read(var->ir);
+			}
+			return this->pCode->load(token.attribute.litString, 0, (IrType)Parser::valueType(var->varType));
+		}
+		default:                         { return IrNone; }
+	}
+}
+
+/**
+ * \brief convert operand to type, constant is created directly in the type
+ */
+IrId Parser::exprCoerce(IrId value, const Scanner::Token& token, ValueType from, ValueType to)
+{
+	if(value == IrNone)
+	{
+		Scanner::Token constant = token;
+		if(!ParserExprConstConvert(constant, to))
+		{
+			return this->pCode->convert(this->pCode->constant(token.attribute.litFloat), (IrType)to);
+		}
+		if(constant.type == Scanner::TokenType::Float)
+		{
+			return this->pCode->constant(constant.attribute.litFloat);
+		}
+		return this->pCode->constant((IrType)to, constant.attribute.litInt);
+	}
+	if(from != to)
+	{
+		return this->pCode->convert(value, (IrType)to);
+	}
+	return value;
+}
+
+/**
+ * \brief value of the last parsed expression
+ * \note constant is created when it is used, expression with errors gives zero
+ */
+IrId Parser::exprValue()
+{
+	if(this->pExprResult != IrNone)
+	{
+		return this->pExprResult;
+	}
+	if(!this->pExprConstant || this->pExprType == Parser::ValueType::None)
+	{
+		return this->pCode->constant(IrType::I64, 0);
+	}
+	if(this->pExprValue.type == Scanner::TokenType::String)
+	{
+		return this->pCode->string(this->pExprValue.attribute.litString);
 	}
+
+	return this->exprCoerce(IrNone, this->pExprValue, this->pExprType, this->pExprType);
+}
+
+/**
+ * \brief load of package item
+ * \note items of local variables and arguments are SSA variables, globals are loaded from constant offset
+ */
+IrId Parser::exprLoad(const std::string& var, u64 item)
+{
+	const VariableItem* v    = this->findVariable(var);
+	const PackItem*     pack = this->findPackage(v->pack);
+	if(v->scalar)
+	{
+		return this->pCode->read(v->ir + item);
+	}
+
+	return this->pCode->load(var, pack->layout.fields[item].offset, (IrType)Parser::valueType(pack->items[item].type));
+}
+
+/**
+ * \brief store into package item
+ */
+void Parser::exprStore(const std::string& var, u64 item, IrId value)
+{
+	const VariableItem* v    = this->findVariable(var);
+	const PackItem*     pack = this->findPackage(v->pack);
+	if(v->scalar)
+	{
+		this->pCode->write(v->ir + item, value);
+		return;
+	}
+
+	this->pCode->store(var, pack->layout.fields[item].offset, (IrType)Parser::valueType(pack->items[item].type), value);
+}
+
+/**
+ * \brief temporary memory of large package
+ * \note name is not an identifier, so it doesn't collide with variables, and every temporary
+ *       memory of the function is a new local
+ */
+std::string Parser::packTemp(const std::string& pack)
+{
+	const PackItem* p    = this->findPackage(pack);
+	std::string     name = "$" + std::to_string(this->pCode->localCount());
+	this->pCode->local(name, p->layout.size, p->layout.align);
+	return name;
+}
+
+/**
+ * \brief package value (variable or call) copied into variable, returned or passed as argument
+ * \note items are moved as one value per item, large package is returned into memory passed
+ *       by the caller and passed as address of a copy in temporary memory of the caller,
+ *       so only globals and these copies live in memory
+ */
+Error Parser::packValue(const std::string& pack, PackSink sink, const std::string& dest)
+{
+	const PackItem*   p     = this->findPackage(pack);
+	std::string       name  = this->pToken.attribute.litString;
+	u64               start = this->pToken.offset;
+	std::vector<IrId> values;
+
+	if(this->pToken.type != Scanner::TokenType::Id)
+	{
+		return Error(Error::Code::PackExpected, start, pack.c_str());
+	}
+
+	//package variable
+	if(const VariableItem* var = this->findVariable(name))
+	{
+		if(var->varType != Parser::VarType::Pack || var->pack != pack)
+		{
+			return Error(Error::Code::PackExpected, start, pack.c_str());
+		}
+		this->pToken = this->nextToken();
+
+		//global is copied in memory when it goes into memory
+		const VariableItem* to = sink == PackSink::Var ? this->findVariable(dest) : nullptr;
+		if(!var->scalar && !p->registers && (to == nullptr || !to->scalar))
+		{
+			IrId source = this->pCode->address(name);
+			switch(sink)
+			{
+				case PackSink::Var:    { this->pCode->copy(dest, source, p->layout.size); break; }
+				case PackSink::Return: { this->pCode->copy(this->pRetMemory, source, p->layout.size); this->pCode->ret(nullptr, 0); break; }
+				case PackSink::Arg:
+				{
+					std::string temp = this->packTemp(pack);
+					this->pCalls.back().temps.push_back(temp);
+					this->pCode->copy(temp, source, p->layout.size);
+					this->pCalls.back().values.push_back(this->pCode->address(temp));
+					break;
+				}
+			}
+			return Error(Error::Type::Ok);
+		}
+
+		for(u64 i = 0; i < p->items.size(); i++)
+		{
+			values.push_back(this->exprLoad(name, i));
+		}
+	}
+	//call of function returning package
+	else if(const FunctionItem* function = this->findFunction(name))
+	{
+		if(function->retType != Parser::ReturnType::Pack || function->retPack != pack)
+		{
+			return Error(Error::Code::PackExpected, start, pack.c_str());
+		}
+		if(this->pLazy)
+		{
+			this->pReferenced.push_back(name);
+		}
+
+		this->pToken = this->nextToken();
+		if(this->pToken.type != Scanner::TokenType::LeftBracket)
+		{
+			return Error(Error::Code::ExpectedCallBracket, this->pToken.offset);
+		}
+
+		//large package is written directly into returned or global memory, argument into temporary
+		//memory of the outer call, items of variable are loaded from temporary memory after the call
+		IrId        memory = IrNone;
+		std::string temp;
+		if(!p->registers)
+		{
+			const VariableItem* to = sink == PackSink::Var ? this->findVariable(dest) : nullptr;
+			if(sink == PackSink::Return)
+			{
+				memory = this->pRetMemory;
+			}
+			else if(sink == PackSink::Var && (to == nullptr || !to->scalar))
+			{
+				memory = this->pCode->address(dest);
+			}
+			else
+			{
+				temp   = this->packTemp(pack);
+				memory = this->pCode->address(temp);
+				if(sink == PackSink::Arg)
+				{
+					this->pCalls.back().temps.push_back(temp);
+				}
+			}
+		}
+
+		//evaluate arguments, <args> eats the right bracket
+		this->pPrevToken = std::move(this->pToken);
+		this->pToken     = this->nextToken();
+		ParserProcessState(this->callBegin(name, start));
+		if(memory != IrNone)
+		{
+			this->pCalls.back().values.push_back(memory);
+		}
+
+		Error args = this->derive(ParserRule::Args);
+		const CallItem& item = this->pCalls.back();
+		IrId  call = this->pCode->call(name, IrType::None, item.values.data(), (u16)item.values.size());
+		Error end  = this->callEnd();
+		ParserProcessState(args);
+		ParserProcessState(end);
+
+		if(!p->registers)
+		{
+			switch(sink)
+			{
+				case PackSink::Return: { this->pCode->ret(nullptr, 0); break; }
+				case PackSink::Arg:    { this->pCalls.back().values.push_back(memory); break; }
+				case PackSink::Var:
+				{
+					for(u64 i = 0; i < p->items.size() && !temp.empty(); i++)
+					{
+						IrType type = (IrType)Parser::valueType(p->items[i].type);
+						this->exprStore(dest, i, this->pCode->load(temp, p->layout.fields[i].offset, type));
+					}
+					this->pCode->localEnd(temp);
+					break;
+				}
+			}
+			return Error(Error::Type::Ok);
+		}
+
+		for(u64 i = 0; i < p->items.size(); i++)
+		{
+			values.push_back(this->pCode->result(call, i, (IrType)Parser::valueType(p->items[i].type)));
+		}
+	}
+	else
+	{
+		return Error(Error::Code::UndefinedReference, start);
+	}
+
+	//items are stored into the destination variable, returned or passed one by one,
+	//large package is stored into returned memory or temporary memory of the call
+	switch(sink)
+	{
+		case PackSink::Var:
+		{
+			for(u64 i = 0; i < values.size(); i++)
+			{
+				this->exprStore(dest, i, values[i]);
+			}
+			break;
+		}
+		case PackSink::Return:
+		{
+			if(p->registers)
+			{
+				this->pCode->ret(values.data(), (u16)values.size());
+				break;
+			}
+			for(u64 i = 0; i < values.size(); i++)
+			{
+				this->pCode->store(this->pRetMemory, p->layout.fields[i].offset, (IrType)Parser::valueType(p->items[i].type), values[i]);
+			}
+			this->pCode->ret(nullptr, 0);
+			break;
+		}
+		case PackSink::Arg:
+		{
+			std::vector<IrId>& args = this->pCalls.back().values;
+			if(p->registers)
+			{
+				args.insert(args.end(), values.begin(), values.end());
+				break;
+			}
+			std::string temp = this->packTemp(pack);
+			this->pCalls.back().temps.push_back(temp);
+			for(u64 i = 0; i < values.size(); i++)
+			{
+				this->pCode->store(temp, p->layout.fields[i].offset, (IrType)Parser::valueType(p->items[i].type), values[i]);
+			}
+			args.push_back(this->pCode->address(temp));
+			break;
+		}
+	}
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief start parsing arguments of function call
+ */
+Error Parser::callBegin(const std::string& name, u64 offset)
+{
+	const FunctionItem* function = this->findFunction(name);
+
+	this->pCalls.emplace_back(name, function, offset);
+
+	if(function == nullptr)
+	{
+		return Error(Error::Code::CallUndefined, offset, name.c_str());
+	}
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief check number of parsed arguments and finish the call
+ */
+Error Parser::callEnd()
+{
+	CallItem call = std::move(this->pCalls.back());
+	this->pCalls.pop_back();
+	for(const std::string& temp : call.temps)
+	{
+		this->pCode->localEnd(temp);
+	}
+
+	if(call.function != nullptr && call.args != call.function->args.size())
+	{
+		return Error(Error::Code::CallArguments, call.offset, call.name.c_str());
+	}
+
+	return Error(Error::Type::Ok);
 }
 
 /**
  * \brief expression evaluation using infix to postfix algorithm
  * \note first token is expected to be fetched and last token is eaten
  */
-Error Parser::expr(bool resOnStack)
+Error Parser::expr(bool resOnStack, ValueType target)
 {
 	//data stack for operations and evaluation
 	std::vector<Scanner::Token> operationStack;
@@ -116,8 +573,8 @@ Error Parser::expr(bool resOnStack)
 	//flag for evaluating immediate constant
 	bool immediateEvaluation     = true;
 
-	//used for indexing registers and to see how complex the expression is
-	u64 gExprStackSize = 0;
+	//errors found after conversion to postfix are reported at the start of expression
+	u64 exprOffset = this->pToken.offset;
 
 	//main infix to postfix loop
 	//first token is expected to be fetched
@@ -136,35 +593,84 @@ Error Parser::expr(bool resOnStack)
 				immediateEvaluation = false;
 
 				//if the identificator is variable, continue in execution
-				if(this->pVariables.find(this->pToken.attribute.litString) != this->pVariables.end())
+				if(const VariableItem* var = this->findVariable(this->pToken.attribute.litString))
 				{
-					(void)0;
+					//package variable is used only through its items, item is loaded from constant offset
+					if(var->varType == Parser::VarType::Pack)
+					{
+						Scanner::Token field(Scanner::TokenType::Field);
+						field.offset = this->pToken.offset;
+						field.attribute.litString = this->pToken.attribute.litString;
+
+						this->pToken = this->nextToken();
+						if(this->pToken.type != Scanner::TokenType::Dot)
+						{
+							return Error(Error::Code::PackValue, field.offset, field.attribute.litString.c_str());
+						}
+						this->pToken = this->nextToken();
+						if(this->pToken.type != Scanner::TokenType::Id)
+						{
+							return Error(Error::Code::ExpectedAfter, this->pToken.offset, "identificator", "\".\"");
+						}
+
+						VarType type = Parser::VarType::Int;
+						u64     at   = 0;
+						ParserProcessState(this->findField(field.attribute.litString, this->pToken.attribute.litString, 
+							this->pToken.offset, type, at));
+
+						field.attribute.litString += "." + this->pToken.attribute.litString;
+						field.attribute.litInt     = (i64)at;
+						this->pToken = std::move(field);
+					}
 				}
 				//if the identificator is function, first evaluate expression for arguments and then call it
-				else if(this->pFunctions.find(this->pToken.attribute.litString) != this->pFunctions.end())
+				else if(const FunctionItem* function = this->findFunction(this->pToken.attribute.litString))
 				{
 					//save function name so we can call it
 					std::string functionName = this->pToken.attribute.litString;
+					u64         callOffset   = this->pToken.offset;
+					if(this->pLazy)
+					{
+						this->pReferenced.push_back(functionName);
+					}
 
-					this->pToken = this->pScanner.getToken();
+					//value of the call is used by the expression
+					if(Parser::valueType(function->retType) == Parser::ValueType::None)
+					{
+						return Error(Error::Code::VoidValue, callOffset, functionName.c_str());
+					}
+
+					this->pToken = this->nextToken();
 					//after function id must be LEFT BRACKET
 					if(this->pToken.type == Scanner::TokenType::LeftBracket)
 					{
-						//evaluate arguments
-						this->args();
+						//evaluate arguments, <args> eats the right bracket
+						this->pPrevToken = std::move(this->pToken);
+						this->pToken     = this->nextToken();
+						ParserProcessState(this->callBegin(functionName, callOffset));
+						Error args = this->derive(ParserRule::Args);
 						//call the function
-						std::printf("	call %s\n", functionName.c_str());
-						//push return data on the stack
-						this->pToken.type = Scanner::TokenType::Ret;
+						const CallItem& item = this->pCalls.back();
+						IrId  call = this->pCode->call(functionName, (IrType)Parser::valueType(function->retType), 
+							item.values.data(), (u16)item.values.size());
+						Error end  = this->callEnd();
+						ParserProcessState(args);
+						ParserProcessState(end);
+						//push return data on the stack, typed by the called function
+						postfixResult.push_back(Scanner::Token(Scanner::TokenType::Ret));
+						postfixResult.back().attribute.litString = functionName;
+						postfixResult.back().attribute.litInt    = call;
+						//token after the arguments is already fetched
+						continue;
 					}
 					else
 					{
-						return Error(Error::Type::Syntax, "Expected left bracket after function identificator");
+						return Error(Error::Code::ExpectedCallBracket, this->pToken.offset);
 					}
 				}
 				else
 				{
-					return Error(Error::Type::Syntax, "Refering to variable or function in expression that doesn't exists");
+					return Error(Error::Code::UndefinedReference, this->pToken.offset);
 				}
 			}
 
@@ -221,7 +727,7 @@ Error Parser::expr(bool resOnStack)
 		}
 
 		//fetch next token
-		this->pToken = this->pScanner.getToken();
+		this->pToken = this->nextToken();
 	} while(true);
 
 	//we converted infix to postfix
@@ -230,6 +736,10 @@ Error Parser::expr(bool resOnStack)
 	//clear operation stack for further use
 	operationStack.clear();
 
+	//type and value of every value on the operation stack (nothing for constant)
+	std::vector<Parser::ValueType> typeStack;
+	std::vector<IrId>              valueStack;
+
 	//main evaluation loop
 	for(u64 i = 0; i < postfixResult.size(); i++)
 	{
@@ -239,27 +749,12 @@ Error Parser::expr(bool resOnStack)
 		   postfixResult[i].type == Scanner::TokenType::Float  ||
 		   postfixResult[i].type == Scanner::TokenType::String ||
 		   postfixResult[i].type == Scanner::TokenType::Acc    ||
-		   postfixResult[i].type == Scanner::TokenType::Ret)
+		   postfixResult[i].type == Scanner::TokenType::Ret    ||
+		   postfixResult[i].type == Scanner::TokenType::Field)
 		{
 			operationStack.push_back(postfixResult[i]);
-			if(gExprStackSize < ARCH_REG_NUM)
-			{
-				if(immediateEvaluation == false)
-				{
-					//we are working with variables
-					std::printf("	r%llu = ", gExprStackSize++);
-					ParserExprTokenPrint(postfixResult[i]);
-					std::printf("\n");
-				}
-				else
-				{
-					gExprStackSize++;
-				}
-			}
-			else
-			{
-				return Error(Error::Type::Syntax, "Expression is too complex");
-			}
+			typeStack.push_back(this->exprTokenType(postfixResult[i]));
+			valueStack.push_back(immediateEvaluation ? IrNone : this->exprOperand(postfixResult[i]));
 		}
 		//if there is operation, pop 2 arguments from the operation stack, do the operation and result push back into the operation stack
 		else if(postfixResult[i].type == Scanner::TokenType::Plus    ||
@@ -275,7 +770,7 @@ Error Parser::expr(bool resOnStack)
 		{
 			if(operationStack.size() < 2)
 			{
-				return Error(Error::Type::Syntax, "Expected 2 arguments for operation");
+				return Error(Error::Code::OperationArguments, exprOffset);
 			}
 
 			//pop second argument
@@ -285,397 +780,107 @@ Error Parser::expr(bool resOnStack)
 			Scanner::Token fir_op = operationStack.back();
 			operationStack.pop_back();
 
-			//TODO: do this better
+			//operands are converted to the type with higher rank
+			Parser::ValueType sec_type = typeStack.back();
+			typeStack.pop_back();
+			Parser::ValueType fir_type = typeStack.back();
+			typeStack.pop_back();
+
+			IrId sec_value = valueStack.back();
+			valueStack.pop_back();
+			IrId fir_value = valueStack.back();
+			valueStack.pop_back();
+
+			//integer literal in byte range doesn't promote byte operation
+			if(fir_type == Parser::ValueType::Byte && sec_op.type == Scanner::TokenType::Int && (u64)sec_op.attribute.litInt <= 0xff)
+			{
+				sec_type = Parser::ValueType::Byte;
+			}
+			if(sec_type == Parser::ValueType::Byte && fir_op.type == Scanner::TokenType::Int && (u64)fir_op.attribute.litInt <= 0xff)
+			{
+				fir_type = Parser::ValueType::Byte;
+			}
+
+			Parser::ValueType type     = fir_type > sec_type ? fir_type : sec_type;
+
+			//comparison results in integer
+			bool comparison = postfixResult[i].type != Scanner::TokenType::Plus && postfixResult[i].type != Scanner::TokenType::Minus &&
+			                  postfixResult[i].type != Scanner::TokenType::Mul  && postfixResult[i].type != Scanner::TokenType::Div;
+
 			//if both operands are constants, we can immediately evaluate the operation in compile time
 			if((fir_op.type == Scanner::TokenType::Int || fir_op.type == Scanner::TokenType::Float) && 
 			   (sec_op.type == Scanner::TokenType::Int || sec_op.type == Scanner::TokenType::Float) && immediateEvaluation)
 			{
-				switch(postfixResult[i].type)
+				Scanner::Token result;
+				if(!ParserExprFold(ParserExprOpcode(postfixResult[i].type), fir_op, sec_op, result))
 				{
-					case Scanner::TokenType::Plus: 
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litInt + sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litFloat + sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt + sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litFloat + sec_op.attribute.litFloat;
-							}
-						}
-						break; 
-					}
-					case Scanner::TokenType::Minus: 
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litInt - sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litFloat - sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt - sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litFloat - sec_op.attribute.litFloat;
-							}
-						}
-						break; 
-					}
-					case Scanner::TokenType::Mul: 
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litInt * sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litFloat * sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt * sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litFloat * sec_op.attribute.litFloat;
-							}
-						}
-
-						break; 
-					}
-					case Scanner::TokenType::Div: 
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								if(sec_op.attribute.litFloat == 0.0) { return Error(Error::Type::Syntax, "Cannot divide by zero"); }
-
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litInt / sec_op.attribute.litFloat;
-							}
-							else
-							{
-								if(sec_op.attribute.litInt == 0) { return Error(Error::Type::Syntax, "Cannot divide by zero"); }
-
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litFloat / sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								if(sec_op.attribute.litInt == 0.0) { return Error(Error::Type::Syntax, "Cannot divide by zero"); }
-
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt / sec_op.attribute.litInt;
-							}
-							else
-							{
-								if(sec_op.attribute.litFloat == 0) { return Error(Error::Type::Syntax, "Cannot divide by zero"); }
-
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Float));
-								operationStack[operationStack.size() - 1].attribute.litFloat = fir_op.attribute.litFloat / sec_op.attribute.litFloat;
-							}
-						}
-						break;
-					}
-					case Scanner::TokenType::Less: 
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt < sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat < sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt < sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat < sec_op.attribute.litFloat;
-							}
-						}
-						break; 
-					}
-					case Scanner::TokenType::LessEqu:
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt <= sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat <= sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt <= sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat <= sec_op.attribute.litFloat;
-							}
-						}
-						break; 
-					}
-					case Scanner::TokenType::More:
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt > sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat > sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt > sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat > sec_op.attribute.litFloat;
-							}
-						}
-						break; 
-					}
-					case Scanner::TokenType::MoreEqu:
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt >= sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat >= sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt >= sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat >= sec_op.attribute.litFloat;
-							}
-						}
-						break; 
-					}
-					case Scanner::TokenType::Equ:
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt == sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat == sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt == sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat == sec_op.attribute.litFloat;
-							}
-						}
-						break; 
-					}
-					case Scanner::TokenType::NonEqu:
-					{ 
-						if(fir_op.type != sec_op.type)
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt != sec_op.attribute.litFloat;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat != sec_op.attribute.litInt;
-							}
-						}
-						else
-						{
-							if(fir_op.type == Scanner::TokenType::Int)
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litInt != sec_op.attribute.litInt;
-							}
-							else
-							{
-								operationStack.push_back(Scanner::Token(Scanner::TokenType::Int));
-								operationStack[operationStack.size() - 1].attribute.litInt = fir_op.attribute.litFloat != sec_op.attribute.litFloat;
-							}
-						}
-						break; 
-					}
-					default: 
-					{ 
-						return Error(Error::Type::Syntax, "Unexpected operator between constants");
-						break; 
-					}
+					return Error(Error::Code::DivisionByZero, exprOffset);
 				}
+				operationStack.push_back(result);
 
-				gExprStackSize--;
+				typeStack.push_back(operationStack.back().type == Scanner::TokenType::Float ? Parser::ValueType::Float : Parser::ValueType::Int);
+				valueStack.push_back(IrNone);
 			}
 			//we evaluating operation baby!
 			else
 			{
-				//check if we have enough registers
-				if((gExprStackSize - 2) < ARCH_REG_NUM)
-				{
-					//result register
-					std::printf("	r%llu = ", (gExprStackSize - 2));
-
-					//first argument register
-					std::printf("r%llu", (gExprStackSize - 2));
-					//operation
-					ParserExprTokenPrint(postfixResult[i]);
-					//second argument register
-					if((gExprStackSize - 1) < ARCH_REG_NUM)
-					{
-						std::printf("r%llu", (gExprStackSize - 1));
-					}
-					else
-					{
-						return Error(Error::Type::Syntax, "Expression is too complex");
-					}
-					std::printf("\n");
-				}
-				else
-				{
-					return Error(Error::Type::Syntax, "Expression is too complex");
-				}
+				//convert operands
+				fir_value = this->exprCoerce(fir_value, fir_op, fir_type, type);
+				sec_value = this->exprCoerce(sec_value, sec_op, sec_type, type);
+
+				//result = operation of first and second argument
+				IrId value = this->pCode->binary(ParserExprOpcode(postfixResult[i].type), (IrType)type, fir_value, sec_value);
 
 				//we push uncertain result
 				operationStack.push_back(Scanner::Token(Scanner::TokenType::Acc));
-
-				//we poped 2 and will push 1 -> -1
-				gExprStackSize--;
+				typeStack.push_back(comparison ? Parser::ValueType::Int : type);
+				valueStack.push_back(value);
 			}
 		}
 	}
 
-	//if necessary, assign the expression result
-	if(immediateEvaluation == true)
+	//every operator consumed two values
+	if(operationStack.size() != 1)
+	{
+		return Error(Error::Code::OperationArguments, exprOffset);
+	}
+
+	//convert result to the expected type
+	Parser::ValueType type  = typeStack[0];
+	IrId              value = valueStack[0];
+	if(target != Parser::ValueType::None && target != type)
 	{
-		if(resOnStack == true)
+		//float constant out of integer range is converted at runtime
+		if(immediateEvaluation == true && !ParserExprConstConvert(operationStack[0], target))
 		{
-			std::printf("	push(");
-			ParserExprTokenPrint(operationStack[0]);
-			std::printf(")\n");
+			immediateEvaluation = false;
 		}
-		else
+		if(immediateEvaluation == false)
 		{
-			std::printf("r0 = ");
-			ParserExprTokenPrint(operationStack[0]);
-			std::printf("\n");
+			value = this->exprCoerce(value, operationStack[0], type, target);
 		}
+		type = target;
 	}
-	else
+	this->pExprType = type;
+
+	//value of immediate constant is known to the compiler, instruction is created when it is used
+	this->pExprConstant = immediateEvaluation;
+	this->pExprResult   = immediateEvaluation ? IrNone : value;
+	if(immediateEvaluation == true)
 	{
-		if(resOnStack == true)
-		{
-			std::printf("	push(r0)\n");
-		}
+		this->pExprValue = operationStack[0];
+	}
+
+	//argument of function call
+	if(resOnStack == true && this->pCalls.size() != 0)
+	{
+		this->pCalls.back().values.push_back(this->exprValue());
 	}
 
 	//check bracket balance
 	if(ParserExprBracketBalance != 0)
 	{
-		return Error(Error::Type::Syntax, "Invalid balance of parentheses");
+		return Error(Error::Code::BracketBalance, exprOffset);
 	}
 
 	return Error(Error::Type::Ok);
@@ -0,0 +1,247 @@
+#include "Parser.hpp"
+#include "ThreadPool.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * \brief record function body for worker thread and skip it
+ * \note the lookahead token is the first token of the body
+ */
+Error Parser::skipBody()
+{
+	//close current output segment, reserve a slot for the body and continue in a new segment
+	this->pSegments.push_back(this->pEmitter);
+
+	BodyJob job;
+	job.name    = this->pCurrFunctionName;
+	job.offset  = this->pToken.offset;
+	job.segment = this->pSegments.size();
+
+	this->pSegments.push_back(nullptr);
+	this->pBodyJobs.push_back(job);
+	this->pEmitter = this->pEmitter->segment();
+
+	//skip tokens up to and including the matching right curly bracket,
+	//the body parser will report what is wrong with the body
+	u64 depth = 1;
+	while(depth != 0 && this->pToken.type != Scanner::TokenType::Eof)
+	{
+		if(this->pToken.type == Scanner::TokenType::LeftCurlyBracket)
+		{
+			depth++;
+		}
+		else if(this->pToken.type == Scanner::TokenType::RightCurlyBracket)
+		{
+			depth--;
+		}
+
+		this->pPrevToken = std::move(this->pToken);
+		this->pToken     = this->nextToken();
+	}
+
+	return Error(Error::Type::Ok);
+}
+
+/**
+ * \brief parse function bodies in parallel or lazily
+ * \note first pass processes global declarations and records source offsets of bodies,
+ *       bodies are then scanned again and parsed by worker parsers against read-only global tables
+ */
+Error Parser::parseParallel()
+{
+	this->pToken = this->nextToken();
+
+	//producer failed before publishing anything (preprocessor error)
+	if(!this->pPrepared)
+	{
+		return Error(Error::Type::Lexical);
+	}
+
+	//first pass over global declarations and function signatures
+	//output is collected in segments and written in source order at the end
+	Emitter* output   = this->pEmitter;
+	this->pEmitter    = output->segment();
+	this->pSkipBodies = true;
+
+	Error result = this->derive(ParserRule::Prog);
+
+	this->pSegments.push_back(this->pEmitter);
+	this->pEmitter    = output;
+	this->pSkipBodies = false;
+
+	//index bodies by function name
+	std::unordered_map<std::string, u64> bodies;
+	for(u64 i = 0; i < this->pBodyJobs.size(); i++)
+	{
+		bodies[this->pBodyJobs[i].name] = i;
+	}
+
+	//lazy compilation starts at main and at functions called by global initializers,
+	//without main (library) or in eager mode every body is requested
+	auto request = [this, &bodies](const std::vector<std::string>& names)
+	{
+		for(const std::string& name : names)
+		{
+			auto it = bodies.find(name);
+			if(it != bodies.end())
+			{
+				this->pBodyJobs[it->second].requested = true;
+			}
+		}
+	};
+
+	if(this->pLazy && bodies.find("main") != bodies.end())
+	{
+		request({ "main" });
+		request(this->pReferenced);
+	}
+	else
+	{
+		for(BodyJob& job : this->pBodyJobs)
+		{
+			job.requested = true;
+		}
+	}
+
+	//the whole preprocessed source was written before scanning, workers scan their bodies
+	//from its read-only mapping, so no tokens are kept between the passes
+	struct stat st;
+	char*       source = nullptr;
+	u64         size   = 0;
+	if(!this->pBodyJobs.empty() && fstat(fileno(this->pIn), &st) == 0 && st.st_size > 0)
+	{
+		void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(this->pIn), 0);
+		if(base != MAP_FAILED)
+		{
+			source = (char*)base;
+			size   = st.st_size;
+		}
+	}
+
+	//parse requested bodies against the global tables,
+	//every wave compiles bodies referenced by the previous one
+	{
+		ThreadPool pool(this->pJobs);
+
+		while(true)
+		{
+			std::vector<BodyJob*> wave;
+			for(BodyJob& job : this->pBodyJobs)
+			{
+				if(job.requested && !job.compiled)
+				{
+					job.compiled = true;
+					wave.push_back(&job);
+				}
+			}
+
+			if(wave.size() == 0)
+			{
+				break;
+			}
+
+			for(BodyJob* job : wave)
+			{
+				pool.submit([this, job, source, size]()
+				{
+					FILE* in = source != nullptr ? fmemopen(source, size, "r") : nullptr;
+					if(in == nullptr || std::fseek(in, job->offset, SEEK_SET) != 0)
+					{
+						job->result = Error(Error::Type::Lexical);
+						if(in != nullptr)
+						{
+							std::fclose(in);
+						}
+						return;
+					}
+
+					Parser worker;
+					worker.pScanner          = Scanner(in, job->offset);
+					worker.pGlobal           = this;
+					worker.pVisible          = job->offset;
+					worker.pSink             = this->pSink;
+					worker.pTarget           = this->pTarget;
+					worker.pEmitter          = this->pEmitter->segment();
+					worker.pScope            = 1;
+					worker.pLazy             = this->pLazy;
+					worker.pUnrollFactor     = this->pUnrollFactor;
+					worker.pMaxErrors        = this->pMaxErrors;
+					worker.pCurrFunctionName       = job->name;
+					worker.pCurrFunctionReturnType = this->findFunction(job->name)->retType;
+
+					//arguments were already checked by the first pass
+					for(const FunctionItem::Arg& arg : this->findFunction(job->name)->args)
+					{
+						worker.pVariables[arg.name] = VariableItem();
+						worker.pVariables[arg.name].varType = arg.type;
+						worker.pVariables[arg.name].scope   = 1;
+						if(arg.type == Parser::VarType::Pack)
+						{
+							worker.pVariables[arg.name].pack   = arg.pack;
+							worker.pVariables[arg.name].scalar = true;
+						}
+					}
+
+					Diagnostics::use(&job->diagnostics);
+					worker.pToken = worker.nextToken();
+					worker.bodyBegin();
+					job->result   = worker.derive(ParserRule::Body);
+					worker.bodyEnd();
+					this->pSegments[job->segment] = worker.pEmitter;
+					Diagnostics::use(nullptr);
+					std::fclose(in);
+
+					job->referenced = std::move(worker.pReferenced);
+				});
+			}
+
+			pool.wait();
+
+			for(BodyJob* job : wave)
+			{
+				request(job->referenced);
+			}
+		}
+	}
+
+	//output in source order, diagnostics of all bodies are collected
+	//and only the first errors in source order are reported like in sequential parsing
+	u64 job = 0;
+	for(u64 i = 0; i < this->pSegments.size(); i++)
+	{
+		if(this->pSegments[i] != nullptr)
+		{
+			this->pEmitter->merge(*this->pSegments[i]);
+		}
+
+		if(job < this->pBodyJobs.size() && this->pBodyJobs[job].segment == i)
+		{
+			if(!this->pBodyJobs[job].compiled)
+			{
+				this->emit("Skip body of unreferenced function \"%s\"\n", this->pBodyJobs[job].name.c_str());
+			}
+			else if(this->pBodyJobs[job].result.type != Error::Type::Ok && result.type == Error::Type::Ok)
+			{
+				result = this->pBodyJobs[job].result;
+			}
+			this->pDiagnostics.append(this->pBodyJobs[job].diagnostics);
+			job++;
+		}
+	}
+	this->pDiagnostics.limit(this->pMaxErrors);
+
+	for(Emitter* segment : this->pSegments)
+	{
+		delete segment;
+	}
+	this->pSegments.clear();
+	this->pBodyJobs.clear();
+	this->pReferenced.clear();
+	if(source != nullptr)
+	{
+		munmap(source, size);
+	}
+
+	return result;
+}
@@ -0,0 +1,61 @@
+#include "Parser.hpp"
+
+#include <thread>
+
+/**
+ * \brief producer thread of pipelined parsing, publishes scanned tokens into the ring
+ */
+void Parser::produce()
+{
+	//lexical errors are merged into parser diagnostics after the thread is joined
+	Diagnostics::use(&this->pProducerDiagnostics);
+
+	this->pPrepared = !this->pPrepare || this->pPrepare();
+
+	if(this->pPrepared)
+	{
+		std::fseek(this->pIn, 0, SEEK_SET);
+		this->pScanner = Scanner(this->pIn);
+
+		TokenRing::Batch batch;
+		batch.reserve(ParserPipelineBatchSize);
+
+		bool end = false;
+		while(!end)
+		{
+			batch.push_back(this->pScanner.getToken());
+			end = batch.back().type == Scanner::TokenType::Eof;
+
+			if(end || batch.size() == ParserPipelineBatchSize)
+			{
+				//parser stopped, the rest of the source is not needed
+				if(!this->pRing->push(batch))
+				{
+					break;
+				}
+				batch.clear();
+			}
+		}
+	}
+
+	Diagnostics::use(nullptr);
+	this->pRing->close();
+}
+
+/**
+ * \brief take token from the ring
+ */
+Scanner::Token Parser::ringToken()
+{
+	if(this->pBatchPos == this->pBatch.size())
+	{
+		//the last batch ends with EOF, it is repeated after the ring is closed
+		if(!this->pRing->pop(this->pBatch))
+		{
+			return this->pBatch.empty() ? Scanner::Token(Scanner::TokenType::Eof) : this->pBatch.back();
+		}
+		this->pBatchPos = 0;
+	}
+
+	return std::move(this->pBatch[this->pBatchPos++]);
+}
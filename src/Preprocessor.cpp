@@ -4,6 +4,79 @@
 //variables
 static std::unordered_map<std::string, std::string> gVariables;
 
+/**
+ * \brief read and return back character of input, position in the input is tracked
+ */
+int Preprocessor::get()
+{
+	//files are accessed only by the thread running the preprocessor
+	int c = getc_unlocked(this->pIn);
+
+	this->pPrevColumn = this->pColumn;
+	if(c == '\n')
+	{
+		this->pLine++;
+		this->pColumn = 1;
+	}
+	else if(c != EOF)
+	{
+		this->pColumn++;
+	}
+	return c;
+}
+
+void Preprocessor::unget(int c)
+{
+	if(c == EOF)
+	{
+		return;
+	}
+
+	ungetc(c, this->pIn);
+	if(c == '\n')
+	{
+		this->pLine--;
+	}
+	this->pColumn = this->pPrevColumn;
+}
+
+/**
+ * \brief write into output
+ */
+void Preprocessor::put(int c)
+{
+	putc_unlocked(c, this->pOut);
+	if(this->pMap != nullptr)
+	{
+		this->pMap->size++;
+	}
+}
+
+void Preprocessor::put(const std::string& s)
+{
+	fwrite(s.c_str(), 1, s.size(), this->pOut);
+	if(this->pMap != nullptr)
+	{
+		this->pMap->size += s.size();
+	}
+}
+
+/**
+ * \brief output written from now on comes from the current position in the input
+ */
+void Preprocessor::mark()
+{
+	this->mark(this->pLine, this->pColumn);
+}
+
+void Preprocessor::mark(u32 line, u32 column)
+{
+	if(this->pMap != nullptr)
+	{
+		this->pMap->mark(this->pFile, line, column);
+	}
+}
+
 /**
  * \brief check type of command
  */
@@ -32,11 +105,14 @@ void Preprocessor::parseId(std::string& id)
 
 	if(it == gVariables.end())
 	{
-		fwrite(id.c_str(), 1, id.size(), this->pOut);
+		this->put(id);
 	}
 	else
 	{
-		fwrite(it->second.c_str(), 1, it->second.size(), this->pOut);
+		//text of macro is at the position of its name (the input is just after the name)
+		this->mark(this->pLine, this->pColumn - (u32)id.size());
+		this->put(it->second);
+		this->mark();
 	}
 }
 
@@ -61,7 +137,7 @@ Preprocessor::Token Preprocessor::getToken()
 	//main scanner loop
 	while(true)
 	{
-		charBuffer = fgetc(this->pIn);
+		charBuffer = this->get();
 
 		switch(this->pState)
 		{
@@ -82,7 +158,7 @@ Preprocessor::Token Preprocessor::getToken()
 				}
 				else
 				{
-					fputc(charBuffer, this->pOut);
+					this->put(charBuffer);
 					this->pState = Preprocessor::State::Start;
 				}
 
@@ -170,7 +246,7 @@ Preprocessor::Token Preprocessor::getToken()
 				}
 				else
 				{
-					ungetc(charBuffer, this->pIn);
+					this->unget(charBuffer);
 					this->pState = Preprocessor::State::DefVarId;
 				}
 
@@ -211,7 +287,7 @@ Preprocessor::Token Preprocessor::getToken()
 				}
 				else
 				{
-					ungetc(charBuffer, this->pIn);
+					this->unget(charBuffer);
 					this->pState = Preprocessor::State::DefVarValue;
 				}
 
@@ -242,7 +318,7 @@ Preprocessor::Token Preprocessor::getToken()
 				}
 				else
 				{
-					ungetc(charBuffer, this->pIn);
+					this->unget(charBuffer);
 					this->parseId(pBuffer);
 					return t;
 				}
@@ -253,13 +329,24 @@ Preprocessor::Token Preprocessor::getToken()
 	}
 }
 
-bool Preprocessor::preprocess(FILE* in, FILE* out)
+bool Preprocessor::preprocess(FILE* in, FILE* out, const std::string& name)
 {
 	this->pIn  = in;
 	this->pOut = out;
 
 	this->pState = Preprocessor::State::Start;
 
+	this->pFile       = 0;
+	this->pLine       = 1;
+	this->pColumn     = 1;
+	this->pPrevColumn = 1;
+	if(this->pMap != nullptr)
+	{
+		this->pFile = (u32)this->pMap->files.size();
+		this->pMap->files.push_back(name);
+	}
+	this->mark();
+
 	do
 	{
 		try
@@ -287,15 +374,26 @@ bool Preprocessor::preprocess(FILE* in, FILE* out)
 			}
 
 			Preprocessor* inc_preprocessor = new Preprocessor();
-			inc_preprocessor->preprocess(inc, out);
+			inc_preprocessor->setSourceMap(this->pMap);
+			bool included = inc_preprocessor->preprocess(inc, out, this->pToken.arg);
 			delete inc_preprocessor;
 
 			fclose(inc);
+			if(!included)
+			{
+				return false;
+			}
+
+			//the rest of the file continues after the include command
+			this->mark();
 		}
 		else if(this->pToken.type == Preprocessor::TokenType::Def)
 		{
 			std::printf("prep: %s = %s\n", this->pToken.arg.c_str(), this->pToken.arg2.c_str());
 			gVariables[this->pToken.arg] = this->pToken.arg2;
+
+			//definition is not copied into output
+			this->mark();
 		}
 	} while(true);
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "types.hpp"
+#include "SourceMap.hpp"
+
 #include <string>
 #include <unordered_map>
 #include <cstdio>
@@ -11,12 +14,17 @@ class Preprocessor
 {
 public:
 
-	Preprocessor() {}
+	Preprocessor() { this->pMap = nullptr; }
 
 	/**
 	 * \brief main preprocess function
+	 * \note name of input file is recorded in source map
+	 */
+	bool preprocess(FILE* in, FILE* out, const std::string& name);
+	/**
+	 * \brief record positions of output in source files (shared by preprocessors of included files)
 	 */
-	bool preprocess(FILE* in, FILE* out);
+	void setSourceMap(SourceMap* map) { this->pMap = map; }
 
 private:
 
@@ -76,9 +84,32 @@ private:
 	 */
 	Token     getToken();
 
+	/**
+	 * \brief read and return back character of input, position in the input is tracked
+	 */
+	int       get();
+	void      unget(int c);
+	/**
+	 * \brief write into output
+	 */
+	void      put(int c);
+	void      put(const std::string& s);
+	/**
+	 * \brief output written from now on comes from the current position in the input
+	 */
+	void      mark();
+	void      mark(u32 line, u32 column);
+
 	//input/output
 	FILE* pIn;
 	FILE* pOut;
+
+	//positions of output in source files, index of input file name and position in the input
+	SourceMap* pMap;
+	u32        pFile;
+	u32        pLine;
+	u32        pColumn;
+	u32        pPrevColumn;
 };
 
 
@@ -0,0 +1,853 @@
+#include "Regalloc.hpp"
+
+#include <algorithm>
+
+/**
+ * \brief instruction without side effects which can be moved to its user
+ */
+static bool RegallocMovable(IrOp op)
+{
+	switch(op)
+	{
+		case IrOp::Const: case IrOp::Undef: case IrOp::Str:
+		case IrOp::Add:   case IrOp::Sub:   case IrOp::Mul: case IrOp::Div:
+		case IrOp::Shl:   case IrOp::Shr:   case IrOp::Sar: case IrOp::MulHi:
+		case IrOp::Lt:    case IrOp::Le:    case IrOp::Gt:  case IrOp::Ge:
+		case IrOp::Eq:    case IrOp::Ne:    case IrOp::Cvt: { return true; }
+		default:                                            { return false; }
+	}
+}
+
+/**
+ * \brief value is used as immediate operand, it needs no register
+ */
+static bool RegallocImmediate(IrOp op)
+{
+	return op == IrOp::Const || op == IrOp::Undef || op == IrOp::Str;
+}
+
+/**
+ * \brief class of registers holding value (0 integers, 1 floats)
+ */
+static u32 RegallocClass(const Codegen& code, IrId value)
+{
+	return code.valueType(value) == IrType::F64 ? 1 : 0;
+}
+
+/**
+ * \brief registers of class of the target, registers of both classes are numbered together
+ *        from the first integer register, float registers follow
+ */
+template<u32 T>
+static constexpr const TargetRegClass& RegallocRegs(u32 cls)
+{
+	return cls == 0 ? Targets[T].ints : Targets[T].floats;
+}
+
+template<u32 T>
+static constexpr u32 RegallocBase(u32 cls)
+{
+	return cls == 0 ? 0 : Targets[T].ints.count;
+}
+
+/**
+ * \brief location of register (float register is IrFloat | index in its class)
+ */
+template<u32 T>
+static constexpr u32 RegallocLocation(u32 reg)
+{
+	return reg < Targets[T].ints.count ? reg : IrFloat | (reg - Targets[T].ints.count);
+}
+
+/**
+ * \brief schedule expression trees and assign locations to all values of the function
+ */
+void Regalloc::run(Codegen& code, const Target& target)
+{
+	static constexpr std::array<Run, TargetCount> instances = Regalloc::runs(std::make_index_sequence<TargetCount>());
+	(this->*instances[&target - Targets])(code);
+}
+
+template<u32 T>
+void Regalloc::runTarget(Codegen& code)
+{
+	this->pCode = &code;
+	this->pSpilled.clear();
+
+	this->pUses.assign(code.instCount(), 0);
+	this->pUser.assign(code.instCount(), IrNone);
+	this->pNeed[0].assign(code.instCount(), 0);
+	this->pNeed[1].assign(code.instCount(), 0);
+
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(!code.live(b))
+		{
+			continue;
+		}
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			for(u32 o = 0; o < code.inst(i).count; o++)
+			{
+				IrId v = code.operand(i, o);
+				if(v != IrNone)
+				{
+					this->pUses[v]++;
+					this->pUser[v] = i;
+				}
+			}
+		}
+	}
+
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(!code.live(b))
+		{
+			continue;
+		}
+
+		//operands of tree node precede it in the block, so their numbers are already known
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			this->label(i);
+		}
+
+		//roots are kept in place, trees are evaluated just before their root
+		this->pOrder.clear();
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			if(!this->owned(i))
+			{
+				this->evaluate(i, false);
+			}
+		}
+		code.schedule(b, this->pOrder.data(), this->pOrder.size());
+	}
+
+	this->intervals<T>();
+	this->scan<T>();
+	this->frame<T>();
+}
+
+/**
+ * \brief value lives across its tree and gets register or stack slot by linear scan
+ */
+bool Regalloc::crosses(IrId value) const
+{
+	const IrInst& inst = this->pCode->inst(value);
+
+	//results of package call are taken by result instructions
+	return this->pUses[value] != 0 && !this->owned(value) && !RegallocImmediate(inst.op) &&
+	       !(inst.op == IrOp::Call && inst.type == IrType::None);
+}
+
+/**
+ * \brief live range of every value crossing its tree
+ * \note positions follow blocks in order of the function, range is the hull of def, uses and of blocks
+ *       where the value is live. Blocks where the value is live are found by walking predecessors
+ *       from every use up to the defining block (operand of phi is used at the end of predecessor).
+ */
+template<u32 T>
+void Regalloc::intervals()
+{
+	const Codegen& code = *this->pCode;
+
+	this->pPos.assign(code.instCount(), 0);
+	this->pBlockStart.assign(code.blockCount(), 0);
+	this->pBlockEnd.assign(code.blockCount(), 0);
+	this->pVisit.assign(code.blockCount(), IrNone);
+	this->pStart.assign(code.instCount(), 0);
+	this->pEnd.assign(code.instCount(), 0);
+	this->pCalls.clear();
+	this->pOutgoing = 0;
+
+	u32 pos = 0;
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(!code.live(b))
+		{
+			continue;
+		}
+		this->pBlockStart[b] = pos;
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			if(code.inst(i).op == IrOp::Call)
+			{
+				//arguments beyond argument registers of their class are passed on the stack
+				u64 stack = 0;
+				for(u32 o = 0; o < code.inst(i).count; o++)
+				{
+					stack += o >= RegallocRegs<T>(RegallocClass(code, code.operand(i, o))).args ? 1 : 0;
+				}
+				this->pCalls.push_back(pos);
+				this->pOutgoing = std::max(this->pOutgoing, stack * Targets[T].word);
+			}
+			this->pPos[i] = pos++;
+		}
+		this->pBlockEnd[b] = pos - 1;
+	}
+
+	//uses grouped by value
+	this->pUseStart.assign(code.instCount() + 1, 0);
+	for(IrId v = 0; v < code.instCount(); v++)
+	{
+		this->pUseStart[v + 1] = this->pUseStart[v] + this->pUses[v];
+	}
+	this->pUseList.resize(this->pUseStart[code.instCount()]);
+	std::vector<u32>& fill = this->pWork;
+	fill.assign(this->pUseStart.begin(), this->pUseStart.end() - 1);
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(!code.live(b))
+		{
+			continue;
+		}
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			for(u32 o = 0; o < code.inst(i).count; o++)
+			{
+				IrId v = code.operand(i, o);
+				if(v != IrNone)
+				{
+					this->pUseList[fill[v]++] = { i, o };
+				}
+			}
+		}
+	}
+
+	for(IrId v = 0; v < code.instCount(); v++)
+	{
+		if(!code.live(code.inst(v).block) || !this->crosses(v))
+		{
+			continue;
+		}
+
+		IrId def   = code.inst(v).block;
+		u32  start = this->pPos[v];
+		u32  end   = this->pPos[v];
+
+		this->pBlocks.clear();
+		auto live = [this, def, v](IrId block)
+		{
+			if(block != def && this->pVisit[block] != v)
+			{
+				this->pVisit[block] = v;
+				this->pBlocks.push_back(block);
+			}
+		};
+
+		for(u32 u = this->pUseStart[v]; u < this->pUseStart[v + 1]; u++)
+		{
+			const Use&    use  = this->pUseList[u];
+			const IrInst& user = code.inst(use.inst);
+
+			if(user.op == IrOp::Phi)
+			{
+				u32 edge = code.block(user.block).preds;
+				for(u32 k = 0; k < use.operand; k++)
+				{
+					edge = code.edgeNext(edge);
+				}
+				IrId pred = code.edgeFrom(edge);
+				end = std::max(end, this->pBlockEnd[pred]);
+				live(pred);
+			}
+			else
+			{
+				end = std::max(end, this->pPos[use.inst]);
+				live(user.block);
+			}
+		}
+
+		//value is live at the start of these blocks and at the end of their predecessors
+		while(this->pBlocks.size() != 0)
+		{
+			IrId block = this->pBlocks.back();
+			this->pBlocks.pop_back();
+
+			start = std::min(start, this->pBlockStart[block]);
+			for(u32 e = code.block(block).preds; e != IrNone; e = code.edgeNext(e))
+			{
+				IrId pred = code.edgeFrom(e);
+				end = std::max(end, this->pBlockEnd[pred]);
+				live(pred);
+			}
+		}
+
+		this->pStart[v] = start;
+		this->pEnd[v]   = end;
+	}
+}
+
+/**
+ * \brief linear scan over the function
+ * \note values are allocated in order of start of their ranges, one register is always left
+ *       for expression trees, trees get every register which is not held by a live value.
+ *       When registers run out, the value whose range ends last is spilled into stack slot
+ *       for its whole range. Classes of registers are allocated independently.
+ */
+template<u32 T>
+void Regalloc::scan()
+{
+	const Codegen& code = *this->pCode;
+
+	this->pActive.clear();
+	this->pActiveCount[0] = 0;
+	this->pActiveCount[1] = 0;
+	this->pHolder.assign(Targets[T].ints.count + Targets[T].floats.count, IrNone);
+	this->pRegister.assign(code.instCount(), IrNone);
+	this->pSorted.clear();
+	for(IrId v = 0; v < code.instCount(); v++)
+	{
+		if(code.live(code.inst(v).block) && this->crosses(v))
+		{
+			this->pSorted.push_back(v);
+		}
+	}
+	std::stable_sort(this->pSorted.begin(), this->pSorted.end(), [this](IrId a, IrId b)
+	{
+		return this->pStart[a] < this->pStart[b];
+	});
+	u32 next = 0;
+
+	//start of the tree whose nodes precede the current root
+	u32  tree = 0;
+	bool open = false;
+
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(!code.live(b))
+		{
+			continue;
+		}
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			if(this->owned(i))
+			{
+				if(!open)
+				{
+					tree = this->pPos[i];
+					open = true;
+				}
+				continue;
+			}
+
+			//values live at the start of the tree hold their registers during the tree
+			u32 span = open ? tree : this->pPos[i];
+			open     = false;
+			while(next < this->pSorted.size() && this->pStart[this->pSorted[next]] <= span && this->pSorted[next] != i)
+			{
+				this->allocate<T>(this->pSorted[next++], span);
+			}
+
+			//registers which are not held by live values
+			this->expire(span);
+			for(u32 c = 0; c < 2; c++)
+			{
+				this->pFree[c].clear();
+				for(u32 r = RegallocBase<T>(c); r < RegallocBase<T>(c) + RegallocRegs<T>(c).count; r++)
+				{
+					if(this->held(r) == IrNone)
+					{
+						this->pFree[c].push_back(RegallocLocation<T>(r));
+					}
+				}
+			}
+			this->evaluate(i, true);
+
+			//operands used for the last time by the root are free for its result
+			while(next < this->pSorted.size() && this->pStart[this->pSorted[next]] <= this->pPos[i])
+			{
+				this->allocate<T>(this->pSorted[next++], this->pPos[i]);
+			}
+		}
+	}
+}
+
+/**
+ * \brief register or stack slot for value whose range starts at position
+ * \note register of calling convention is taken when it is free, otherwise the lowest free one
+ *       of the class of value. Value live across call can use only registers preserved by callee.
+ */
+template<u32 T>
+void Regalloc::allocate(IrId value, u32 pos)
+{
+	this->expire(pos);
+
+	u32                   cls   = RegallocClass(*this->pCode, value);
+	const TargetRegClass& regs  = RegallocRegs<T>(cls);
+	u32                   first = RegallocBase<T>(cls) + (this->clobbered(value) ? regs.saved : 0);
+	u32                   end   = RegallocBase<T>(cls) + regs.count;
+	if(this->pActiveCount[cls] + 1 < regs.count)
+	{
+		u32 r = this->hint<T>(value);
+		if(r < first || r >= end || this->held(r) != IrNone)
+		{
+			r = first;
+			while(r < end && this->held(r) != IrNone)
+			{
+				r++;
+			}
+		}
+		if(r < end)
+		{
+			this->pCode->locate(value, RegallocLocation<T>(r));
+			this->pRegister[value] = r;
+			this->pActive.push_back(value);
+			this->pActiveCount[cls]++;
+			this->pHolder[r] = value;
+			return;
+		}
+	}
+
+	u32 victim = IrNone;
+	for(u32 a = 0; a < this->pActive.size(); a++)
+	{
+		u32 r = this->pRegister[this->pActive[a]];
+		if(r >= first && r < end && (victim == IrNone || this->pEnd[this->pActive[a]] > this->pEnd[this->pActive[victim]]))
+		{
+			victim = a;
+		}
+	}
+	if(victim != IrNone && this->pEnd[this->pActive[victim]] > this->pEnd[value])
+	{
+		u32 r = this->pRegister[this->pActive[victim]];
+		this->pCode->locate(value, RegallocLocation<T>(r));
+		this->pRegister[value] = r;
+		this->pHolder[r]       = value;
+		this->spill(this->pActive[victim]);
+		this->pActive[victim] = value;
+	}
+	else
+	{
+		this->spill(value);
+	}
+}
+
+/**
+ * \brief release registers of values whose range ends before position
+ */
+void Regalloc::expire(u32 pos)
+{
+	u32 keep = 0;
+	for(IrId v : this->pActive)
+	{
+		if(this->pEnd[v] >= pos)
+		{
+			this->pActive[keep++] = v;
+		}
+		else
+		{
+			this->pHolder[this->pRegister[v]] = IrNone;
+			this->pActiveCount[RegallocClass(*this->pCode, v)]--;
+		}
+	}
+	this->pActive.resize(keep);
+}
+
+/**
+ * \brief live value held in register (IrNone when free)
+ */
+IrId Regalloc::held(u32 reg) const
+{
+	return this->pHolder[reg];
+}
+
+/**
+ * \brief register where calling convention expects value (IrNone when there is none)
+ * \note arguments and results come in registers of their class at their position, value passed
+ *       to call or returned is wanted in the register of its operand
+ */
+template<u32 T>
+u32 Regalloc::hint(IrId value) const
+{
+	const Codegen&        code = *this->pCode;
+	const IrInst&         inst = code.inst(value);
+	u32                   cls  = RegallocClass(code, value);
+	const TargetRegClass& regs = RegallocRegs<T>(cls);
+	u32                   base = RegallocBase<T>(cls);
+
+	switch(inst.op)
+	{
+		case IrOp::Arg:    { return inst.imm.i < regs.args ? base + (u32)inst.imm.i : IrNone; }
+		case IrOp::Call:   { return base; }
+		case IrOp::Result: { return inst.imm.i < regs.count ? base + (u32)inst.imm.i : IrNone; }
+		default:           { break; }
+	}
+
+	for(u32 u = this->pUseStart[value]; u < this->pUseStart[value + 1]; u++)
+	{
+		const Use& use = this->pUseList[u];
+		IrOp       op  = code.inst(use.inst).op;
+		if((op == IrOp::Call || op == IrOp::Ret) && use.operand < regs.args)
+		{
+			return base + use.operand;
+		}
+	}
+	return IrNone;
+}
+
+/**
+ * \brief value is live across call which can change registers not preserved by callee
+ */
+bool Regalloc::clobbered(IrId value) const
+{
+	auto call = std::upper_bound(this->pCalls.begin(), this->pCalls.end(), this->pStart[value]);
+	return call != this->pCalls.end() && *call < this->pEnd[value];
+}
+
+/**
+ * \brief value is tree node evaluated just before its only user
+ */
+bool Regalloc::owned(IrId value) const
+{
+	const Codegen& code = *this->pCode;
+	IrId           user = this->pUser[value];
+
+	return this->pUses[value] == 1 && RegallocMovable(code.inst(value).op) && code.inst(user).op != IrOp::Phi &&
+	       code.inst(user).block == code.inst(value).block;
+}
+
+/**
+ * \brief compute Sethi-Ullman numbers of tree node
+ * \note number of registers of every class needed to evaluate the node without spilling,
+ *       operands needing more registers are evaluated first while the others wait in registers
+ *       of their class (the same numbers need one more register for the result of the first operand)
+ */
+void Regalloc::label(IrId id)
+{
+	const Codegen& code = *this->pCode;
+	const IrInst&  inst = code.inst(id);
+
+	this->pNeed[0][id] = 0;
+	this->pNeed[1][id] = 0;
+	if(RegallocImmediate(inst.op))
+	{
+		return;
+	}
+
+	IrId children[2];
+	u32  count = 0;
+	for(u32 o = 0; o < inst.count && o < 2; o++)
+	{
+		IrId v = code.operand(id, o);
+		if(v != IrNone && this->owned(v) && !RegallocImmediate(code.inst(v).op))
+		{
+			children[count++] = v;
+		}
+	}
+	if(count == 2 && this->pNeed[0][children[1]] + this->pNeed[1][children[1]] > this->pNeed[0][children[0]] + this->pNeed[1][children[0]])
+	{
+		std::swap(children[0], children[1]);
+	}
+
+	u32 held[2] = { 0, 0 };
+	for(u32 c = 0; c < count; c++)
+	{
+		for(u32 k = 0; k < 2; k++)
+		{
+			this->pNeed[k][id] = std::max(this->pNeed[k][id], held[k] + this->pNeed[k][children[c]]);
+		}
+		held[RegallocClass(code, children[c])]++;
+	}
+	u32 cls = RegallocClass(code, id);
+	this->pNeed[cls][id] = std::max(this->pNeed[cls][id], 1u);
+}
+
+/**
+ * \brief value lives in stack slot, its offset is assigned by frame layout
+ */
+void Regalloc::spill(IrId value)
+{
+	this->pCode->locate(value, IrSlot);
+	this->pSpilled.push_back(value);
+}
+
+/**
+ * \brief frame layout of stack slots and memory of local variables
+ * \note every item is placed at the lowest offset which is not used by items live at the same time,
+ *       so values and variables of disjoint ranges and scopes share memory. Larger items are placed
+ *       first and bytes are packed together behind them.
+ *       Frame starts with arguments of calls passed on the stack and ends with registers
+ *       preserved for the caller.
+ */
+template<u32 T>
+void Regalloc::frame()
+{
+	Codegen& code = *this->pCode;
+
+	this->pItems.clear();
+	this->pRanges.clear();
+
+	for(IrId v : this->pSpilled)
+	{
+		Item item;
+		item.size  = code.valueType(v) == IrType::U8 ? 1 : Targets[T].word;
+		item.align = item.size;
+		item.value = v;
+		item.local = IrNone;
+		item.first = this->pRanges.size();
+		this->pRanges.push_back({ this->pStart[v], this->pEnd[v] });
+		item.count = 1;
+		this->pItems.push_back(item);
+	}
+
+	for(u32 l = 0; l < code.localCount(); l++)
+	{
+		Item item;
+		item.size  = code.local(l).size;
+		item.align = code.local(l).align;
+		item.value = IrNone;
+		item.local = l;
+		item.first = this->pRanges.size();
+
+		//blocks where the scope was open, in order of the function
+		std::vector<IrId>& blocks = this->pBlocks;
+		blocks = code.local(l).blocks;
+		std::sort(blocks.begin(), blocks.end());
+		for(IrId b : blocks)
+		{
+			if(!code.live(b))
+			{
+				continue;
+			}
+			if(this->pRanges.size() > item.first && this->pRanges.back().end + 1 >= this->pBlockStart[b])
+			{
+				this->pRanges.back().end = std::max(this->pRanges.back().end, this->pBlockEnd[b]);
+			}
+			else
+			{
+				this->pRanges.push_back({ this->pBlockStart[b], this->pBlockEnd[b] });
+			}
+		}
+		item.count = this->pRanges.size() - item.first;
+		this->pItems.push_back(item);
+	}
+
+	for(Item& item : this->pItems)
+	{
+		item.start = item.count != 0 ? this->pRanges[item.first].start : 0;
+		item.end   = item.count != 0 ? this->pRanges[item.first + item.count - 1].end : 0;
+	}
+
+	std::vector<u32>& order = this->pWork;
+	order.resize(this->pItems.size());
+	for(u32 i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [this](u32 a, u32 b)
+	{
+		return this->pItems[a].size > this->pItems[b].size;
+	});
+
+	//memory used by placed items live at the same time, sorted by offset
+	u64 size = 0;
+	std::vector<Range>& used = this->pUsed;
+	for(u32 n = 0; n < order.size(); n++)
+	{
+		Item& item = this->pItems[order[n]];
+
+		used.clear();
+		for(u32 m = 0; m < n; m++)
+		{
+			const Item& placed = this->pItems[order[m]];
+			if(this->interfere(item, placed))
+			{
+				used.push_back({ (u32)placed.offset, (u32)(placed.offset + placed.size) });
+			}
+		}
+		std::sort(used.begin(), used.end(), [](const Range& a, const Range& b) { return a.start < b.start; });
+
+		u64 offset = 0;
+		for(const Range& r : used)
+		{
+			if(offset + item.size <= r.start)
+			{
+				break;
+			}
+			offset = std::max(offset, (u64)r.end);
+			offset = (offset + item.align - 1) / item.align * item.align;
+		}
+		item.offset = offset;
+		size        = std::max(size, offset + item.size);
+
+		if(item.value != IrNone)
+		{
+			code.locate(item.value, IrSlot | (this->pOutgoing + offset));
+		}
+		else
+		{
+			code.local(item.local).offset = this->pOutgoing + offset;
+		}
+	}
+
+	//registers preserved by callee which are changed by the function, integer registers are bits 0-31
+	//of the mask and float registers bits 32-63
+	u64 saved = 0;
+	u32 count = 0;
+	for(IrId v = 0; v < code.instCount(); v++)
+	{
+		u32 location = code.location(v);
+		if(location == IrNone || (location & IrSlot) != 0)
+		{
+			continue;
+		}
+		u32 cls = (location & IrFloat) != 0 ? 1 : 0;
+		u32 reg = location & ~IrFloat;
+		u64 bit = 1ull << (cls * 32 + reg);
+		if(reg >= RegallocRegs<T>(cls).saved && (saved & bit) == 0)
+		{
+			saved |= bit;
+			count++;
+		}
+	}
+	code.setSaved(saved);
+
+	//frame keeps alignment of stack
+	u64 word = Targets[T].word;
+	code.setFrame(this->pOutgoing + (size + word - 1) / word * word + count * word);
+}
+
+/**
+ * \brief items are live at the same time
+ */
+bool Regalloc::interfere(const Item& a, const Item& b) const
+{
+	if(a.count == 0 || b.count == 0 || a.end < b.start || b.end < a.start)
+	{
+		return false;
+	}
+
+	u32 i = a.first;
+	u32 j = b.first;
+	while(i < a.first + a.count && j < b.first + b.count)
+	{
+		const Range& x = this->pRanges[i];
+		const Range& y = this->pRanges[j];
+		if(x.end < y.start)
+		{
+			i++;
+		}
+		else if(y.end < x.start)
+		{
+			j++;
+		}
+		else
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * \brief append tree of root into schedule or assign registers to its nodes
+ * \note node result goes into the first register of its range in its class, operands are evaluated
+ *       in order of decreasing need, each into the next register of its class. Operand which does
+ *       not fit besides results waiting in registers spills them into stack slots first.
+ *       Tree registers are indexes into the free registers of the class (pFree).
+ */
+void Regalloc::evaluate(IrId root, bool assign)
+{
+	Codegen& code         = *this->pCode;
+	u32      registers[2] = { assign ? (u32)this->pFree[0].size() : 0xffffffff, assign ? (u32)this->pFree[1].size() : 0xffffffff };
+
+	//explicit stack, machine generated expressions can be very deep
+	this->pFrames.clear();
+	this->pChildren.clear();
+
+	auto push = [this, &code](IrId id, const u32* reg)
+	{
+		Frame f;
+		f.id      = id;
+		f.reg[0]  = reg[0];
+		f.reg[1]  = reg[1];
+		f.begin   = this->pChildren.size();
+		f.next    = f.begin;
+		f.first   = f.begin;
+		f.held[0] = 0;
+		f.held[1] = 0;
+
+		for(u32 o = 0; o < code.inst(id).count; o++)
+		{
+			IrId v = code.operand(id, o);
+			if(v != IrNone && this->owned(v))
+			{
+				this->pChildren.push_back(v);
+			}
+		}
+		std::stable_sort(this->pChildren.begin() + f.begin, this->pChildren.end(), [this](IrId a, IrId b)
+		{
+			return this->pNeed[0][a] + this->pNeed[1][a] > this->pNeed[0][b] + this->pNeed[1][b];
+		});
+
+		this->pFrames.push_back(f);
+	};
+
+	const u32 first[2] = { 0, 0 };
+	push(root, first);
+	while(this->pFrames.size() != 0)
+	{
+		Frame& f = this->pFrames.back();
+
+		//operands are evaluated, node itself follows
+		if(f.next == this->pChildren.size())
+		{
+			IrId id  = f.id;
+			u32  cls = RegallocClass(code, id);
+			u32  reg = f.reg[cls];
+			this->pChildren.resize(f.begin);
+			this->pFrames.pop_back();
+
+			if(!assign)
+			{
+				this->pOrder.push_back(id);
+			}
+			else if(id != root)
+			{
+				code.locate(id, this->pFree[cls][reg]);
+			}
+			continue;
+		}
+
+		IrId c = this->pChildren[f.next++];
+		if(RegallocImmediate(code.inst(c).op))
+		{
+			if(!assign)
+			{
+				this->pOrder.push_back(c);
+			}
+			continue;
+		}
+
+		//results waiting in registers are spilled so the operand has all registers of the node
+		bool fits = true;
+		for(u32 k = 0; k < 2; k++)
+		{
+			fits = fits && f.reg[k] + f.held[k] + this->pNeed[k][c] <= registers[k];
+		}
+		if(!fits && f.held[0] + f.held[1] != 0)
+		{
+			for(u32 j = f.first; j < f.next - 1; j++)
+			{
+				IrId v = this->pChildren[j];
+				if(!RegallocImmediate(code.inst(v).op))
+				{
+					//temporary lives until its user
+					this->pStart[v] = this->pPos[v];
+					this->pEnd[v]   = this->pPos[this->pUser[v]];
+					this->spill(v);
+				}
+			}
+			f.first   = f.next - 1;
+			f.held[0] = 0;
+			f.held[1] = 0;
+		}
+
+		//push invalidates the frame
+		u32 reg[2] = { f.reg[0] + f.held[0], f.reg[1] + f.held[1] };
+		f.held[RegallocClass(code, c)]++;
+		push(c, reg);
+	}
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+#include "Target.hpp"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief register allocation of finished function
+ * \note expression trees (pure instructions whose single use is in the same block) are evaluated
+ *       in order of Sethi-Ullman numbers, subtree needing more registers first, so the tree uses
+ *       the fewest registers. Values used outside of their tree (variables, loop counters, phi)
+ *       get registers by linear scan over their live ranges across the whole function,
+ *       trees use registers which are not held by live values. Values are spilled into stack
+ *       slots only when registers run out. Stack slots and memory of local arrays and structures
+ *       share the frame when their live ranges or scopes are disjoint.
+ *       Integers and floats are allocated in their own classes of registers, expression tree
+ *       counts registers of both classes and spills when one of them runs out.
+ *       Calling convention of the target: argument is passed in register of its class at its position
+ *       when the class has so many argument registers, the rest on the stack at the bottom of caller
+ *       frame, results come back in registers of their class from r0 (f0).
+ *       Arguments, values passed to calls and results get the registers of calling convention
+ *       when they are free, values live across call get registers preserved by callee, so
+ *       function without calls needs no frame unless it runs out of registers.
+ *       Allocation is instantiated for every target, registers and convention are constants
+ *       of the instance, run selects the instance of the target.
+ */
+class Regalloc
+{
+public:
+	/**
+	 * \brief schedule expression trees and assign locations to all values of the function
+	 */
+	void run(Codegen& code, const Target& target);
+
+private:
+	/**
+	 * \brief allocation for target Targets[T] and instances for all targets
+	 */
+	template<u32 T>
+	void runTarget(Codegen& code);
+	using Run = void (Regalloc::*)(Codegen& code);
+	template<std::size_t... T>
+	static constexpr std::array<Run, sizeof...(T)> runs(std::index_sequence<T...>) { return {{ &Regalloc::runTarget<T>... }}; }
+
+	/**
+	 * \brief node of tree being evaluated
+	 * \note operands are in pChildren from begin, next is the operand to evaluate,
+	 *       results of operands from first are waiting in held registers,
+	 *       registers are counted for integers and floats
+	 */
+	struct Frame
+	{
+		IrId id;
+		u32  reg[2];
+		u32  begin;
+		u32  next;
+		u32  first;
+		u32  held[2];
+	};
+
+	/**
+	 * \brief use of value by operand of instruction
+	 */
+	struct Use
+	{
+		IrId inst;
+		u32  operand;
+	};
+
+	/**
+	 * \brief positions where item of frame is live
+	 */
+	struct Range
+	{
+		u32 start;
+		u32 end;
+	};
+
+	/**
+	 * \brief stack slot of value or memory of local variable, its ranges are in pRanges from first
+	 */
+	struct Item
+	{
+		u64  size;
+		u64  align;
+		u64  offset;
+		IrId value;
+		u32  local;
+		u32  first;
+		u32  count;
+		u32  start;
+		u32  end;
+	};
+
+	/**
+	 * \brief value is tree node evaluated just before its only user
+	 */
+	bool owned(IrId value) const;
+	/**
+	 * \brief value lives across its tree and gets register or stack slot by linear scan
+	 */
+	bool crosses(IrId value) const;
+	/**
+	 * \brief compute Sethi-Ullman numbers of tree node
+	 */
+	void label(IrId id);
+	/**
+	 * \brief append tree of root into schedule or assign registers to its nodes
+	 */
+	void evaluate(IrId root, bool assign);
+	void spill(IrId value);
+	/**
+	 * \brief live ranges and linear scan over them
+	 */
+	template<u32 T>
+	void intervals();
+	template<u32 T>
+	void scan();
+	template<u32 T>
+	void allocate(IrId value, u32 pos);
+	void expire(u32 pos);
+	IrId held(u32 reg) const;
+	/**
+	 * \brief calling convention: register where value is expected, value is live across call
+	 */
+	template<u32 T>
+	u32  hint(IrId value) const;
+	bool clobbered(IrId value) const;
+	/**
+	 * \brief frame layout of stack slots and memory of local variables
+	 */
+	template<u32 T>
+	void frame();
+	bool interfere(const Item& a, const Item& b) const;
+
+	Codegen*           pCode;
+
+	//uses of every value and its user (the last one), Sethi-Ullman numbers of tree nodes
+	//(integer and float registers needed by the node)
+	std::vector<u32>   pUses;
+	std::vector<IrId>  pUser;
+	std::vector<u32>   pNeed[2];
+	//new order of the current block
+	std::vector<IrId>  pOrder;
+	std::vector<Frame> pFrames;
+	std::vector<IrId>  pChildren;
+
+	//position of every instruction and range of positions of blocks
+	std::vector<u32>   pPos;
+	std::vector<u32>   pBlockStart;
+	std::vector<u32>   pBlockEnd;
+	//uses grouped by value
+	std::vector<u32>   pUseStart;
+	std::vector<Use>   pUseList;
+	//live range of values, blocks where the current value was found live
+	std::vector<u32>   pStart;
+	std::vector<u32>   pEnd;
+	std::vector<IrId>  pVisit;
+	std::vector<IrId>  pBlocks;
+	std::vector<u32>   pWork;
+	//positions of calls and size of their arguments passed on the stack
+	std::vector<u32>   pCalls;
+	u64                pOutgoing;
+	//values by start of range, values holding registers and their number in every class,
+	//value held by every register (integer registers first, then floats), register of every value
+	//and locations of registers free for the current tree
+	std::vector<IrId>  pSorted;
+	std::vector<IrId>  pActive;
+	u32                pActiveCount[2];
+	std::vector<IrId>  pHolder;
+	std::vector<u32>   pRegister;
+	std::vector<u32>   pFree[2];
+	//spilled values, items of frame and their ranges
+	std::vector<IrId>  pSpilled;
+	std::vector<Item>  pItems;
+	std::vector<Range> pRanges;
+	std::vector<Range> pUsed;
+};
@@ -1,4 +1,5 @@
 #include "Scanner.hpp"
+#include "Error.hpp"
 
 /**
  * \brief string form of token type for debug purposes
@@ -63,7 +64,7 @@ void Scanner::Token::print()
 	std::printf("[token: %s", ScannerTokenTypeString[(u32)this->type]);
 
 	if(this->type == TokenType::Id) { std::printf(", id: \"%s\"]", this->attribute.litString.c_str()); } else
-	if(this->type == TokenType::Int) { std::printf(", int: %lli]", this->attribute.litInt); } else
+	if(this->type == TokenType::Int) { std::printf(", int: %lli]", (long long)this->attribute.litInt); } else
 	if(this->type == TokenType::Float) { std::printf(", id: %lf]", this->attribute.litFloat); } else
 	if(this->type == TokenType::String) { std::printf(", id: \"%s\"]", this->attribute.litString.c_str()); } else
 	if(this->type == TokenType::Keyword) { std::printf(", id: %s]", ScannerTokenKeywordTypeString[(u32)this->attribute.keyword]); } else
@@ -82,16 +83,20 @@ Scanner::Scanner()
 	pSource = nullptr;
 	pState  = Scanner::State::Start;
 	pBuffer = "";
+	pOffset = 0;
+	pStart  = 0;
 }
 
 /**
  * \brief initialize scanner
  */
-Scanner::Scanner(FILE* input)
+Scanner::Scanner(FILE* input, u64 offset)
 {
 	pSource = input;
 	pState  = Scanner::State::Start;
 	pBuffer = "";
+	pOffset = offset;
+	pStart  = offset;
 }
 
 /**
@@ -143,10 +148,16 @@ void Scanner::parseFloat(std::string& num, Token& t)
 
 /**
  * \brief read one byte from source file
+ * \note source is accessed only by the thread running the scanner, no need for stdio locking
  */
 int  Scanner::getCharFromSource()
 {
-	return std::fgetc(pSource);
+	int c = getc_unlocked(pSource);
+	if(c != EOF)
+	{
+		pOffset++;
+	}
+	return c;
 }
 
 /**
@@ -154,13 +165,27 @@ int  Scanner::getCharFromSource()
  */
 void Scanner::ungetCharFromSource(int c)
 {
-	std::ungetc(c, pSource);
+	if(c != EOF)
+	{
+		std::ungetc(c, pSource);
+		pOffset--;
+	}
 }
 
 /**
  * \brief get next token from the source file
  */
 Scanner::Token Scanner::getToken()
+{
+	Token t = this->scanToken();
+	t.offset = pStart;
+	return t;
+}
+
+/**
+ * \brief scan next token from the source file
+ */
+Scanner::Token Scanner::scanToken()
 {
 	//create token
 	Token t;
@@ -187,6 +212,9 @@ Scanner::Token Scanner::getToken()
 		{
 			case Scanner::State::Start:
 			{
+				//token starts at the first character which is not skipped
+				pStart = charBuffer != EOF ? pOffset - 1 : pOffset;
+
 				//skip white spaces
 				if(charBuffer == '\n' || std::isspace(charBuffer))
 				{ 
@@ -302,7 +330,7 @@ Scanner::Token Scanner::getToken()
 				//any other characted is invalid
 				else
 				{
-					std::printf("Unexpected symbol\n");
+					Error(Error::Code::UnexpectedSymbol, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
@@ -346,7 +374,7 @@ Scanner::Token Scanner::getToken()
 					}
 					else
 					{
-						std::printf("Number in hex base must be lead by: \"0x\"\n");
+						Error(Error::Code::HexPrefix, pOffset - 1);
 						return Token(Scanner::TokenType::Null);
 					}
 				}
@@ -360,7 +388,7 @@ Scanner::Token Scanner::getToken()
 					}
 					else
 					{
-						std::printf("Number in oct base must be lead by: \"0o\"\n");
+						Error(Error::Code::OctPrefix, pOffset - 1);
 						return Token(Scanner::TokenType::Null);
 					}
 				}
@@ -374,7 +402,7 @@ Scanner::Token Scanner::getToken()
 					}
 					else
 					{
-						std::printf("Number in bin base must be lead by: \"0b\"\n");
+						Error(Error::Code::BinPrefix, pOffset - 1);
 						return Token(Scanner::TokenType::Null);
 					}
 				}
@@ -462,7 +490,7 @@ Scanner::Token Scanner::getToken()
 				}
 				else
 				{
-					std::printf("Unexpected symbol near number, after floating point should be digit\n");
+					Error(Error::Code::FloatFraction, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
@@ -506,7 +534,7 @@ Scanner::Token Scanner::getToken()
 				}
 				else
 				{
-					std::printf("Unexpected symbol near exponential number, after \"e\" symbol should be digit or sign\n");
+					Error(Error::Code::ExponentSymbol, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
@@ -523,7 +551,7 @@ Scanner::Token Scanner::getToken()
 				}
 				else
 				{
-					std::printf("Unexpected symbol near exponential number, after exponential sign should be digit\n");
+					Error(Error::Code::ExponentSign, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
@@ -569,7 +597,7 @@ Scanner::Token Scanner::getToken()
 				}
 				else
 				{
-					std::printf("Non ascii symbol inside a string\n");
+					Error(Error::Code::StringNonAscii, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
@@ -645,7 +673,7 @@ Scanner::Token Scanner::getToken()
 				}
 				else
 				{
-					std::printf("Unknown escape sequence\n");
+					Error(Error::Code::UnknownEscape, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
@@ -664,7 +692,7 @@ Scanner::Token Scanner::getToken()
 				}
 				else
 				{
-					std::printf("Hex escape sequence expects two heaxadecimal numbers\n");
+					Error(Error::Code::HexEscape, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
@@ -684,7 +712,7 @@ Scanner::Token Scanner::getToken()
 				}
 				else
 				{
-					std::printf("Hex escape sequence expects two heaxadecimal numbers\n");
+					Error(Error::Code::HexEscape, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
@@ -700,7 +728,7 @@ Scanner::Token Scanner::getToken()
 				}
 				else
 				{
-					std::printf("Unexpected symbol after \"!\"\n");
+					Error(Error::Code::NonEqu, pOffset - 1);
 					return Token(Scanner::TokenType::Null);
 				}
 
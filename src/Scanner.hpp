@@ -21,6 +21,7 @@ public:
 		Null,				// invalid token
 		Acc,				// special data token for evaluating expressions
 		Ret,				// special data token for evaluating expressions
+		Field,				// special data token for evaluating expressions (package item)
 
 		Eof, 				// end of file
 		LeftCurlyBracket, 	// {
@@ -80,6 +81,9 @@ public:
 		//token type
 		TokenType type;
 
+		//byte offset of the token in the source file
+		u64 offset;
+
 		//based on type, token can have attribute
 		struct TokenAttribute
 		{
@@ -90,8 +94,8 @@ public:
 		} attribute;
 
 		//constructors
-		Token() 		   { type = TokenType::Null; }
-		Token(TokenType t) { type = t; }
+		Token() 		   { type = TokenType::Null; offset = 0; }
+		Token(TokenType t) { type = t; offset = 0; }
 
 		//debug print
 		void print();
@@ -139,6 +143,8 @@ private:
 
 	FILE*       pSource; /* input source file */
 	std::string pBuffer; /* buffer for scanning numbers and identificators */
+	u64         pOffset; /* offset of the next byte in the source file */
+	u64         pStart;  /* offset of the currently scanned token */
 
 	/**
 	 * \brief check if identificator is not keyword
@@ -153,6 +159,11 @@ private:
 	 */
 	void parseFloat(std::string& num, Token& t);
 
+	/**
+	 * \brief scan next token from the source file
+	 */
+	Token scanToken();
+
 	/**
 	 * \brief read one byte from source file
 	 */
@@ -168,7 +179,10 @@ public:
 	 * \brief constructors
 	 */
 	Scanner();
-	Scanner(FILE* input);
+	/**
+	 * \note input stream is positioned at byte offset of the source file (scanning of its part)
+	 */
+	Scanner(FILE* input, u64 offset = 0);
 
 	/**
 	 * \brief get next token from the source file
@@ -0,0 +1,341 @@
+#include "Sccp.hpp"
+
+#include <cstring>
+
+/**
+ * \brief the same constant (floats compare by bits, so -0.0 is not 0.0)
+ */
+static bool SccpSame(const OperatorValue& a, const OperatorValue& b)
+{
+	return a.type == b.type && a.i == b.i && std::memcmp(&a.f, &b.f, sizeof(f64)) == 0;
+}
+
+/**
+ * \brief result of operation of constants of type (false when it has no result)
+ */
+static bool SccpFold(IrOp op, IrType type, const OperatorValue& a, const OperatorValue& b, OperatorValue& r)
+{
+	switch(type)
+	{
+		case IrType::F64: { return OperatorEval(op, a.f, b.f, r); }
+		case IrType::U8:  { return OperatorEval(op, (u8)a.i, (u8)b.i, r); }
+		default:          { return OperatorEval(op, a.i, b.i, r); }
+	}
+}
+
+/**
+ * \brief propagate constants and remove code which is never executed
+ */
+void Sccp::run(Codegen& code)
+{
+	this->pCode = &code;
+	this->pState.assign(code.instCount(), State::Top);
+	this->pValue.resize(code.instCount());
+	this->pBlocks.assign(code.blockCount(), 0);
+	this->pEdges.assign(code.edgeCount(), 0);
+	this->pBlockWork.clear();
+	this->pValueWork.clear();
+
+	//users grouped by value, counts become ends of groups and filling moves them to starts
+	this->pUseStart.assign(code.instCount() + 1, 0);
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		for(IrId i = code.live(b) ? code.block(b).first : IrNone; i != IrNone; i = code.inst(i).next)
+		{
+			for(u32 o = 0; o < code.inst(i).count; o++)
+			{
+				IrId v = code.operand(i, o);
+				if(v != IrNone)
+				{
+					this->pUseStart[v]++;
+				}
+			}
+		}
+	}
+	for(IrId v = 1; v <= code.instCount(); v++)
+	{
+		this->pUseStart[v] += this->pUseStart[v - 1];
+	}
+	this->pUseList.resize(this->pUseStart[code.instCount()]);
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		for(IrId i = code.live(b) ? code.block(b).first : IrNone; i != IrNone; i = code.inst(i).next)
+		{
+			for(u32 o = 0; o < code.inst(i).count; o++)
+			{
+				IrId v = code.operand(i, o);
+				if(v != IrNone)
+				{
+					this->pUseList[--this->pUseStart[v]] = i;
+				}
+			}
+		}
+	}
+
+	this->pBlocks[0] = 1;
+	this->pBlockWork.push_back(0);
+	while(this->pBlockWork.size() != 0 || this->pValueWork.size() != 0)
+	{
+		if(this->pBlockWork.size() != 0)
+		{
+			IrId b = this->pBlockWork.back();
+			this->pBlockWork.pop_back();
+			for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+			{
+				this->visit(i);
+			}
+			continue;
+		}
+
+		IrId v = this->pValueWork.back();
+		this->pValueWork.pop_back();
+		for(u32 u = this->pUseStart[v]; u < this->pUseStart[v + 1]; u++)
+		{
+			IrId user = this->pUseList[u];
+			if(this->pBlocks[code.inst(user).block] != 0)
+			{
+				this->visit(user);
+			}
+		}
+	}
+
+	//constants replace computed values, constant conditions decide branches
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(this->pBlocks[b] == 0)
+		{
+			continue;
+		}
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			if(this->pState[i] != State::Const || code.inst(i).op == IrOp::Const)
+			{
+				continue;
+			}
+			const OperatorValue& c = this->pValue[i];
+			if(c.type == IrType::F64)
+			{
+				code.setConstant(i, c.f);
+			}
+			else
+			{
+				code.setConstant(i, c.type, c.i);
+			}
+		}
+
+		IrId last = code.block(b).last;
+		if(last != IrNone && code.inst(last).op == IrOp::Branch && this->pState[code.operand(last, 0)] == State::Const)
+		{
+			const OperatorValue& c = this->pValue[code.operand(last, 0)];
+			code.takeBranch(b, (c.type == IrType::F64 ? c.f != 0.0 : c.i != 0) ? 0 : 1);
+		}
+	}
+
+	//blocks which are never executed are unreachable
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(this->pBlocks[b] == 0 && code.live(b))
+		{
+			code.detach(b);
+		}
+	}
+	code.finish();
+
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		while(code.merge(b))
+		{
+		}
+	}
+}
+
+/**
+ * \brief evaluate instruction of executable block
+ */
+void Sccp::visit(IrId id)
+{
+	Codegen&      code = *this->pCode;
+	const IrInst& inst = code.inst(id);
+
+	switch(inst.op)
+	{
+		case IrOp::Jump:
+		{
+			this->reach(inst.block, code.block(inst.block).succ[0]);
+			break;
+		}
+		case IrOp::Branch:
+		{
+			IrId cond = code.operand(id, 0);
+			if(this->pState[cond] == State::Const)
+			{
+				const OperatorValue& c = this->pValue[cond];
+				bool taken = c.type == IrType::F64 ? c.f != 0.0 : c.i != 0;
+				this->reach(inst.block, code.block(inst.block).succ[taken ? 0 : 1]);
+			}
+			else if(this->pState[cond] == State::Bottom)
+			{
+				this->reach(inst.block, code.block(inst.block).succ[0]);
+				this->reach(inst.block, code.block(inst.block).succ[1]);
+			}
+			break;
+		}
+		case IrOp::Phi:
+		{
+			this->visitPhi(id);
+			break;
+		}
+		case IrOp::Const:
+		{
+			OperatorValue c;
+			c.type = inst.type;
+			c.i    = inst.type == IrType::F64 ? 0 : inst.imm.i;
+			c.f    = inst.type == IrType::F64 ? inst.imm.f : 0.0;
+			this->lower(id, State::Const, c);
+			break;
+		}
+		case IrOp::Add: case IrOp::Sub: case IrOp::Mul: case IrOp::Div:
+		case IrOp::Shl: case IrOp::Shr: case IrOp::Sar: case IrOp::MulHi:
+		case IrOp::Lt:  case IrOp::Le:  case IrOp::Gt:  case IrOp::Ge:
+		case IrOp::Eq:  case IrOp::Ne:
+		{
+			IrId a = code.operand(id, 0);
+			IrId b = code.operand(id, 1);
+			if(this->pState[a] == State::Top || this->pState[b] == State::Top)
+			{
+				break;
+			}
+
+			OperatorValue r;
+			if(this->pState[a] == State::Const && this->pState[b] == State::Const &&
+			   SccpFold(inst.op, inst.type, this->pValue[a], this->pValue[b], r))
+			{
+				this->lower(id, State::Const, r);
+			}
+			else
+			{
+				this->lower(id, State::Bottom);
+			}
+			break;
+		}
+		case IrOp::Cvt:
+		{
+			IrId          a = code.operand(id, 0);
+			OperatorValue r;
+			if(this->pState[a] == State::Const && OperatorConvert(this->pValue[a], inst.type, r))
+			{
+				this->lower(id, State::Const, r);
+			}
+			else if(this->pState[a] != State::Top)
+			{
+				this->lower(id, State::Bottom);
+			}
+			break;
+		}
+		default:
+		{
+			//arguments, memory, calls and undefined values are not constants
+			this->lower(id, State::Bottom);
+			break;
+		}
+	}
+}
+
+/**
+ * \brief phi meets values of executable edges only
+ */
+void Sccp::visitPhi(IrId id)
+{
+	Codegen&      code  = *this->pCode;
+	const IrInst& inst  = code.inst(id);
+	State         state = State::Top;
+	IrId          same  = IrNone;
+
+	u32 edge = code.block(inst.block).preds;
+	for(u32 k = 0; k < inst.count && edge != IrNone; k++, edge = code.edgeNext(edge))
+	{
+		IrId v = code.operand(id, k);
+		if(this->pEdges[edge] == 0 || this->pState[v] == State::Top)
+		{
+			continue;
+		}
+		if(this->pState[v] == State::Bottom || (same != IrNone && !SccpSame(this->pValue[same], this->pValue[v])))
+		{
+			state = State::Bottom;
+			break;
+		}
+		state = State::Const;
+		same  = v;
+	}
+
+	if(state == State::Const)
+	{
+		this->lower(id, state, this->pValue[same]);
+	}
+	else if(state == State::Bottom)
+	{
+		this->lower(id, state);
+	}
+}
+
+/**
+ * \brief edges from block to successor are executable, successor is evaluated when it is reached
+ *        for the first time, its phi instructions when it gets a new executable edge
+ */
+void Sccp::reach(IrId from, IrId to)
+{
+	Codegen& code  = *this->pCode;
+	bool     added = false;
+	for(u32 e = code.block(to).preds; e != IrNone; e = code.edgeNext(e))
+	{
+		if(code.edgeFrom(e) == from && this->pEdges[e] == 0)
+		{
+			this->pEdges[e] = 1;
+			added           = true;
+		}
+	}
+	if(!added)
+	{
+		return;
+	}
+
+	if(this->pBlocks[to] == 0)
+	{
+		this->pBlocks[to] = 1;
+		this->pBlockWork.push_back(to);
+		return;
+	}
+	for(IrId i = code.block(to).first; i != IrNone; i = code.inst(i).next)
+	{
+		if(code.inst(i).op == IrOp::Phi)
+		{
+			this->visitPhi(i);
+		}
+	}
+}
+
+/**
+ * \brief lower value in lattice, users are evaluated again when it changes
+ * \note different constants meet in bottom
+ */
+void Sccp::lower(IrId id, State state, const OperatorValue& value)
+{
+	State current = this->pState[id];
+	if(current == State::Bottom || (current == State::Const && state == State::Const && SccpSame(this->pValue[id], value)))
+	{
+		return;
+	}
+
+	this->pState[id] = current == State::Const ? State::Bottom : state;
+	this->pValue[id] = value;
+	this->pValueWork.push_back(id);
+}
+
+void Sccp::lower(IrId id, State state)
+{
+	OperatorValue none;
+	none.type = IrType::None;
+	none.i    = 0;
+	none.f    = 0.0;
+	this->lower(id, state, none);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+#include "Operator.hpp"
+
+#include <vector>
+
+/**
+ * \brief sparse conditional constant propagation of finished function
+ * \note every value starts unknown (top) and is lowered to a constant or to not constant (bottom),
+ *       only blocks reached by executable edges from the entry are evaluated and phi instructions
+ *       meet only operands of executable edges, so constants flow through branches decided
+ *       by constants. Values found constant become constants, branch with constant condition
+ *       becomes jump, blocks which are never executed lose their edges and finish removes them
+ *       with unused values. Blocks ending with jump absorb successors which have no other predecessor.
+ *       Folding uses the semantics of Operator.hpp, division by zero stays for runtime.
+ */
+class Sccp
+{
+public:
+	/**
+	 * \brief propagate constants and remove code which is never executed
+	 */
+	void run(Codegen& code);
+
+private:
+	/**
+	 * \brief lattice of value
+	 */
+	enum class State : u8
+	{
+		Top,
+		Const,
+		Bottom,
+	};
+
+	/**
+	 * \brief evaluate instruction of executable block
+	 */
+	void visit(IrId id);
+	void visitPhi(IrId id);
+	/**
+	 * \brief edges from block to successor are executable
+	 */
+	void reach(IrId from, IrId to);
+	/**
+	 * \brief lower value in lattice, users are evaluated again when it changes
+	 */
+	void lower(IrId id, State state, const OperatorValue& value);
+	void lower(IrId id, State state);
+
+	Codegen*                   pCode;
+
+	//lattice state and constant of every value
+	std::vector<State>         pState;
+	std::vector<OperatorValue> pValue;
+	//executable blocks and edges, blocks and values to evaluate
+	std::vector<u8>            pBlocks;
+	std::vector<u8>            pEdges;
+	std::vector<IrId>          pBlockWork;
+	std::vector<IrId>          pValueWork;
+	//users of every value grouped by value
+	std::vector<u32>           pUseStart;
+	std::vector<IrId>          pUseList;
+};
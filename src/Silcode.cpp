@@ -0,0 +1,185 @@
+#include "Silcode.hpp"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * \brief map file and check its header and section table, returns error message or nullptr
+ */
+const char* SilcodeImage::open(const char* path)
+{
+	this->close();
+
+	int fd = ::open(path, O_RDONLY);
+	if(fd < 0)
+	{
+		return "cannot open file";
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (u64)st.st_size < sizeof(SilcodeHeader))
+	{
+		::close(fd);
+		return "file is too small";
+	}
+
+	void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(base == MAP_FAILED)
+	{
+		return "cannot map file";
+	}
+
+	this->pBase = (const u8*)base;
+	this->pSize = st.st_size;
+
+	//everything is checked once, accessors then trust the image
+	const SilcodeHeader& h = this->header();
+	if(std::memcmp(h.magic, SilcodeMagic, sizeof(SilcodeMagic)) != 0)
+	{
+		this->close();
+		return "not a silcode file";
+	}
+	if(h.major != SilcodeVersionMajor || h.minor > SilcodeVersionMinor)
+	{
+		this->close();
+		return "unsupported version";
+	}
+	//sizes are compared by subtraction, sums of values read from the file could wrap
+	if(h.size != this->pSize || h.table % SilcodeAlign != 0 || h.table > this->pSize ||
+	   h.sections > (this->pSize - h.table) / sizeof(SilcodeSectionEntry))
+	{
+		this->close();
+		return "damaged header";
+	}
+
+	const SilcodeSectionEntry* table = (const SilcodeSectionEntry*)(this->pBase + h.table);
+	for(u32 i = 0; i < h.sections; i++)
+	{
+		if(table[i].offset % SilcodeAlign != 0 || table[i].offset > this->pSize || table[i].size > this->pSize - table[i].offset)
+		{
+			this->close();
+			return "damaged section table";
+		}
+	}
+
+	u64 size;
+	this->section(SilcodeSection::Symbols, size);
+	if(size % sizeof(SilcodeSymbol) != 0 || size / sizeof(SilcodeSymbol) >= SilcodeNone)
+	{
+		this->close();
+		return "damaged symbol table";
+	}
+
+	//names must start inside strings section which ends with terminator
+	u64         stringSize;
+	const char* strings = (const char*)this->section(SilcodeSection::Strings, stringSize);
+	u32         count   = this->symbolCount();
+	if(count != 0 && (stringSize == 0 || strings[stringSize - 1] != '\0'))
+	{
+		this->close();
+		return "damaged strings";
+	}
+	for(u32 i = 0; i < count; i++)
+	{
+		if(this->symbol(i).name >= stringSize)
+		{
+			this->close();
+			return "damaged symbol table";
+		}
+	}
+
+	if((h.entry != SilcodeNone && h.entry >= count) || (h.init != SilcodeNone && h.init >= count))
+	{
+		this->close();
+		return "damaged header";
+	}
+
+	const SilcodeLine* lines = (const SilcodeLine*)this->section(SilcodeSection::Lines, size);
+	if(size % sizeof(SilcodeLine) != 0)
+	{
+		this->close();
+		return "damaged line table";
+	}
+	for(u64 i = 0; i < size / sizeof(SilcodeLine); i++)
+	{
+		if(lines[i].symbol >= count)
+		{
+			this->close();
+			return "damaged line table";
+		}
+	}
+
+	return nullptr;
+}
+
+void SilcodeImage::close()
+{
+	if(this->pBase != nullptr)
+	{
+		munmap((void*)this->pBase, this->pSize);
+	}
+	this->pBase = nullptr;
+	this->pSize = 0;
+}
+
+/**
+ * \brief section of given kind (nullptr and size 0 when missing)
+ */
+const u8* SilcodeImage::section(SilcodeSection kind, u64& size) const
+{
+	const SilcodeHeader&       h     = this->header();
+	const SilcodeSectionEntry* table = (const SilcodeSectionEntry*)(this->pBase + h.table);
+
+	for(u32 i = 0; i < h.sections; i++)
+	{
+		if(table[i].kind == kind)
+		{
+			size = table[i].size;
+			return this->pBase + table[i].offset;
+		}
+	}
+
+	size = 0;
+	return nullptr;
+}
+
+/**
+ * \brief symbol table and names
+ */
+u32 SilcodeImage::symbolCount() const
+{
+	u64 size;
+	this->section(SilcodeSection::Symbols, size);
+	return size / sizeof(SilcodeSymbol);
+}
+
+const SilcodeSymbol& SilcodeImage::symbol(u32 index) const
+{
+	u64 size;
+	return ((const SilcodeSymbol*)this->section(SilcodeSection::Symbols, size))[index];
+}
+
+const char* SilcodeImage::name(u32 index) const
+{
+	u64 size;
+	return (const char*)this->section(SilcodeSection::Strings, size) + this->symbol(index).name;
+}
+
+/**
+ * \brief symbol by name (SilcodeNone when missing)
+ */
+u32 SilcodeImage::find(const char* name) const
+{
+	for(u32 i = 0; i < this->symbolCount(); i++)
+	{
+		if(std::strcmp(this->name(i), name) == 0)
+		{
+			return i;
+		}
+	}
+	return SilcodeNone;
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <string>
+
+/**
+ * \brief binary .silcode format
+ * \note file starts with header followed by section table, every section is aligned to 8 bytes
+ *       so the file can be mapped into memory and used in place:
+ *
+ *       header | section table | code | constants | data | symbols | strings | lines
+ *
+ *       fixed size records are little endian and naturally aligned,
+ *       code of functions is encoded with LEB128 numbers (see Emitter.cpp)
+ */
+static constexpr char SilcodeMagic[4]    = { 'S', 'I', 'L', 'C' };
+//any change of record layout or encoding bumps major, minor only marks compatible additions
+//(readers reject newer minor as well, they cannot know which additions they would miss)
+static constexpr u16  SilcodeVersionMajor = 1;
+static constexpr u16  SilcodeVersionMinor = 0;
+static constexpr u64  SilcodeAlign        = 8;
+
+/**
+ * \brief kind of section
+ */
+enum class SilcodeSection : u32
+{
+	//encoded functions
+	Code,
+	//float constants (8 byte aligned) and null terminated string literals
+	Constants,
+	//initial memory of global variables
+	Data,
+	//SilcodeSymbol records
+	Symbols,
+	//null terminated names of symbols
+	Strings,
+	//SilcodeLine records
+	Lines,
+	Count,
+};
+
+/**
+ * \brief header at the start of file
+ */
+struct SilcodeHeader
+{
+	char magic[4];
+	u16  major;
+	u16  minor;
+	//number of records in section table and its offset
+	u32  sections;
+	u32  flags;
+	u64  table;
+	//size of the whole file
+	u64  size;
+	//symbol of main function (SilcodeNone = no main) and startup function
+	u32  entry;
+	u32  init;
+};
+static_assert(sizeof(SilcodeHeader) == 40, "silcode header layout");
+
+/**
+ * \brief record of section table
+ */
+struct SilcodeSectionEntry
+{
+	SilcodeSection kind;
+	u32            align;
+	u64            offset;
+	u64            size;
+};
+static_assert(sizeof(SilcodeSectionEntry) == 24, "silcode section layout");
+
+static constexpr u32 SilcodeNone = 0xffffffff;
+
+/**
+ * \brief kind of symbol
+ */
+enum class SilcodeSymbolKind : u8
+{
+	//referenced but not defined in the file
+	Extern,
+	//value is offset of code in code section, size of the code
+	Function,
+	//value is offset of memory in data section, size of the memory
+	Data,
+	//memory of local variable (its frame slot is assigned by the loader)
+	Local,
+};
+
+/**
+ * \brief symbol flags
+ */
+static constexpr u8 SilcodeSymbolConstant = 0x01; //data holds offset into constants section (address of string literal)
+
+/**
+ * \brief record of symbol table
+ */
+struct SilcodeSymbol
+{
+	//offset of name in strings section
+	u32               name;
+	SilcodeSymbolKind kind;
+	u8                flags;
+	u16               align;
+	u64               value;
+	u64               size;
+};
+static_assert(sizeof(SilcodeSymbol) == 24, "silcode symbol layout");
+
+/**
+ * \brief line information of function
+ * \note source position is byte offset of the first token of function body in preprocessed source
+ */
+struct SilcodeLine
+{
+	u32 symbol;
+	u32 reserved;
+	u64 source;
+	u64 code;
+};
+static_assert(sizeof(SilcodeLine) == 24, "silcode line layout");
+
+/**
+ * \brief LEB128 encoding of numbers
+ */
+static inline void SilcodeWriteU(std::string& out, u64 value)
+{
+	do
+	{
+		u8 byte = value & 0x7f;
+		value >>= 7;
+		out.push_back((char)(value != 0 ? byte | 0x80 : byte));
+	} while(value != 0);
+}
+
+static inline void SilcodeWriteS(std::string& out, i64 value)
+{
+	bool more = true;
+	while(more)
+	{
+		u8 byte = value & 0x7f;
+		value >>= 7;
+		more = !((value == 0 && (byte & 0x40) == 0) || (value == -1 && (byte & 0x40) != 0));
+		out.push_back((char)(more ? byte | 0x80 : byte));
+	}
+}
+
+static inline u64 SilcodeReadU(const u8*& in)
+{
+	u64 value = 0;
+	u32 shift = 0;
+	u8  byte;
+	do
+	{
+		byte   = *in++;
+		value |= (u64)(byte & 0x7f) << shift;
+		shift += 7;
+	} while((byte & 0x80) != 0 && shift < 64);
+	return value;
+}
+
+static inline i64 SilcodeReadS(const u8*& in)
+{
+	i64 value = 0;
+	u32 shift = 0;
+	u8  byte;
+	do
+	{
+		byte   = *in++;
+		value |= (i64)(byte & 0x7f) << shift;
+		shift += 7;
+	} while((byte & 0x80) != 0 && shift < 64);
+
+	if(shift < 64 && (byte & 0x40) != 0)
+	{
+		value |= -((i64)1 << shift);
+	}
+	return value;
+}
+
+/**
+ * \brief .silcode file mapped into memory
+ * \note sections are used in place, nothing is copied
+ */
+class SilcodeImage
+{
+public:
+	SilcodeImage() { this->pBase = nullptr; this->pSize = 0; }
+	~SilcodeImage() { this->close(); }
+
+	/**
+	 * \brief map file and check its header and section table, returns error message or nullptr
+	 */
+	const char* open(const char* path);
+	void        close();
+
+	const SilcodeHeader& header() const { return *(const SilcodeHeader*)this->pBase; }
+	/**
+	 * \brief section of given kind (nullptr and size 0 when missing)
+	 */
+	const u8* section(SilcodeSection kind, u64& size) const;
+
+	/**
+	 * \brief symbol table and names
+	 */
+	u32                  symbolCount() const;
+	const SilcodeSymbol& symbol(u32 index) const;
+	const char*          name(u32 index) const;
+	/**
+	 * \brief symbol by name (SilcodeNone when missing)
+	 */
+	u32                  find(const char* name) const;
+
+private:
+	const u8* pBase;
+	u64       pSize;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * \brief positions of preprocessed source in source files
+ * \note text of preprocessed source between two entries is copied from one source file without
+ *       change, so byte of the text is at the position of the entry moved by the text before it.
+ *       Preprocessor adds entry where a file starts, after included file, after definition
+ *       of macro and around text of substituted macro (it is at the position of the macro name).
+ */
+struct SourceMap
+{
+	struct Entry
+	{
+		//offset in preprocessed source
+		u64 offset;
+		//index of file name, line and column in the file
+		u32 file;
+		u32 line;
+		u32 column;
+	};
+
+	std::vector<std::string> files;
+	std::vector<Entry>       entries;
+	//size of preprocessed source written so far
+	u64                      size;
+
+	SourceMap() { size = 0; }
+
+	/**
+	 * \brief text written from now on starts at position of file
+	 */
+	void mark(u32 file, u32 line, u32 column)
+	{
+		if(!this->entries.empty() && this->entries.back().offset == this->size)
+		{
+			this->entries.pop_back();
+		}
+		this->entries.push_back({ this->size, file, line, column });
+	}
+};
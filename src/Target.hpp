@@ -0,0 +1,119 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+
+#include <cstring>
+
+/**
+ * \brief class of registers
+ * \note registers are numbered from r0 (f0 for floats), first args registers pass arguments
+ *       and results, registers from saved are preserved by called function
+ */
+struct TargetRegClass
+{
+	u32 count;
+	u32 args;
+	u32 saved;
+};
+
+/**
+ * \brief cost of instructions in cycles
+ */
+struct TargetCosts
+{
+	u8 alu;
+	u8 mul;
+	u8 div;
+	u8 fpu;
+	u8 fdiv;
+	u8 load;
+	u8 store;
+	u8 call;
+	u8 branch;
+};
+
+/**
+ * \brief description of target architecture
+ * \note integers (and addresses) and floats have separate classes of registers. Argument or result
+ *       goes into register of its class at its position (the third argument is r2 or f2) when the class
+ *       has so many argument registers, otherwise onto the stack
+ */
+struct Target
+{
+	const char*    name;
+	//size of word and of stack slot in bytes
+	u32            word;
+	TargetRegClass ints;
+	TargetRegClass floats;
+	TargetCosts    costs;
+
+	/**
+	 * \brief cost of instruction of type
+	 */
+	constexpr u32 cost(IrOp op, IrType type) const
+	{
+		switch(op)
+		{
+			case IrOp::Const: case IrOp::Undef: case IrOp::Str: case IrOp::Arg:
+			case IrOp::Phi:   case IrOp::Result:                 { return 0; }
+			case IrOp::Mul:   case IrOp::MulHi:                  { return type == IrType::F64 ? this->costs.fpu : this->costs.mul; }
+			case IrOp::Div:                                      { return type == IrType::F64 ? this->costs.fdiv : this->costs.div; }
+			case IrOp::Load:                                     { return this->costs.load; }
+			case IrOp::Store: case IrOp::Copy:                   { return this->costs.store; }
+			case IrOp::Call:                                     { return this->costs.call; }
+			case IrOp::Jump:  case IrOp::Branch: case IrOp::Ret: { return this->costs.branch; }
+			default:                                             { return type == IrType::F64 ? this->costs.fpu : this->costs.alu; }
+		}
+	}
+};
+
+/**
+ * \brief supported targets, the first one is the default
+ * \note one table shared by all modules, target selected by main is found by its index in it
+ */
+inline constexpr Target Targets[] =
+{
+	//                      ints               floats
+	//name            word  count args saved   count args saved    alu mul div fpu fdiv load store call branch
+	{ "silent",       8,  { 16,   6,   8 },  { 16,   8,   8 },  { 1,  3,  20, 4,  20,  4,   4,    10,  1 } },
+	{ "silent-small", 8,  {  8,   4,   4 },  {  8,   4,   4 },  { 1,  3,  20, 4,  20,  4,   4,    10,  1 } },
+	{ "silent-wide",  8,  { 32,   8,  16 },  { 32,   8,  16 },  { 1,  3,  20, 4,  20,  4,   4,    10,  1 } },
+};
+static constexpr u32 TargetCount = sizeof(Targets) / sizeof(Targets[0]);
+
+/**
+ * \brief registers of every class fit into half of mask of saved registers, one is left for expressions
+ *        and convention uses existing registers
+ */
+static constexpr bool TargetValid(const TargetRegClass& c)
+{
+	return c.count >= 2 && c.count <= 32 && c.args <= c.count && c.saved <= c.count;
+}
+static constexpr bool TargetValid()
+{
+	for(const Target& t : Targets)
+	{
+		if(!TargetValid(t.ints) || !TargetValid(t.floats))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+static_assert(TargetValid(), "invalid target description");
+
+/**
+ * \brief target by name (nullptr when unknown)
+ */
+static inline const Target* TargetFind(const char* name)
+{
+	for(const Target& t : Targets)
+	{
+		if(std::strcmp(t.name, name) == 0)
+		{
+			return &t;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,136 @@
+#include "ThreadPool.hpp"
+
+/**
+ * \brief start worker threads
+ */
+ThreadPool::ThreadPool(u64 workers) : pQueues(workers == 0 ? 1 : workers)
+{
+	this->pNext    = 0;
+	this->pQueued  = 0;
+	this->pPending = 0;
+	this->pStop    = false;
+
+	for(u64 i = 0; i < this->pQueues.size(); i++)
+	{
+		this->pThreads.emplace_back(&ThreadPool::work, this, i);
+	}
+}
+
+/**
+ * \brief wait for all tasks and join worker threads
+ */
+ThreadPool::~ThreadPool()
+{
+	this->wait();
+
+	{
+		std::lock_guard<std::mutex> l(this->pLock);
+		this->pStop = true;
+	}
+	this->pWake.notify_all();
+
+	for(std::thread& t : this->pThreads)
+	{
+		t.join();
+	}
+}
+
+/**
+ * \brief schedule task
+ */
+void ThreadPool::submit(std::function<void()> task)
+{
+	Queue& q = this->pQueues[this->pNext++ % this->pQueues.size()];
+
+	this->pPending++;
+	{
+		std::lock_guard<std::mutex> l(q.lock);
+		q.tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard<std::mutex> l(this->pLock);
+		this->pQueued++;
+	}
+	this->pWake.notify_one();
+}
+
+/**
+ * \brief block until all submitted tasks finish
+ */
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> l(this->pLock);
+	this->pDone.wait(l, [this]() { return this->pPending == 0; });
+}
+
+/**
+ * \brief take task from own queue or steal it from other queue
+ */
+bool ThreadPool::take(u64 id, std::function<void()>& task)
+{
+	//own queue is processed from the back
+	{
+		Queue& q = this->pQueues[id];
+		std::lock_guard<std::mutex> l(q.lock);
+		if(q.tasks.size() != 0)
+		{
+			task = std::move(q.tasks.back());
+			q.tasks.pop_back();
+			return true;
+		}
+	}
+
+	//other queues are robbed from the front
+	for(u64 i = 1; i < this->pQueues.size(); i++)
+	{
+		Queue& q = this->pQueues[(id + i) % this->pQueues.size()];
+		std::lock_guard<std::mutex> l(q.lock);
+		if(q.tasks.size() != 0)
+		{
+			task = std::move(q.tasks.front());
+			q.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * \brief worker thread main loop
+ */
+void ThreadPool::work(u64 id)
+{
+	std::function<void()> task;
+
+	while(true)
+	{
+		//sleep until there is something to do
+		{
+			std::unique_lock<std::mutex> l(this->pLock);
+			this->pWake.wait(l, [this]() { return this->pStop || this->pQueued != 0; });
+
+			if(this->pQueued == 0)
+			{
+				return;
+			}
+			this->pQueued--;
+		}
+
+		//the counter guarantees that some queue holds a task for us
+		while(!this->take(id, task))
+		{
+			std::this_thread::yield();
+		}
+
+		task();
+		task = nullptr;
+
+		if(--this->pPending == 0)
+		{
+			std::lock_guard<std::mutex> l(this->pLock);
+			this->pDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/**
+ * \brief work-stealing thread pool
+ * \note every worker owns a task queue, takes work from the back of its own queue
+ *       and steals from the front of other queues when its own queue is empty
+ */
+class ThreadPool
+{
+public:
+
+	/**
+	 * \brief start worker threads
+	 */
+	ThreadPool(u64 workers);
+	/**
+	 * \brief wait for all tasks and join worker threads
+	 */
+	~ThreadPool();
+
+	/**
+	 * \brief schedule task
+	 */
+	void submit(std::function<void()> task);
+	/**
+	 * \brief block until all submitted tasks finish
+	 */
+	void wait();
+
+	/**
+	 * \brief number of worker threads
+	 */
+	u64  size() const { return this->pQueues.size(); }
+
+private:
+
+	//queue owned by one worker
+	struct Queue
+	{
+		std::deque<std::function<void()>> tasks;
+		std::mutex                        lock;
+	};
+
+	/**
+	 * \brief worker thread main loop
+	 */
+	void work(u64 id);
+	/**
+	 * \brief take task from own queue or steal it from other queue
+	 */
+	bool take(u64 id, std::function<void()>& task);
+
+	std::vector<Queue>       pQueues;
+	std::vector<std::thread> pThreads;
+
+	//round robin submit index
+	u64 pNext;
+
+	//tasks waiting in queues and tasks not yet finished
+	std::atomic<u64> pQueued;
+	std::atomic<u64> pPending;
+	bool             pStop;
+
+	//sleeping workers and waiting submitter
+	std::mutex              pLock;
+	std::condition_variable pWake;
+	std::condition_variable pDone;
+};
@@ -0,0 +1,89 @@
+#include "TokenRing.hpp"
+
+#include <thread>
+
+/**
+ * \brief create ring (capacity is rounded up to power of two)
+ */
+TokenRing::TokenRing(u64 capacity)
+{
+	u64 size = 1;
+	while(size < capacity)
+	{
+		size <<= 1;
+	}
+
+	this->pSlots.resize(size);
+	this->pMask      = size - 1;
+	this->pHead      = 0;
+	this->pTail      = 0;
+	this->pClosed    = false;
+	this->pCancelled = false;
+}
+
+/**
+ * \brief publish batch, waits while the ring is full
+ * \note batch receives recycled memory, returns false when the consumer cancelled the ring
+ */
+bool TokenRing::push(Batch& batch)
+{
+	u64 tail = this->pTail.load(std::memory_order_relaxed);
+
+	while(tail - this->pHead.load(std::memory_order_acquire) == this->pSlots.size())
+	{
+		if(this->pCancelled.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		std::this_thread::yield();
+	}
+
+	std::swap(this->pSlots[tail & this->pMask], batch);
+	this->pTail.store(tail + 1, std::memory_order_release);
+
+	return !this->pCancelled.load(std::memory_order_relaxed);
+}
+
+/**
+ * \brief take next batch, waits while the ring is empty
+ * \note returns false when the producer closed the ring and all batches were taken
+ */
+bool TokenRing::pop(Batch& batch)
+{
+	u64 head = this->pHead.load(std::memory_order_relaxed);
+
+	while(head == this->pTail.load(std::memory_order_acquire))
+	{
+		//batches published before closing are visible after seeing the flag
+		if(this->pClosed.load(std::memory_order_acquire))
+		{
+			if(head == this->pTail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			break;
+		}
+		std::this_thread::yield();
+	}
+
+	std::swap(this->pSlots[head & this->pMask], batch);
+	this->pHead.store(head + 1, std::memory_order_release);
+
+	return true;
+}
+
+/**
+ * \brief producer will not publish any more batches
+ */
+void TokenRing::close()
+{
+	this->pClosed.store(true, std::memory_order_release);
+}
+
+/**
+ * \brief consumer will not take any more batches
+ */
+void TokenRing::cancel()
+{
+	this->pCancelled.store(true, std::memory_order_release);
+}
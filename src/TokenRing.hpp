@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types.hpp"
+#include "Scanner.hpp"
+
+#include <vector>
+#include <atomic>
+
+/**
+ * \brief bounded lock-free single-producer/single-consumer ring of token batches
+ * \note batches are swapped in and out of the slots, so their memory is recycled
+ *       between the producer and the consumer
+ */
+class TokenRing
+{
+public:
+
+	using Batch = std::vector<Scanner::Token>;
+
+	/**
+	 * \brief create ring (capacity is rounded up to power of two)
+	 */
+	TokenRing(u64 capacity);
+
+	/**
+	 * \brief publish batch, waits while the ring is full
+	 * \note batch receives recycled memory, returns false when the consumer cancelled the ring
+	 */
+	bool push(Batch& batch);
+	/**
+	 * \brief take next batch, waits while the ring is empty
+	 * \note returns false when the producer closed the ring and all batches were taken
+	 */
+	bool pop(Batch& batch);
+
+	/**
+	 * \brief producer will not publish any more batches
+	 */
+	void close();
+	/**
+	 * \brief consumer will not take any more batches
+	 */
+	void cancel();
+
+private:
+
+	std::vector<Batch> pSlots;
+	u64                pMask;
+
+	//consumer and producer positions on separate cache lines
+	alignas(64) std::atomic<u64> pHead;
+	alignas(64) std::atomic<u64> pTail;
+
+	std::atomic<bool> pClosed;
+	std::atomic<bool> pCancelled;
+};
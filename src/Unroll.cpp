@@ -0,0 +1,559 @@
+#include "Unroll.hpp"
+#include "Operator.hpp"
+
+#include <algorithm>
+
+/**
+ * \brief unroll and peel loops of function (true when code changed)
+ * \note loops are found again after every change, loop containing a changed loop is left as it is
+ */
+bool Unroll::run(Codegen& code, u32 factor)
+{
+	this->pCode   = &code;
+	this->pBudget = UnrollBudget;
+	this->pDone.assign(code.blockCount(), 0);
+
+	bool changed = false;
+	bool found   = true;
+	while(found)
+	{
+		found = false;
+		this->pDom.run(code);
+		this->pLoops.run(code, this->pDom);
+		for(u32 l = 0; l < this->pLoops.count() && !found; l++)
+		{
+			const LoopItem& loop = this->pLoops.loop(l);
+			if(!this->candidate(loop))
+			{
+				continue;
+			}
+
+			//peeled copies leave into the exit block, its phis merge values of the copies
+			u32  size    = this->size(loop);
+			bool exit    = code.block(code.block(loop.header).succ[1]).predCount == 1;
+			Test test;
+			bool counted = this->induction(loop, test);
+			u32  trips   = counted ? this->trips(test) : IrNone;
+			if(exit && trips != IrNone && trips != 0 && trips * size <= UnrollFullSize && trips * size <= this->pBudget)
+			{
+				this->peel(loop, trips);
+				this->pBudget -= trips * size;
+				found          = true;
+			}
+			else if(exit && size <= UnrollPeelSize && size <= this->pBudget && this->foldable(loop))
+			{
+				this->peel(loop, 1);
+				this->pBudget -= size;
+				found          = true;
+			}
+			else if(factor > 1 && counted && (trips == IrNone || trips >= factor) && factor * size <= UnrollBodySize &&
+			        factor * size <= this->pBudget && this->unrollable(loop, test, factor))
+			{
+				this->unroll(loop, test, factor);
+				this->pBudget -= factor * size;
+				found          = true;
+			}
+
+			if(found)
+			{
+				this->pDone.resize(code.blockCount(), 1);
+				this->pDone[loop.header] = 1;
+				changed                  = true;
+			}
+		}
+	}
+
+	if(changed)
+	{
+		code.finish();
+	}
+	return changed;
+}
+
+/**
+ * \brief loop can be copied: preheader, one latch ending with jump, header with exit branch
+ *        (true when condition holds) which is the only exit, no block changed before
+ */
+bool Unroll::candidate(const LoopItem& loop)
+{
+	const Codegen& code   = *this->pCode;
+	IrId           header = loop.header;
+	if(loop.preheader == IrNone || loop.latch == IrNone || code.block(header).predCount != 2 ||
+	   code.inst(code.block(loop.latch).last).op != IrOp::Jump)
+	{
+		return false;
+	}
+	const IrBlock& h = code.block(header);
+	if(code.inst(h.last).op != IrOp::Branch || !this->pLoops.contains(loop, h.succ[0]) || this->pLoops.contains(loop, h.succ[1]))
+	{
+		return false;
+	}
+
+	const IrId* blocks = this->pLoops.blocks(loop);
+	for(u32 b = 0; b < loop.count; b++)
+	{
+		if(this->pDone[blocks[b]] != 0)
+		{
+			return false;
+		}
+		for(IrId s : code.block(blocks[b]).succ)
+		{
+			if(blocks[b] != header && s != IrNone && !this->pLoops.contains(loop, s))
+			{
+				return false;
+			}
+		}
+	}
+
+	u32 entry = code.edgeFrom(h.preds) == loop.preheader ? 0 : 1;
+	this->pPhis.clear();
+	this->pEntry.clear();
+	this->pNext.clear();
+	for(IrId i = h.first; i != IrNone; i = code.inst(i).next)
+	{
+		if(code.inst(i).op == IrOp::Phi)
+		{
+			this->pPhis.push_back(i);
+			this->pEntry.push_back(code.operand(i, entry));
+			this->pNext.push_back(code.operand(i, 1 - entry));
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief value is computed inside of loop
+ */
+bool Unroll::inside(const LoopItem& loop, IrId value) const
+{
+	return this->pLoops.contains(loop, this->pCode->inst(value).block);
+}
+
+/**
+ * \brief number of instructions of loop (without phis)
+ */
+u32 Unroll::size(const LoopItem& loop) const
+{
+	const Codegen& code   = *this->pCode;
+	const IrId*    blocks = this->pLoops.blocks(loop);
+	u32            size   = 0;
+	for(u32 b = 0; b < loop.count; b++)
+	{
+		for(IrId i = code.block(blocks[b]).first; i != IrNone; i = code.inst(i).next)
+		{
+			size += code.inst(i).op != IrOp::Phi ? 1 : 0;
+		}
+	}
+	return size;
+}
+
+/**
+ * \brief exit test of header compares basic induction variable (i = i + c or i = i - c
+ *        on the back edge) with value from outside of the loop
+ */
+bool Unroll::induction(const LoopItem& loop, Test& test) const
+{
+	const Codegen& code = *this->pCode;
+	IrId           cond = code.operand(code.block(loop.header).last, 0);
+	IrOp           op   = code.inst(cond).op;
+	if(!OperatorComparison(op))
+	{
+		return false;
+	}
+
+	for(u32 side = 0; side < 2; side++)
+	{
+		IrId phi   = code.operand(cond, side);
+		IrId bound = code.operand(cond, 1 - side);
+		u32  k     = std::find(this->pPhis.begin(), this->pPhis.end(), phi) - this->pPhis.begin();
+		if(k == this->pPhis.size() || this->inside(loop, bound))
+		{
+			continue;
+		}
+
+		IrId          next = this->pNext[k];
+		const IrInst& step = code.inst(next);
+		IrType        type = code.inst(phi).type;
+		if(type == IrType::F64 || code.inst(cond).type != type || (step.op != IrOp::Add && step.op != IrOp::Sub) ||
+		   step.type != type || code.operand(next, 0) != phi || code.inst(code.operand(next, 1)).op != IrOp::Const)
+		{
+			continue;
+		}
+		i64 c = code.inst(code.operand(next, 1)).imm.i;
+
+		test.phi   = k;
+		test.bound = bound;
+		test.step  = step.op == IrOp::Add ? c : (i64)(0 - (u64)c);
+		test.op    = side == 0     ? op        :
+		             op == IrOp::Lt ? IrOp::Gt :
+		             op == IrOp::Gt ? IrOp::Lt :
+		             op == IrOp::Le ? IrOp::Ge :
+		             op == IrOp::Ge ? IrOp::Le : op;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * \brief constant trip count (IrNone when it is unknown or greater than UnrollTrips)
+ * \note iterations are computed by the operator semantics, byte wraps around as at runtime
+ */
+u32 Unroll::trips(const Test& test) const
+{
+	const Codegen& code  = *this->pCode;
+	const IrInst&  init  = code.inst(this->pEntry[test.phi]);
+	const IrInst&  bound = code.inst(test.bound);
+	if(init.op != IrOp::Const || bound.op != IrOp::Const)
+	{
+		return IrNone;
+	}
+
+	bool          byte  = code.inst(this->pPhis[test.phi]).type == IrType::U8;
+	i64           value = init.imm.i;
+	OperatorValue r;
+	for(u32 n = 0; n <= UnrollTrips; n++)
+	{
+		bool folded = byte ? OperatorEval(test.op, (u8)value, (u8)bound.imm.i, r) : OperatorEval(test.op, value, bound.imm.i, r);
+		if(folded && r.i == 0)
+		{
+			return n;
+		}
+		if(byte)
+		{
+			OperatorEval(IrOp::Add, (u8)value, (u8)test.step, r);
+		}
+		else
+		{
+			OperatorEval(IrOp::Add, value, test.step, r);
+		}
+		value = r.i;
+	}
+	return IrNone;
+}
+
+/**
+ * \brief phi becomes constant after the first iteration and a branch of the loop tests it
+ */
+bool Unroll::foldable(const LoopItem& loop) const
+{
+	const Codegen& code   = *this->pCode;
+	const IrId*    blocks = this->pLoops.blocks(loop);
+	for(u32 k = 0; k < this->pPhis.size(); k++)
+	{
+		IrId phi = this->pPhis[k];
+		if(code.inst(this->pNext[k]).op != IrOp::Const)
+		{
+			continue;
+		}
+
+		for(u32 b = 0; b < loop.count; b++)
+		{
+			IrId last = code.block(blocks[b]).last;
+			if(code.inst(last).op != IrOp::Branch)
+			{
+				continue;
+			}
+			IrId cond = code.operand(last, 0);
+			if(cond == phi)
+			{
+				return true;
+			}
+			if(OperatorComparison(code.inst(cond).op))
+			{
+				IrId a = code.operand(cond, 0);
+				IrId c = code.operand(cond, 1);
+				if((a == phi && code.inst(c).op == IrOp::Const) || (c == phi && code.inst(a).op == IrOp::Const))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * \brief innermost loop whose header can run once more (it has no side effects) and whose
+ *        int induction variable moves toward the bound (the test passes for all iterations
+ *        of the unrolled loop at once)
+ */
+bool Unroll::unrollable(const LoopItem& loop, const Test& test, u32 factor) const
+{
+	const Codegen& code = *this->pCode;
+	bool           up   = (test.op == IrOp::Lt || test.op == IrOp::Le) && test.step > 0;
+	bool           down = (test.op == IrOp::Gt || test.op == IrOp::Ge) && test.step < 0;
+	if(code.inst(this->pPhis[test.phi]).type != IrType::I64 || (!up && !down) ||
+	   test.step <= -((i64)1 << 32) || test.step >= ((i64)1 << 32))
+	{
+		return false;
+	}
+
+	//constant bound of the unrolled loop must not overflow
+	i64           k     = (i64)(factor - 1) * test.step;
+	const IrInst& bound = code.inst(test.bound);
+	if(bound.op == IrOp::Const && (k > 0 ? bound.imm.i < INT64_MIN + k : bound.imm.i > INT64_MAX + k))
+	{
+		return false;
+	}
+
+	for(IrId i = code.block(loop.header).first; i != IrNone; i = code.inst(i).next)
+	{
+		IrOp op = code.inst(i).op;
+		if(op == IrOp::Call || op == IrOp::Store || op == IrOp::Copy)
+		{
+			return false;
+		}
+	}
+
+	for(u32 l = 0; l < this->pLoops.count(); l++)
+	{
+		IrId header = this->pLoops.loop(l).header;
+		if(header != loop.header && this->pLoops.contains(loop, header))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief copy of loop blocks starting with values entry of header phis
+ */
+void Unroll::copy(const LoopItem& loop, const IrId* entry, IrId header, bool test)
+{
+	Codegen&    code   = *this->pCode;
+	const IrId* blocks = this->pLoops.blocks(loop);
+
+	this->pValue.assign(code.instCount(), IrNone);
+	this->pBlock.assign(code.blockCount(), IrNone);
+	for(u32 b = 0; b < loop.count; b++)
+	{
+		this->pBlock[blocks[b]] = b == 0 && header != IrNone ? header : code.copyBlock(blocks[b]);
+	}
+	for(u32 k = 0; k < this->pPhis.size(); k++)
+	{
+		this->pValue[this->pPhis[k]] = entry[k];
+	}
+
+	//edges come first, copied phis have all their operands
+	for(u32 b = 0; b < loop.count; b++)
+	{
+		for(IrId s : code.block(blocks[b]).succ)
+		{
+			if(s != IrNone && s != loop.header && this->pLoops.contains(loop, s))
+			{
+				code.addEdge(this->pBlock[blocks[b]], this->pBlock[s]);
+			}
+		}
+	}
+
+	for(u32 b = 0; b < loop.count; b++)
+	{
+		IrId from = blocks[b];
+		IrId to   = this->pBlock[from];
+		for(IrId i = code.block(from).first; i != IrNone; i = code.inst(i).next)
+		{
+			if(from == loop.header && code.inst(i).op == IrOp::Phi)
+			{
+				continue;
+			}
+			//exit test is known to pass, header jumps into the body
+			if(from == loop.header && i == code.block(from).last && !test)
+			{
+				code.copy(code.block(loop.latch).last, to);
+				continue;
+			}
+			this->pValue[i] = code.copy(i, to);
+		}
+	}
+
+	//operands of copies are copies, phi operands follow predecessors of the copied block
+	for(u32 b = 0; b < loop.count; b++)
+	{
+		IrId from = blocks[b];
+		for(IrId i = code.block(from).first; i != IrNone; i = code.inst(i).next)
+		{
+			IrId c = this->pValue[i];
+			if(c == IrNone || (from == loop.header && code.inst(i).op == IrOp::Phi))
+			{
+				continue;
+			}
+			if(code.inst(i).op != IrOp::Phi)
+			{
+				for(u32 o = 0; o < code.inst(i).count; o++)
+				{
+					code.setOperand(c, o, this->value(code.operand(i, o)));
+				}
+				continue;
+			}
+
+			u32 o = 0;
+			for(u32 e = code.block(this->pBlock[from]).preds; e != IrNone; e = code.edgeNext(e), o++)
+			{
+				IrId pred = *std::find_if(blocks, blocks + loop.count, [this, &code, e](IrId x)
+				{
+					return this->pBlock[x] == code.edgeFrom(e);
+				});
+				u32 index = 0;
+				for(u32 p = code.block(from).preds; code.edgeFrom(p) != pred; p = code.edgeNext(p))
+				{
+					index++;
+				}
+				code.setOperand(c, o, this->value(code.operand(i, index)));
+			}
+		}
+	}
+
+	this->pCopyHeader = this->pBlock[loop.header];
+	this->pCopyLatch  = this->pBlock[loop.latch];
+}
+
+/**
+ * \brief edge into header of loop with values of its phis
+ */
+void Unroll::connect(IrId from, IrId header, const IrId* phis, const IrId* values)
+{
+	u32 index = this->pCode->addEdge(from, header);
+	for(u32 k = 0; k < this->pPhis.size(); k++)
+	{
+		this->pCode->setOperand(phis[k], index, values[k]);
+	}
+}
+
+/**
+ * \brief copies of the first count iterations run before the loop
+ */
+void Unroll::peel(const LoopItem& loop, u32 count)
+{
+	Codegen& code = *this->pCode;
+	IrId     exit = code.block(loop.header).succ[1];
+
+	//header values used after the loop are merged with their copies in the exit block
+	this->pLive.clear();
+	this->pMerged.clear();
+	IrId created = code.instCount();
+	for(IrId b = 0; b < code.blockCount(); b++)
+	{
+		if(this->pLoops.contains(loop, b))
+		{
+			continue;
+		}
+		for(IrId i = code.block(b).first; i != IrNone; i = code.inst(i).next)
+		{
+			for(u32 o = 0; o < code.inst(i).count && i < created; o++)
+			{
+				IrId v = code.operand(i, o);
+				if(v == IrNone || code.inst(v).block != loop.header)
+				{
+					continue;
+				}
+				u32 k = std::find(this->pLive.begin(), this->pLive.end(), v) - this->pLive.begin();
+				if(k == this->pLive.size())
+				{
+					this->pLive.push_back(v);
+					this->pMerged.push_back(code.phi(exit, code.valueType(v), &v, 1));
+				}
+				code.setOperand(i, o, this->pMerged[k]);
+			}
+		}
+	}
+
+	this->pValues = this->pEntry;
+	IrId first    = IrNone;
+	IrId latch    = IrNone;
+	for(u32 n = 0; n < count; n++)
+	{
+		this->copy(loop, this->pValues.data(), IrNone, true);
+		if(latch == IrNone)
+		{
+			first = this->pCopyHeader;
+		}
+		else
+		{
+			code.addEdge(latch, this->pCopyHeader);
+		}
+		latch = this->pCopyLatch;
+
+		u32 index = code.addEdge(this->pCopyHeader, exit);
+		for(u32 j = 0; j < this->pLive.size(); j++)
+		{
+			code.setOperand(this->pMerged[j], index, this->value(this->pLive[j]));
+		}
+		for(u32 k = 0; k < this->pPhis.size(); k++)
+		{
+			this->pValues[k] = this->value(this->pNext[k]);
+		}
+	}
+
+	this->connect(latch, loop.header, this->pPhis.data(), this->pValues.data());
+	code.retarget(loop.preheader, loop.header, first);
+}
+
+/**
+ * \brief loop unrolled by factor runs before the original loop
+ */
+void Unroll::unroll(const LoopItem& loop, const Test& test, u32 factor)
+{
+	Codegen& code = *this->pCode;
+	IrId     jump = code.block(loop.preheader).last;
+	IrId     n    = test.bound;
+	i64      k    = (i64)(factor - 1) * test.step;
+
+	//all iterations pass when i < n - k (i > n - k going down), the original loop runs alone when n - k overflows
+	IrId limit = IrNone;
+	IrId guard = IrNone;
+	if(code.inst(n).op == IrOp::Const)
+	{
+		limit = this->constant(jump, (i64)((u64)code.inst(n).imm.i - (u64)k));
+	}
+	else
+	{
+		IrId sub[2] = { n, this->constant(jump, k) };
+		IrId cmp[2] = { n, this->constant(jump, k > 0 ? INT64_MIN + k : INT64_MAX + k) };
+		limit       = code.insert(jump, IrOp::Sub, IrType::I64, sub, 2);
+		guard       = code.insert(jump, k > 0 ? IrOp::Lt : IrOp::Gt, IrType::I64, cmp, 2);
+	}
+
+	IrId header = code.copyBlock(loop.header);
+	this->pUnrolled.clear();
+	for(IrId p : this->pPhis)
+	{
+		this->pUnrolled.push_back(code.phi(header, code.inst(p).type, nullptr, 0));
+	}
+	this->copy(loop, this->pUnrolled.data(), header, true);
+	IrId branch = code.block(header).last;
+	IrId cmp[2] = { this->pUnrolled[test.phi], limit };
+	code.setOperand(branch, 0, code.insert(branch, test.op, IrType::I64, cmp, 2));
+
+	this->pValues.resize(this->pPhis.size());
+	for(u32 f = 0; f < factor; f++)
+	{
+		for(u32 p = 0; p < this->pPhis.size(); p++)
+		{
+			this->pValues[p] = this->value(this->pNext[p]);
+		}
+		if(f == factor - 1)
+		{
+			break;
+		}
+		IrId latch = this->pCopyLatch;
+		this->copy(loop, this->pValues.data(), IrNone, false);
+		code.addEdge(latch, this->pCopyHeader);
+	}
+	this->connect(this->pCopyLatch, header, this->pUnrolled.data(), this->pValues.data());
+	//the unrolled loop leaves into the original loop, which runs the remaining iterations
+	this->connect(header, loop.header, this->pPhis.data(), this->pUnrolled.data());
+
+	u32 index = guard != IrNone ? code.addBranch(loop.preheader, guard, header) : code.retarget(loop.preheader, loop.header, header);
+	for(u32 p = 0; p < this->pPhis.size(); p++)
+	{
+		code.setOperand(this->pUnrolled[p], index, this->pEntry[p]);
+	}
+}
+
+IrId Unroll::constant(IrId before, i64 value)
+{
+	IrId id = this->pCode->insert(before, IrOp::Const, IrType::I64, nullptr, 0);
+	this->pCode->setConstant(id, IrType::I64, value);
+	return id;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "types.hpp"
+#include "Codegen.hpp"
+#include "Dominator.hpp"
+#include "Loops.hpp"
+
+#include <vector>
+
+/**
+ * \brief limits of unrolling
+ * \note loop with constant trip count up to UnrollTrips is unrolled fully when all its copies have
+ *       at most UnrollFullSize instructions, loop is peeled when it has at most UnrollPeelSize
+ *       instructions and the copies of partially unrolled loop have at most UnrollBodySize,
+ *       one function grows by at most UnrollBudget instructions, factor of partial unrolling
+ *       is at most UnrollMaxFactor
+ */
+static constexpr u32 UnrollTrips     = 16;
+static constexpr u32 UnrollFullSize  = 128;
+static constexpr u32 UnrollPeelSize  = 32;
+static constexpr u32 UnrollBodySize  = 64;
+static constexpr u32 UnrollBudget    = 256;
+static constexpr u32 UnrollMaxFactor = 16;
+
+/**
+ * \brief loop unrolling and peeling
+ * \note loop is copied when it has preheader, one latch ending with jump and header whose branch
+ *       is the only exit. Copy of iteration starts with values of header phis and its values at
+ *       the end of the latch start the next one. Peeled copies run before the loop and leave into
+ *       its exit block, where phis merge header values used after the loop, so loop whose exit test
+ *       compares induction variable with constant is unrolled fully by peeling all its iterations,
+ *       and loop whose phi becomes constant after the first iteration is peeled once when a branch
+ *       tests it. Innermost loop whose header without side effects compares induction variable
+ *       with invariant bound is unrolled by factor: the unrolled loop tests once that all factor
+ *       iterations pass (i < n - (factor - 1) * step, chosen in preheader only when the bound
+ *       doesn't overflow) and leaves into the original loop, which runs the remaining iterations.
+ *       Constant exit tests and phis of the copies are folded by sparse conditional constant
+ *       propagation after the pass.
+ */
+class Unroll
+{
+public:
+	/**
+	 * \brief unroll and peel loops of function (true when code changed)
+	 */
+	bool run(Codegen& code, u32 factor);
+
+private:
+	/**
+	 * \brief exit test of header, comparison of induction variable (index of phi) with bound
+	 *        stepped by step every iteration (op has the induction variable on the left)
+	 */
+	struct Test
+	{
+		u32  phi;
+		IrOp op;
+		IrId bound;
+		i64  step;
+	};
+
+	bool candidate(const LoopItem& loop);
+	bool inside(const LoopItem& loop, IrId value) const;
+	u32  size(const LoopItem& loop) const;
+	bool induction(const LoopItem& loop, Test& test) const;
+	/**
+	 * \brief constant trip count (IrNone when it is unknown or greater than UnrollTrips)
+	 */
+	u32  trips(const Test& test) const;
+	bool foldable(const LoopItem& loop) const;
+	bool unrollable(const LoopItem& loop, const Test& test, u32 factor) const;
+
+	/**
+	 * \brief copy of loop blocks starting with values entry of header phis
+	 * \note edges inside of the copy are added, exit of header and jump of latch are left
+	 *       to the caller, copy of header without test jumps into the body,
+	 *       header is copied into block header (IrNone = new block)
+	 */
+	void copy(const LoopItem& loop, const IrId* entry, IrId header, bool test);
+	IrId value(IrId id) const { return this->pValue[id] != IrNone ? this->pValue[id] : id; }
+	/**
+	 * \brief edge into header of loop with values of its phis
+	 */
+	void connect(IrId from, IrId header, const IrId* phis, const IrId* values);
+	void peel(const LoopItem& loop, u32 count);
+	void unroll(const LoopItem& loop, const Test& test, u32 factor);
+	IrId constant(IrId before, i64 value);
+
+	Codegen*          pCode;
+	Dominator         pDom;
+	Loops             pLoops;
+	u32               pBudget;
+
+	//phis of the header, their values from preheader and from latch
+	std::vector<IrId> pPhis;
+	std::vector<IrId> pEntry;
+	std::vector<IrId> pNext;
+	//values of iteration being copied, phis of unrolled loop
+	std::vector<IrId> pValues;
+	std::vector<IrId> pUnrolled;
+
+	//copy of every instruction and block of the loop, header and latch of the last copy
+	std::vector<IrId> pValue;
+	std::vector<IrId> pBlock;
+	IrId              pCopyHeader;
+	IrId              pCopyLatch;
+
+	//header values used after peeled loop and their phis in exit block
+	std::vector<IrId> pLive;
+	std::vector<IrId> pMerged;
+
+	//blocks of unrolled loops and their copies are not unrolled again
+	std::vector<u8>   pDone;
+};
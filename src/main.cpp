@@ -2,17 +2,137 @@
 #include "Parser.hpp"
 #include "Preprocessor.hpp"
 
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+
 int main(int argc, char* argv[])
 {
+	//parser options
+	u64  jobs      = 1;
+	bool lazy      = false;
+	u64  maxErrors = 20;
+	u64  unroll    = 4;
+	bool pipeline  = false;
+	bool stream    = false;
+	bool reorder   = false;
+	EmitterSink   sink   = EmitterSink::Text;
+	const Target* target = &Targets[0];
+
+	//input and output file names
+	const char* files[2] = { nullptr, nullptr };
+	u64         filesNum = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		//-j N or -jN: number of threads parsing function bodies (0 = all cores)
+		if(std::strncmp(argv[i], "-j", 2) == 0)
+		{
+			const char* value = argv[i][2] != '\0' ? &argv[i][2] : (i + 1 < argc ? argv[++i] : "");
+			char*       end   = nullptr;
+
+			jobs = std::strtoull(value, &end, 10);
+			if(*value == '\0' || *end != '\0')
+			{
+				std::printf("error: invalid number of jobs\n");
+				return 1;
+			}
+			if(jobs == 0)
+			{
+				jobs = std::thread::hardware_concurrency() != 0 ? std::thread::hardware_concurrency() : 1;
+			}
+		}
+		//--lazy: compile only function bodies reachable from main
+		else if(std::strcmp(argv[i], "--lazy") == 0)
+		{
+			lazy = true;
+		}
+		//--pipeline: preprocess and scan on separate thread
+		else if(std::strcmp(argv[i], "--pipeline") == 0)
+		{
+			pipeline = true;
+		}
+		//--stream: write code of every function into output file as soon as it is parsed
+		else if(std::strcmp(argv[i], "--stream") == 0)
+		{
+			stream = true;
+		}
+		//--pack-reorder: place package items by decreasing alignment
+		else if(std::strcmp(argv[i], "--pack-reorder") == 0)
+		{
+			reorder = true;
+		}
+		//--emit text|binary|null: format of output file
+		else if(std::strcmp(argv[i], "--emit") == 0)
+		{
+			const char* value = i + 1 < argc ? argv[++i] : "";
+
+			if(std::strcmp(value, "text") == 0)        { sink = EmitterSink::Text; }
+			else if(std::strcmp(value, "binary") == 0) { sink = EmitterSink::Binary; }
+			else if(std::strcmp(value, "null") == 0)   { sink = EmitterSink::Null; }
+			else
+			{
+				std::printf("error: invalid output format\n");
+				return 1;
+			}
+		}
+		//--target NAME: target architecture (silent, silent-small, silent-wide)
+		else if(std::strcmp(argv[i], "--target") == 0)
+		{
+			target = TargetFind(i + 1 < argc ? argv[++i] : "");
+			if(target == nullptr)
+			{
+				std::printf("error: unknown target\n");
+				return 1;
+			}
+		}
+		//--max-errors N: stop after N errors (1 = stop at the first error)
+		else if(std::strcmp(argv[i], "--max-errors") == 0)
+		{
+			const char* value = i + 1 < argc ? argv[++i] : "";
+			char*       end   = nullptr;
+
+			maxErrors = std::strtoull(value, &end, 10);
+			if(*value == '\0' || *end != '\0' || maxErrors == 0)
+			{
+				std::printf("error: invalid number of errors\n");
+				return 1;
+			}
+		}
+		//--unroll N: factor of partial loop unrolling (1 = loops are only unrolled fully and peeled)
+		else if(std::strcmp(argv[i], "--unroll") == 0)
+		{
+			const char* value = i + 1 < argc ? argv[++i] : "";
+			char*       end   = nullptr;
+
+			unroll = std::strtoull(value, &end, 10);
+			if(*value == '\0' || *end != '\0' || unroll == 0 || unroll > UnrollMaxFactor)
+			{
+				std::printf("error: invalid unroll factor\n");
+				return 1;
+			}
+		}
+		else if(filesNum < 2)
+		{
+			files[filesNum++] = argv[i];
+		}
+		else
+		{
+			filesNum = 0;
+			break;
+		}
+	}
+
 	//check number of arguments
-	if(argc < 2)
+	if(filesNum < 1)
 	{
-		std::printf("silang [input.sil] [optional: out.silcode]\n");
+		std::printf("silang [-j jobs] [--lazy] [--pipeline] [--stream] [--pack-reorder] [--emit text|binary|null] [--target name] [--max-errors n] [--unroll n] [input.sil] [optional: out.silcode]\n");
 		return 1;
 	}
 	
 	//open input
-	FILE* in = std::fopen(argv[1], "rb");
+	FILE* in = std::fopen(files[0], "rb");
 	if(in == NULL)
 	{
 		std::printf("error: cannot open input file\n");
@@ -21,10 +141,10 @@ int main(int argc, char* argv[])
 
 	//open output
 	FILE* out;
-	if(argc == 3)
+	if(filesNum == 2)
 	{
 		//open specified output
-		out = std::fopen(argv[2], "wb");
+		out = std::fopen(files[1], "wb");
 	}
 	else
 	{
@@ -39,28 +159,62 @@ int main(int argc, char* argv[])
 
 	//preprocess the input file
 	//and output the result into a temporary file
-	//which will be used as parser input
-	FILE* preprocessed_file = fopen("/tmp/tmp.sil", "w+b");
+	//which will be used as parser input,
+	//the file is private to this compilation and removed when closed
+	FILE* preprocessed_file = std::tmpfile();
 	if(preprocessed_file == NULL)
 	{
-		std::printf("error: cannot access /tmp/tmp.sil file\n");
+		std::printf("error: cannot create temporary file\n");
+		return 1;
 	}
+	//diagnostics are reported at positions in source files
+	SourceMap     map;
 	Preprocessor* preprocessor = new Preprocessor();
+	bool          failed       = false;
+	preprocessor->setSourceMap(&map);
 
+	//pipelined parsing preprocesses and scans on producer thread
+	if(pipeline)
+	{
+		Parser* parser = new Parser();
+		parser->setJobs(jobs);
+		parser->setLazy(lazy);
+		parser->setMaxErrors(maxErrors);
+		parser->setUnroll(unroll);
+		parser->setStream(stream);
+		parser->setPackReorder(reorder);
+		parser->setSink(sink);
+		parser->setTarget(target);
+		parser->setSourceMap(&map);
+		parser->setPipeline(true, [&]() { return preprocessor->preprocess(in, preprocessed_file, files[0]); });
+		failed = parser->parse(preprocessed_file, out).type != Error::Type::Ok;
+		delete parser;
+	}
 	//do the preprocessing
-	bool succ = preprocessor->preprocess(in, preprocessed_file);
-
 	//if preprocessor generated no errors we can start parsing
-	if(succ == true)
+	else if(preprocessor->preprocess(in, preprocessed_file, files[0]) == true)
 	{
 		//reset file seeker
 		std::fseek(preprocessed_file, 0, SEEK_SET);
 
 		//start parsing
 		Parser* parser = new Parser();
-		parser->parse(preprocessed_file, out);
+		parser->setJobs(jobs);
+		parser->setLazy(lazy);
+		parser->setMaxErrors(maxErrors);
+		parser->setUnroll(unroll);
+		parser->setStream(stream);
+		parser->setPackReorder(reorder);
+		parser->setSink(sink);
+		parser->setTarget(target);
+		parser->setSourceMap(&map);
+		failed = parser->parse(preprocessed_file, out).type != Error::Type::Ok;
 		delete parser;
 	}
+	else
+	{
+		failed = true;
+	}
 
 	//cleanup
 	delete preprocessor;
@@ -68,6 +222,9 @@ int main(int argc, char* argv[])
 	std::fclose(preprocessed_file);
 	std::fclose(in);
 	std::fclose(out);
+
+	//errors were reported, the output is not complete
+	return failed ? 1 : 0;
 }
 
 
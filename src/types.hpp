@@ -15,17 +15,6 @@ using i8  = int8_t;
 using f64 = double;
 using f32 = float;
 
-/**
- * \brief define number of registers which can be used for evaluating expression
- */
-#ifndef ARCH
-	#error "Architecture not specified"
-#elif ARCH == SILENT
-	#define ARCH_REG_NUM 16
-#elif
-	#error "Unknown architecture"
-#endif
-
 /**
  * \brief custom extension
  */
@@ -0,0 +1,128 @@
+#!/bin/sh
+# regression tests (make test): ./test/run.sh ./silang ./out/silrun
+#
+# every test/cases/*.sil is compiled into text and .silcode, directives in its comments
+# say what is expected:
+#
+#   # options: OPTIONS        extra options of the compiler
+#   # run: ARGS => VALUES     silrun of the program with arguments of main prints values
+#   # check: REGEX            printed code has a line matching the regex (grep -E)
+#   # check-not: REGEX        printed code has no line matching the regex
+#   # count: N REGEX          printed code has N lines matching the regex
+#   # error: TEXT             compiler reports TEXT and fails
+#   # error-not: TEXT         compiler doesn't report TEXT (errors of failed compilation)
+#
+# parallel, pipelined and streaming compilation must report the same diagnostics as the default
+# mode and print the same code (output of failed compilation is not complete, it is not compared),
+# lazy compilation (only reachable functions) must run the same.
+
+SILANG=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+SILRUN=$(cd "$(dirname "$2")" && pwd)/$(basename "$2")
+CASES=$(cd "$(dirname "$0")" && pwd)/cases
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+passed=0
+failed=0
+
+fail()
+{
+	echo "FAIL $name: $1"
+	if [ $ok = 1 ]; then
+		failed=$((failed + 1))
+	fi
+	ok=0
+}
+
+# directive lines of the case (text after "# name:")
+directives()
+{
+	sed -n "s/^# $1: //p" "$file"
+}
+
+# compile case with options into $WORK/$2, status and diagnostics into $WORK/$2.log
+compile()
+{
+	(cd "$CASES" && "$SILANG" $options $1 "$file" "$WORK/$2" > "$WORK/$2.log" 2>&1)
+	echo $? >> "$WORK/$2.log"
+}
+
+# run every run: directive of the program compiled with mode
+run()
+{
+	compile "--emit binary $1" "$2.silcode"
+	directives run | while IFS= read -r line; do
+		args=$(echo ${line%%=>*})
+		expected=$(echo ${line#*=>})
+		actual=$(echo $("$SILRUN" "$WORK/$2.silcode" $args 2>&1))
+		if [ "$actual" != "$expected" ]; then
+			echo "run $2 ($args): expected '$expected', got '$actual'"
+		fi
+	done > "$WORK/$2.run"
+	if [ -s "$WORK/$2.run" ]; then
+		fail "$(cat "$WORK/$2.run")"
+	fi
+}
+
+for file in "$CASES"/*.sil; do
+	name=$(basename "$file" .sil)
+	options=$(directives options)
+	ok=1
+
+	compile "" default.txt
+	status=$(tail -n 1 "$WORK/default.txt.log")
+	for mode in "-j 3" "--pipeline" "-j 3 --pipeline" "--stream"; do
+		compile "$mode" mode.txt
+		if ! cmp -s "$WORK/default.txt.log" "$WORK/mode.txt.log"; then
+			fail "$mode reports other diagnostics than default mode"
+		elif [ "$status" = 0 ] && ! cmp -s "$WORK/default.txt" "$WORK/mode.txt"; then
+			fail "$mode prints other code than default mode"
+		fi
+	done
+
+	errors=$(directives error)
+	if [ -n "$errors" ]; then
+		if [ "$status" = 0 ]; then
+			fail "compilation succeeded"
+		fi
+		echo "$errors" | while IFS= read -r text; do
+			grep -qF -- "$text" "$WORK/default.txt.log" || echo "missing error '$text'"
+		done > "$WORK/errors"
+		directives error-not | while IFS= read -r text; do
+			! grep -qF -- "$text" "$WORK/default.txt.log" || echo "unexpected error '$text'"
+		done >> "$WORK/errors"
+		if [ -s "$WORK/errors" ]; then
+			fail "$(cat "$WORK/errors")"
+		fi
+	elif [ "$status" != 0 ]; then
+		fail "compilation failed: $(cat "$WORK/default.txt.log")"
+	else
+		directives check | while IFS= read -r regex; do
+			grep -qE -- "$regex" "$WORK/default.txt" || echo "no match of '$regex'"
+		done > "$WORK/checks"
+		directives check-not | while IFS= read -r regex; do
+			! grep -qE -- "$regex" "$WORK/default.txt" || echo "unexpected match of '$regex'"
+		done >> "$WORK/checks"
+		directives count | while IFS= read -r line; do
+			count=${line%% *}
+			regex=${line#* }
+			actual=$(grep -cE -- "$regex" "$WORK/default.txt")
+			[ "$actual" = "$count" ] || echo "$actual matches of '$regex', expected $count"
+		done >> "$WORK/checks"
+		if [ -s "$WORK/checks" ]; then
+			fail "$(cat "$WORK/checks")"
+		fi
+
+		run "" default
+		run "-j 3" parallel
+		run "--lazy" lazy
+		run "-j 3 --lazy" lazy-parallel
+	fi
+
+	if [ $ok = 1 ]; then
+		passed=$((passed + 1))
+	fi
+done
+
+echo "$passed passed, $failed failed"
+[ $failed = 0 ]
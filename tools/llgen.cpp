@@ -0,0 +1,725 @@
+/**
+ * \brief LL(1) parse table generator
+ * \note reads ll.grammar, computes FIRST and FOLLOW sets and writes header
+ *       with constexpr parse table and list of semantic actions for the parser
+ *
+ *       usage: llgen ll.grammar ParserTable.hpp
+ */
+#include <cstdio>
+#include <cstdint>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <fstream>
+#include <sstream>
+
+/**
+ * \brief grammar symbol
+ */
+struct Symbol
+{
+	enum class Kind { Terminal, NonTerminal, Action } kind;
+	size_t index;
+};
+
+/**
+ * \brief terminal declared with %token
+ */
+struct Terminal
+{
+	std::string spelling;
+	std::string name;
+	std::string display;
+};
+
+/**
+ * \brief nonterminal with its productions
+ */
+struct NonTerminal
+{
+	std::string      spelling;
+	std::string      name;
+	//parsed by semantic action
+	bool             external = false;
+	size_t           action   = 0;
+	//FIRST set of external rule
+	std::vector<std::string> externalFirst;
+
+	std::set<size_t> first;
+	std::set<size_t> follow;
+	bool             nullable = false;
+};
+
+/**
+ * \brief production
+ */
+struct Production
+{
+	size_t              lhs;
+	std::vector<Symbol> rhs;
+	size_t              line;
+};
+
+static std::vector<Terminal>    gTerminals;
+static std::vector<NonTerminal> gNonTerminals;
+static std::vector<std::string> gActions;
+static std::vector<Production>  gProductions;
+
+static std::map<std::string, size_t> gTerminalIndex;
+static std::map<std::string, size_t> gNonTerminalIndex;
+static std::map<std::string, size_t> gActionIndex;
+
+/**
+ * \brief convert <def-args-list> or @funcName to DefArgsList or FuncName
+ */
+static std::string LLGenName(const std::string& spelling)
+{
+	std::string name;
+	bool        upper = true;
+
+	for(char c : spelling)
+	{
+		if(c == '<' || c == '>' || c == '@')
+		{
+			continue;
+		}
+		if(c == '-' || c == '_')
+		{
+			upper = true;
+			continue;
+		}
+
+		name.push_back(upper ? (char)std::toupper(c) : c);
+		upper = false;
+	}
+
+	return name;
+}
+
+/**
+ * \brief find or create nonterminal
+ */
+static size_t LLGenNonTerminal(const std::string& spelling)
+{
+	auto it = gNonTerminalIndex.find(spelling);
+	if(it != gNonTerminalIndex.end())
+	{
+		return it->second;
+	}
+
+	NonTerminal n;
+	n.spelling = spelling;
+	n.name     = LLGenName(spelling);
+
+	gNonTerminals.push_back(n);
+	return gNonTerminalIndex[spelling] = gNonTerminals.size() - 1;
+}
+
+/**
+ * \brief find or create semantic action
+ */
+static size_t LLGenAction(const std::string& spelling)
+{
+	auto it = gActionIndex.find(spelling);
+	if(it != gActionIndex.end())
+	{
+		return it->second;
+	}
+
+	gActions.push_back(LLGenName(spelling));
+	return gActionIndex[spelling] = gActions.size() - 1;
+}
+
+/**
+ * \brief remove comments from grammar source
+ */
+static std::string LLGenStripComments(const std::string& source)
+{
+	std::string result;
+
+	for(size_t i = 0; i < source.size(); i++)
+	{
+		if(source.compare(i, 2, "/*") == 0)
+		{
+			size_t end = source.find("*/", i + 2);
+			//keep new lines so the line numbers stay valid
+			for(size_t j = i; j < end && j < source.size(); j++)
+			{
+				if(source[j] == '\n')
+				{
+					result.push_back('\n');
+				}
+			}
+			i = (end == std::string::npos) ? source.size() : end + 1;
+		}
+		else if(source.compare(i, 2, "//") == 0)
+		{
+			while(i < source.size() && source[i] != '\n')
+			{
+				i++;
+			}
+			result.push_back('\n');
+		}
+		else
+		{
+			result.push_back(source[i]);
+		}
+	}
+
+	return result;
+}
+
+/**
+ * \brief split line into words, "quoted words" may contain escaped quotes and spaces
+ */
+static std::vector<std::string> LLGenWords(const std::string& line)
+{
+	std::vector<std::string> words;
+
+	size_t i = 0;
+	while(i < line.size())
+	{
+		if(std::isspace((unsigned char)line[i]))
+		{
+			i++;
+		}
+		else if(line[i] == '"')
+		{
+			std::string word;
+			for(i++; i < line.size() && line[i] != '"'; i++)
+			{
+				if(line[i] == '\\' && i + 1 < line.size())
+				{
+					i++;
+				}
+				word.push_back(line[i]);
+			}
+			words.push_back(word);
+			i++;
+		}
+		else
+		{
+			std::string word;
+			while(i < line.size() && !std::isspace((unsigned char)line[i]))
+			{
+				word.push_back(line[i++]);
+			}
+			words.push_back(word);
+		}
+	}
+
+	return words;
+}
+
+/**
+ * \brief load grammar file
+ */
+static bool LLGenLoad(const char* path)
+{
+	std::ifstream file(path);
+	if(!file)
+	{
+		std::fprintf(stderr, "llgen: cannot open %s\n", path);
+		return false;
+	}
+
+	std::stringstream content;
+	content << file.rdbuf();
+
+	std::stringstream source(LLGenStripComments(content.str()));
+	std::string       line;
+	size_t            lineNum = 0;
+
+	//productions are resolved after all declarations are known
+	std::vector<std::pair<size_t, std::vector<std::string>>> productions;
+
+	while(std::getline(source, line))
+	{
+		lineNum++;
+
+		std::vector<std::string> words = LLGenWords(line);
+		if(words.size() == 0)
+		{
+			continue;
+		}
+
+		if(words[0] == "%token")
+		{
+			if(words.size() != 4)
+			{
+				std::fprintf(stderr, "llgen: %s:%zu: expected %%token TERM enumerator \"display name\"\n", path, lineNum);
+				return false;
+			}
+
+			gTerminals.push_back({ words[1], words[2], words[3] });
+			gTerminalIndex[words[1]] = gTerminals.size() - 1;
+		}
+		else if(words[0] == "%external")
+		{
+			if(words.size() < 4 || words[1][0] != '<' || words[2][0] != '@')
+			{
+				std::fprintf(stderr, "llgen: %s:%zu: expected %%external <rule> @action FIRST...\n", path, lineNum);
+				return false;
+			}
+
+			NonTerminal& n = gNonTerminals[LLGenNonTerminal(words[1])];
+			n.external      = true;
+			n.action        = LLGenAction(words[2]);
+			n.externalFirst = std::vector<std::string>(words.begin() + 3, words.end());
+		}
+		else if(words.size() >= 2 && words[1] == "->")
+		{
+			productions.push_back({ lineNum, words });
+		}
+		else
+		{
+			std::fprintf(stderr, "llgen: %s:%zu: unexpected line\n", path, lineNum);
+			return false;
+		}
+	}
+
+	for(auto& p : productions)
+	{
+		std::vector<std::string>& words = p.second;
+
+		size_t lhs = LLGenNonTerminal(words[0]);
+
+		//productions of external rules are documentation only
+		if(gNonTerminals[lhs].external)
+		{
+			continue;
+		}
+
+		Production production;
+		production.lhs  = lhs;
+		production.line = p.first;
+
+		for(size_t i = 2; i < words.size(); i++)
+		{
+			const std::string& w = words[i];
+
+			if(w.size() > 2 && w.front() == '<' && w.back() == '>')
+			{
+				production.rhs.push_back({ Symbol::Kind::NonTerminal, LLGenNonTerminal(w) });
+			}
+			else if(w.size() > 1 && w.front() == '@')
+			{
+				production.rhs.push_back({ Symbol::Kind::Action, LLGenAction(w) });
+			}
+			else if(gTerminalIndex.find(w) != gTerminalIndex.end())
+			{
+				production.rhs.push_back({ Symbol::Kind::Terminal, gTerminalIndex[w] });
+			}
+			else
+			{
+				std::fprintf(stderr, "llgen: %s:%zu: undeclared terminal %s\n", path, p.first, w.c_str());
+				return false;
+			}
+		}
+
+		gProductions.push_back(production);
+	}
+
+	//every used nonterminal must have productions or be external
+	for(NonTerminal& n : gNonTerminals)
+	{
+		bool defined = n.external;
+		for(Production& p : gProductions)
+		{
+			defined |= &gNonTerminals[p.lhs] == &n;
+		}
+		if(!defined)
+		{
+			std::fprintf(stderr, "llgen: %s: rule %s has no productions\n", path, n.spelling.c_str());
+			return false;
+		}
+	}
+
+	if(gProductions.size() == 0)
+	{
+		std::fprintf(stderr, "llgen: %s: no productions\n", path);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * \brief FIRST set of symbol sequence, returns true if the sequence is nullable
+ */
+static bool LLGenFirst(const std::vector<Symbol>& rhs, size_t from, std::set<size_t>& first)
+{
+	for(size_t i = from; i < rhs.size(); i++)
+	{
+		const Symbol& s = rhs[i];
+
+		if(s.kind == Symbol::Kind::Terminal)
+		{
+			first.insert(s.index);
+			return false;
+		}
+		if(s.kind == Symbol::Kind::NonTerminal)
+		{
+			NonTerminal& n = gNonTerminals[s.index];
+			first.insert(n.first.begin(), n.first.end());
+			if(!n.nullable)
+			{
+				return false;
+			}
+		}
+		//actions don't consume input
+	}
+
+	return true;
+}
+
+/**
+ * \brief compute FIRST and FOLLOW sets
+ */
+static bool LLGenSets()
+{
+	//FIRST sets of external rules
+	for(NonTerminal& n : gNonTerminals)
+	{
+		if(!n.external)
+		{
+			continue;
+		}
+		for(const std::string& w : n.externalFirst)
+		{
+			if(gTerminalIndex.find(w) == gTerminalIndex.end() && gNonTerminalIndex.find(w) == gNonTerminalIndex.end())
+			{
+				std::fprintf(stderr, "llgen: unknown symbol %s in FIRST set of %s\n", w.c_str(), n.spelling.c_str());
+				return false;
+			}
+		}
+	}
+
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+
+		for(NonTerminal& n : gNonTerminals)
+		{
+			if(!n.external)
+			{
+				continue;
+			}
+
+			size_t size = n.first.size();
+			for(const std::string& w : n.externalFirst)
+			{
+				if(gTerminalIndex.find(w) != gTerminalIndex.end())
+				{
+					n.first.insert(gTerminalIndex[w]);
+				}
+				else
+				{
+					std::set<size_t>& other = gNonTerminals[gNonTerminalIndex[w]].first;
+					n.first.insert(other.begin(), other.end());
+				}
+			}
+			changed |= size != n.first.size();
+		}
+
+		for(Production& p : gProductions)
+		{
+			NonTerminal& n = gNonTerminals[p.lhs];
+
+			size_t size     = n.first.size();
+			bool   nullable = LLGenFirst(p.rhs, 0, n.first);
+
+			changed |= size != n.first.size() || (nullable && !n.nullable);
+			n.nullable |= nullable;
+		}
+	}
+
+	//the start symbol is followed by end of file
+	if(gTerminalIndex.find("EOF") != gTerminalIndex.end())
+	{
+		gNonTerminals[gProductions[0].lhs].follow.insert(gTerminalIndex["EOF"]);
+	}
+
+	changed = true;
+	while(changed)
+	{
+		changed = false;
+
+		for(Production& p : gProductions)
+		{
+			for(size_t i = 0; i < p.rhs.size(); i++)
+			{
+				if(p.rhs[i].kind != Symbol::Kind::NonTerminal)
+				{
+					continue;
+				}
+
+				NonTerminal& n    = gNonTerminals[p.rhs[i].index];
+				size_t       size = n.follow.size();
+
+				if(LLGenFirst(p.rhs, i + 1, n.follow))
+				{
+					std::set<size_t>& follow = gNonTerminals[p.lhs].follow;
+					n.follow.insert(follow.begin(), follow.end());
+				}
+
+				changed |= size != n.follow.size();
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * \brief fill parse table, returns false on LL(1) conflict
+ */
+static bool LLGenTable(std::vector<std::vector<int>>& table)
+{
+	table.assign(gNonTerminals.size(), std::vector<int>(gTerminals.size(), -1));
+
+	bool ok = true;
+
+	for(size_t i = 0; i < gProductions.size(); i++)
+	{
+		Production& p = gProductions[i];
+
+		std::set<size_t> predict;
+		if(LLGenFirst(p.rhs, 0, predict))
+		{
+			predict.insert(gNonTerminals[p.lhs].follow.begin(), gNonTerminals[p.lhs].follow.end());
+		}
+
+		for(size_t t : predict)
+		{
+			int& cell = table[p.lhs][t];
+			if(cell != -1)
+			{
+				std::fprintf(stderr, "llgen: LL(1) conflict in %s on %s between productions at lines %zu and %zu\n",
+					gNonTerminals[p.lhs].spelling.c_str(), gTerminals[t].spelling.c_str(),
+					gProductions[cell].line, p.line);
+				ok = false;
+			}
+			cell = (int)i;
+		}
+	}
+
+	return ok;
+}
+
+/**
+ * \brief escape string for C++ literal
+ */
+static std::string LLGenEscape(const std::string& s)
+{
+	std::string result;
+	for(char c : s)
+	{
+		if(c == '"' || c == '\\')
+		{
+			result.push_back('\\');
+		}
+		result.push_back(c);
+	}
+	return result;
+}
+
+/**
+ * \brief write the generated header
+ */
+static bool LLGenWrite(const char* path, const std::vector<std::vector<int>>& table)
+{
+	FILE* out = std::fopen(path, "wb");
+	if(out == NULL)
+	{
+		std::fprintf(stderr, "llgen: cannot open %s\n", path);
+		return false;
+	}
+
+	std::fprintf(out, "//generated by tools/llgen from ll.grammar, do not edit\n");
+	std::fprintf(out, "#pragma once\n\n#include \"types.hpp\"\n\n");
+
+	//terminals
+	std::fprintf(out, "/**\n * \\brief terminals of the grammar, Other stands for tokens which never appear in the grammar\n */\n");
+	std::fprintf(out, "enum class ParserTerminal : u8\n{\n");
+	for(Terminal& t : gTerminals)
+	{
+		std::fprintf(out, "\t%s,\n", t.name.c_str());
+	}
+	std::fprintf(out, "\tOther,\n};\n\n");
+
+	//nonterminals
+	std::fprintf(out, "/**\n * \\brief rules of the grammar\n */\n");
+	std::fprintf(out, "enum class ParserRule : u8\n{\n");
+	for(NonTerminal& n : gNonTerminals)
+	{
+		std::fprintf(out, "\t%s,%s\n", n.name.c_str(), n.external ? " //external" : "");
+	}
+	std::fprintf(out, "};\n\n");
+
+	//actions
+	std::fprintf(out, "/**\n * \\brief semantic actions, every action X is implemented by Parser::actX()\n */\n");
+	std::fprintf(out, "#define PARSER_ACTIONS(X)");
+	for(std::string& a : gActions)
+	{
+		std::fprintf(out, " \\\n\tX(%s)", a.c_str());
+	}
+	std::fprintf(out, "\n\n");
+	std::fprintf(out, "enum class ParserAction : u8\n{\n");
+	for(std::string& a : gActions)
+	{
+		std::fprintf(out, "\t%s,\n", a.c_str());
+	}
+	std::fprintf(out, "};\n\n");
+
+	//symbol encoding
+	std::fprintf(out, "/**\n * \\brief parse stack symbol, kind in the top bits and index in the low bits\n */\n");
+	std::fprintf(out, "using ParserSymbol = u16;\n\n");
+	std::fprintf(out, "inline constexpr ParserSymbol ParserSymbolTerminal = 0x0000;\n");
+	std::fprintf(out, "inline constexpr ParserSymbol ParserSymbolRule     = 0x4000;\n");
+	std::fprintf(out, "inline constexpr ParserSymbol ParserSymbolAction   = 0x8000;\n");
+	std::fprintf(out, "inline constexpr ParserSymbol ParserSymbolKind     = 0xc000;\n\n");
+
+	//productions, right hand sides are stored reversed so they can be pushed on the stack in order
+	std::vector<size_t> offsets;
+	std::fprintf(out, "/**\n * \\brief right hand sides of productions in reversed order\n */\n");
+	std::fprintf(out, "inline constexpr ParserSymbol ParserProductionSymbols[] =\n{\n");
+	size_t offset = 0;
+	for(Production& p : gProductions)
+	{
+		offsets.push_back(offset);
+		std::fprintf(out, "\t/* %zu: %s -> ", offsets.size() - 1, gNonTerminals[p.lhs].spelling.c_str());
+		for(Symbol& s : p.rhs)
+		{
+			switch(s.kind)
+			{
+				case Symbol::Kind::Terminal:    { std::fprintf(out, "%s ", gTerminals[s.index].spelling.c_str()); break; }
+				case Symbol::Kind::NonTerminal: { std::fprintf(out, "%s ", gNonTerminals[s.index].spelling.c_str()); break; }
+				case Symbol::Kind::Action:      { std::fprintf(out, "@%s ", gActions[s.index].c_str()); break; }
+			}
+		}
+		std::fprintf(out, "*/\n\t");
+
+		for(size_t i = p.rhs.size(); i-- > 0;)
+		{
+			Symbol& s = p.rhs[i];
+			NonTerminal* n = s.kind == Symbol::Kind::NonTerminal ? &gNonTerminals[s.index] : nullptr;
+
+			if(n != nullptr && n->external)
+			{
+				std::fprintf(out, "ParserSymbolAction | (ParserSymbol)ParserAction::%s, ", gActions[n->action].c_str());
+			}
+			else if(n != nullptr)
+			{
+				std::fprintf(out, "ParserSymbolRule | (ParserSymbol)ParserRule::%s, ", n->name.c_str());
+			}
+			else if(s.kind == Symbol::Kind::Action)
+			{
+				std::fprintf(out, "ParserSymbolAction | (ParserSymbol)ParserAction::%s, ", gActions[s.index].c_str());
+			}
+			else
+			{
+				std::fprintf(out, "ParserSymbolTerminal | (ParserSymbol)ParserTerminal::%s, ", gTerminals[s.index].name.c_str());
+			}
+		}
+		std::fprintf(out, "\n");
+		offset += p.rhs.size();
+	}
+	offsets.push_back(offset);
+	std::fprintf(out, "};\n\n");
+
+	std::fprintf(out, "/**\n * \\brief production i occupies symbols [start[i], start[i + 1])\n */\n");
+	std::fprintf(out, "inline constexpr u16 ParserProductionStart[] =\n{\n\t");
+	for(size_t o : offsets)
+	{
+		std::fprintf(out, "%zu, ", o);
+	}
+	std::fprintf(out, "\n};\n\n");
+
+	//table
+	std::fprintf(out, "/**\n * \\brief production for rule and lookahead terminal, ParserNoProduction = syntax error\n */\n");
+	std::fprintf(out, "inline constexpr u8 ParserNoProduction = 0xff;\n\n");
+	std::fprintf(out, "inline constexpr u8 ParserTable[][%zu] =\n{\n", gTerminals.size() + 1);
+	for(size_t i = 0; i < gNonTerminals.size(); i++)
+	{
+		std::fprintf(out, "\t/* %-16s */ { ", gNonTerminals[i].spelling.c_str());
+		for(size_t t = 0; t < gTerminals.size(); t++)
+		{
+			if(table[i][t] == -1)
+			{
+				std::fprintf(out, "0xff, ");
+			}
+			else
+			{
+				std::fprintf(out, "%4d, ", table[i][t]);
+			}
+		}
+		std::fprintf(out, "0xff },\n");
+	}
+	std::fprintf(out, "};\n\n");
+
+	//diagnostics
+	std::fprintf(out, "/**\n * \\brief display names of terminals\n */\n");
+	std::fprintf(out, "inline constexpr const char* ParserTerminalName[] =\n{\n");
+	for(Terminal& t : gTerminals)
+	{
+		std::fprintf(out, "\t\"%s\",\n", LLGenEscape(t.display).c_str());
+	}
+	std::fprintf(out, "\t\"symbol\",\n};\n\n");
+
+	std::fprintf(out, "/**\n * \\brief terminals expected by each rule\n */\n");
+	std::fprintf(out, "inline constexpr const char* ParserRuleExpected[] =\n{\n");
+	for(size_t i = 0; i < gNonTerminals.size(); i++)
+	{
+		std::vector<std::string> expected;
+		for(size_t t = 0; t < gTerminals.size(); t++)
+		{
+			if(gNonTerminals[i].external ? gNonTerminals[i].first.count(t) != 0 : table[i][t] != -1)
+			{
+				expected.push_back(gTerminals[t].display);
+			}
+		}
+
+		std::string list;
+		for(size_t e = 0; e < expected.size(); e++)
+		{
+			if(e != 0)
+			{
+				list += (e + 1 == expected.size()) ? " or " : ", ";
+			}
+			list += expected[e];
+		}
+		std::fprintf(out, "\t\"%s\",\n", LLGenEscape(list).c_str());
+	}
+	std::fprintf(out, "};\n");
+
+	std::fclose(out);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc != 3)
+	{
+		std::fprintf(stderr, "llgen [ll.grammar] [ParserTable.hpp]\n");
+		return 1;
+	}
+
+	std::vector<std::vector<int>> table;
+
+	if(!LLGenLoad(argv[1]) || !LLGenSets() || !LLGenTable(table))
+	{
+		return 1;
+	}
+
+	if(gProductions.size() >= 0xff || gNonTerminals.size() >= 0x4000 || gActions.size() >= 0x4000)
+	{
+		std::fprintf(stderr, "llgen: grammar is too large for the table encoding\n");
+		return 1;
+	}
+
+	return LLGenWrite(argv[2], table) ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+/**
+ * \brief peak memory benchmark of the compiler
+ * \note generates sources with fixed number of functions whose bodies grow, compiles each
+ *       of them in every mode and prints peak resident set size of the compiler process.
+ *       Streaming compilation must grow only with the largest function, growth of other modes
+ *       is printed for comparison (parallel mode keeps output of all bodies until they are merged)
+ *
+ *       usage: rssbench ./silang [functions] [statements...]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+/**
+ * \brief memory of streaming compilation grows by at most this many bytes per byte
+ *        of the largest function (code, SSA and register allocation of the function)
+ *        and this many KiB of noise
+ */
+static constexpr long RssbenchBodyFactor = 128;
+static constexpr long RssbenchSlack      = 1024;
+
+/**
+ * \brief write source with given number of functions of given number of statements,
+ *        returns its size in bytes and size of the largest function in body
+ */
+static long generate(const char* path, long functions, long statements, long& body)
+{
+	FILE* f = std::fopen(path, "wb");
+	if(f == nullptr)
+	{
+		return -1;
+	}
+
+	std::fprintf(f, "int g = 3;\n");
+	body = 0;
+	for(long i = 0; i < functions; i++)
+	{
+		long start = std::ftell(f);
+		std::fprintf(f, "func f%ld(int a, int b) : int {\n", i);
+		std::fprintf(f, "\tint x = a + b * %ld;\n", i);
+		std::fprintf(f, "\tint y = x - g;\n");
+		for(long s = 0; s < statements; s++)
+		{
+			std::fprintf(f, "\tif(x > %ld) { y = y + x / %ld; } else { x = x * 3 - y; }\n", s, s + 2);
+		}
+		std::fprintf(f, "\twhile(y > 2) { y = y - 1; x = x + y; }\n");
+		if(i != 0)
+		{
+			std::fprintf(f, "\tif(x > y) { x = f%ld(x, y); } else { x = 0; }\n", i - 1);
+		}
+		std::fprintf(f, "\treturn x;\n}\n");
+		body = std::max(body, std::ftell(f) - start);
+	}
+	std::fprintf(f, "func main() : int {\n\treturn f%ld(1, 2);\n}\n", functions - 1);
+
+	long size = std::ftell(f);
+	std::fclose(f);
+
+	return size;
+}
+
+/**
+ * \brief run compiler and return its peak resident set size in KiB
+ */
+static long run(const std::vector<std::string>& args)
+{
+	pid_t pid = fork();
+	if(pid == 0)
+	{
+		//trace output of the compiler is not measured
+		int null = open("/dev/null", O_WRONLY);
+		dup2(null, STDOUT_FILENO);
+
+		std::vector<char*> argv;
+		for(const std::string& a : args)
+		{
+			argv.push_back(const_cast<char*>(a.c_str()));
+		}
+		argv.push_back(nullptr);
+
+		execv(argv[0], argv.data());
+		_exit(127);
+	}
+
+	int           status = 0;
+	struct rusage usage;
+	if(pid < 0 || wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) == 127)
+	{
+		return -1;
+	}
+
+	return usage.ru_maxrss;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		std::printf("rssbench ./silang [functions] [statements...]\n");
+		return 1;
+	}
+
+	long functions = argc > 2 ? std::atol(argv[2]) : 256;
+	std::vector<long> sizes;
+	for(int i = 3; i < argc; i++)
+	{
+		sizes.push_back(std::atol(argv[i]));
+	}
+	if(sizes.empty())
+	{
+		sizes = { 16, 64, 256, 1024 };
+	}
+
+	const char* in  = "/tmp/rssbench.sil";
+	const char* out = "/tmp/rssbench.silcode";
+
+	std::printf("%10s %10s %12s %12s %12s %12s\n", "statements", "body KiB", "input KiB", "default KiB", "stream KiB", "-j 2 KiB");
+
+	//peak memory of the first and the last source
+	long firstBody = 0, lastBody = 0, firstStream = 0, lastStream = 0;
+	for(long statements : sizes)
+	{
+		long body;
+		long size = generate(in, functions, statements, body);
+		if(size < 0)
+		{
+			std::printf("error: cannot write %s\n", in);
+			return 1;
+		}
+
+		long def    = run({ argv[1], in, out });
+		long stream = run({ argv[1], "--stream", in, out });
+		long jobs   = run({ argv[1], "-j", "2", in, out });
+		if(def < 0 || stream < 0 || jobs < 0)
+		{
+			std::printf("error: compilation failed\n");
+			return 1;
+		}
+
+		std::printf("%10ld %10ld %12ld %12ld %12ld %12ld\n", statements, body / 1024, size / 1024, def, stream, jobs);
+
+		if(statements == sizes.front())
+		{
+			firstBody   = body;
+			firstStream = stream;
+		}
+		lastBody   = body;
+		lastStream = stream;
+	}
+
+	std::remove(in);
+	std::remove(out);
+
+	//streaming keeps only the current function, its memory grows with the largest function
+	//and not with the number of functions
+	long bound = RssbenchBodyFactor * (lastBody - firstBody) / 1024 + RssbenchSlack;
+	std::printf("stream growth %ld KiB, bound %ld KiB (%ld x growth of the largest function)\n",
+		lastStream - firstStream, bound, RssbenchBodyFactor);
+	if(lastStream - firstStream > bound)
+	{
+		std::printf("error: memory of streaming compilation is not bounded by the largest function\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,314 @@
+/**
+ * \brief dump of .silcode file
+ * \note prints header, section table, symbols, data, constants and line information
+ *       and disassembles code of every function
+ *
+ *       usage: silcodedump file.silcode
+ */
+#include "Silcode.hpp"
+#include "Codegen.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define IR_OP_NAME(op, name) name,
+static const char* opName[] =
+{
+	IR_OPS(IR_OP_NAME)
+};
+#undef IR_OP_NAME
+
+static const char* typeName[] = { "u8", "i64", "f64", "none" };
+static const char* sectionName[] = { "code", "constants", "data", "symbols", "strings", "lines" };
+static const char* symbolKind[] = { "extern", "function", "data", "local" };
+
+/**
+ * \brief operand printed as value or block number
+ */
+static void value(u64 v)
+{
+	if(v == SilcodeNone)
+	{
+		std::printf(" none");
+	}
+	else
+	{
+		std::printf(" %%%" PRIu64, v);
+	}
+}
+
+/**
+ * \brief memory of load, store or copy: symbol or value of address which follows the operands
+ */
+static std::string memory(const SilcodeImage& image, u64 symbol, const u8*& in)
+{
+	if(symbol == SilcodeNone)
+	{
+		return "%" + std::to_string(SilcodeReadU(in));
+	}
+	return image.name((u32)symbol);
+}
+
+/**
+ * \brief disassemble code of one function
+ */
+static void function(const SilcodeImage& image, u32 index)
+{
+	u64 codeSize, constSize;
+	const u8* code   = image.section(SilcodeSection::Code, codeSize);
+	const u8* consts = image.section(SilcodeSection::Constants, constSize);
+
+	const SilcodeSymbol& s = image.symbol(index);
+	const u8* in = code + s.value;
+
+	std::printf("\nfunction %s\n", image.name(index));
+
+	u64 blocks = SilcodeReadU(in);
+	u64 values = SilcodeReadU(in);
+	u64 frame  = SilcodeReadU(in);
+	u64 saved  = SilcodeReadU(in);
+	u64 locals = SilcodeReadU(in);
+	u64 v      = 0;
+	std::printf("\t; %" PRIu64 " blocks, %" PRIu64 " values, frame %" PRIu64 " bytes, %" PRIu64 " bytes\n", blocks, values, frame, s.size);
+	if(saved != 0)
+	{
+		std::printf("\tsaved");
+		for(u64 r = 0; r < 64; r++)
+		{
+			if((saved & (1ull << r)) != 0)
+			{
+				std::printf(r < 32 ? " r%" PRIu64 : " f%" PRIu64, r % 32);
+			}
+		}
+		std::printf("\n");
+	}
+	for(u64 l = 0; l < locals; l++)
+	{
+		const char* name = image.name(SilcodeReadU(in));
+		std::printf("\tlocal %s [%" PRIu64 "]\n", name, SilcodeReadU(in));
+	}
+
+	for(u64 b = 0; b < blocks; b++)
+	{
+		std::printf("b%" PRIu64 ":", b);
+		u64 preds = SilcodeReadU(in);
+		if(preds != 0)
+		{
+			std::printf(" preds");
+		}
+		for(u64 p = 0; p < preds; p++)
+		{
+			std::printf(" b%" PRIu64, SilcodeReadU(in));
+		}
+		std::printf("\n");
+
+		u64 count = SilcodeReadU(in);
+		for(u64 i = 0; i < count; i++, v++)
+		{
+			IrOp   op       = (IrOp)*in++;
+			IrType type     = (IrType)*in++;
+			u64    location = SilcodeReadU(in);
+
+			std::printf("\t%%%" PRIu64, v);
+			if(location != 0)
+			{
+				if(location % 4 == 1)
+				{
+					std::printf("@r%" PRIu64, (location - 1) / 4);
+				}
+				else if(location % 4 == 3)
+				{
+					std::printf("@f%" PRIu64, (location - 3) / 4);
+				}
+				else
+				{
+					std::printf("@[%" PRIu64 "]", (location - 2) / 2);
+				}
+			}
+			std::printf(" = %s.%s", opName[(u32)op], typeName[(u32)type]);
+			switch(op)
+			{
+				case IrOp::Const:
+				{
+					if(type == IrType::F64)
+					{
+						f64 f;
+						std::memcpy(&f, consts + SilcodeReadU(in), sizeof(f));
+						std::printf(" %.17g", f);
+					}
+					else
+					{
+						std::printf(" %" PRIi64, SilcodeReadS(in));
+					}
+					break;
+				}
+				case IrOp::Undef:  { break; }
+				case IrOp::Str:    { std::printf(" \"%s\"", (const char*)consts + SilcodeReadU(in)); break; }
+				case IrOp::Arg:    { std::printf(" %" PRIu64, SilcodeReadU(in)); break; }
+				case IrOp::Load:
+				{
+					u64 symbol = SilcodeReadU(in);
+					i64 offset = SilcodeReadS(in);
+					std::printf(" [%s + %" PRIi64 "]", memory(image, symbol, in).c_str(), offset);
+					break;
+				}
+				case IrOp::Store:
+				{
+					u64 symbol = SilcodeReadU(in);
+					i64 offset = SilcodeReadS(in);
+					u64 stored = SilcodeReadU(in);
+					std::printf(" [%s + %" PRIi64 "],", memory(image, symbol, in).c_str(), offset);
+					value(stored);
+					break;
+				}
+				case IrOp::Addr:   { std::printf(" %s", image.name(SilcodeReadU(in))); break; }
+				case IrOp::Copy:
+				{
+					u64 symbol = SilcodeReadU(in);
+					u64 source = SilcodeReadU(in);
+					u64 size   = SilcodeReadU(in);
+					std::printf(" [%s],", memory(image, symbol, in).c_str());
+					value(source);
+					std::printf(", %" PRIu64, size);
+					break;
+				}
+				case IrOp::Call:
+				{
+					std::printf(" %s", image.name(SilcodeReadU(in)));
+					u64 args = SilcodeReadU(in);
+					for(u64 a = 0; a < args; a++)
+					{
+						value(SilcodeReadU(in));
+					}
+					break;
+				}
+				case IrOp::Result:
+				{
+					value(SilcodeReadU(in));
+					std::printf(", %" PRIu64, SilcodeReadU(in));
+					break;
+				}
+				case IrOp::Ret:
+				{
+					u64 n = SilcodeReadU(in);
+					for(u64 a = 0; a < n; a++)
+					{
+						value(SilcodeReadU(in));
+					}
+					break;
+				}
+				case IrOp::Jump:   { std::printf(" b%" PRIu64, SilcodeReadU(in)); break; }
+				case IrOp::Branch:
+				{
+					value(SilcodeReadU(in));
+					u64 t = SilcodeReadU(in);
+					std::printf(", b%" PRIu64 ", b%" PRIu64, t, SilcodeReadU(in));
+					break;
+				}
+				case IrOp::Phi:
+				{
+					for(u64 p = 0; p < preds; p++)
+					{
+						value(SilcodeReadU(in));
+					}
+					break;
+				}
+				case IrOp::Cvt:    { value(SilcodeReadU(in)); break; }
+				//binary operations
+				default:
+				{
+					value(SilcodeReadU(in));
+					value(SilcodeReadU(in));
+					break;
+				}
+			}
+			std::printf("\n");
+		}
+	}
+
+	if(in != code + s.value + s.size)
+	{
+		std::printf("\t; decoded %" PRIu64 " bytes, function has %" PRIu64 "\n", (u64)(in - code - s.value), s.size);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		std::fprintf(stderr, "usage: %s file.silcode\n", argv[0]);
+		return 1;
+	}
+
+	SilcodeImage image;
+	const char*  error = image.open(argv[1]);
+	if(error != nullptr)
+	{
+		std::fprintf(stderr, "%s: %s\n", argv[1], error);
+		return 1;
+	}
+
+	const SilcodeHeader& h = image.header();
+	std::printf("silcode %u.%u, %" PRIu64 " bytes\n", h.major, h.minor, h.size);
+	std::printf("entry %s, init %s\n", h.entry == SilcodeNone ? "none" : image.name(h.entry),
+		h.init == SilcodeNone ? "none" : image.name(h.init));
+
+	std::printf("\nsections\n");
+	for(u32 i = 0; i < (u32)SilcodeSection::Count; i++)
+	{
+		u64 size;
+		const u8* data = image.section((SilcodeSection)i, size);
+		std::printf("\t%-10s offset %8" PRIu64 " size %8" PRIu64 "\n", sectionName[i],
+			data == nullptr ? 0 : (u64)(data - (const u8*)&h), size);
+	}
+
+	u64 dataSize, constSize;
+	const u8* data   = image.section(SilcodeSection::Data, dataSize);
+	const u8* consts = image.section(SilcodeSection::Constants, constSize);
+
+	std::printf("\nsymbols\n");
+	for(u32 i = 0; i < image.symbolCount(); i++)
+	{
+		const SilcodeSymbol& s = image.symbol(i);
+		std::printf("\t%4u %-8s %-24s value %6" PRIu64 " size %6" PRIu64, i, symbolKind[(u32)s.kind], image.name(i), s.value, s.size);
+
+		if(s.kind == SilcodeSymbolKind::Data)
+		{
+			if((s.flags & SilcodeSymbolConstant) != 0)
+			{
+				u64 offset;
+				std::memcpy(&offset, data + s.value, sizeof(offset));
+				std::printf(" = &\"%s\"", (const char*)consts + offset);
+			}
+			else
+			{
+				std::printf(" =");
+				for(u64 b = 0; b < s.size && b < 16; b++)
+				{
+					std::printf(" %02x", data[s.value + b]);
+				}
+			}
+		}
+		std::printf("\n");
+	}
+
+	u64 lineSize;
+	const SilcodeLine* lines = (const SilcodeLine*)image.section(SilcodeSection::Lines, lineSize);
+	std::printf("\nlines\n");
+	for(u64 i = 0; i < lineSize / sizeof(SilcodeLine); i++)
+	{
+		std::printf("\t%-24s source %8" PRIu64 " code %8" PRIu64 "\n", image.name(lines[i].symbol), lines[i].source, lines[i].code);
+	}
+
+	for(u32 i = 0; i < image.symbolCount(); i++)
+	{
+		if(image.symbol(i).kind == SilcodeSymbolKind::Function)
+		{
+			function(image, i);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,609 @@
+/**
+ * \brief interpreter of .silcode files
+ * \note loads the file like silcodedump, runs startup function and main and prints values
+ *       returned by main (one per line). Operators are computed by Operator.hpp, so results
+ *       are the same as constants folded by the compiler. Locations of values are ignored,
+ *       the code runs as SSA: every value is defined once per execution of its block.
+ *
+ *       memory of the program is one array: data section, constants, then frames of calls
+ *       (address of local variable is the start of frame + its offset)
+ *
+ *       usage: silrun file.silcode [arguments of main...]
+ */
+#include "Silcode.hpp"
+#include "Codegen.hpp"
+#include "Operator.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/**
+ * \brief calls deeper than this are stopped (recursion without end)
+ */
+static constexpr u32 SilrunDepth = 100000;
+
+/**
+ * \brief value of instruction
+ */
+union SilrunValue
+{
+	i64 i;
+	f64 f;
+};
+
+/**
+ * \brief decoded instruction
+ * \note operands are values of the function, blocks are targets of jump and branch,
+ *       memory operation without symbol (SilcodeNone) addresses memory by its last operand
+ */
+struct SilrunInst
+{
+	IrOp   op;
+	IrType type;
+	u32    symbol;
+	i64    imm;
+	u32    operands;
+	u32    count;
+	u32    target[2];
+};
+
+/**
+ * \brief decoded block, its instructions are consecutive values
+ */
+struct SilrunBlock
+{
+	u32              first;
+	u32              count;
+	std::vector<u32> preds;
+};
+
+/**
+ * \brief decoded function
+ */
+struct SilrunFunction
+{
+	bool                     decoded;
+	u64                      frame;
+	std::vector<u32>         locals;
+	std::vector<u64>         offsets;
+	std::vector<SilrunBlock> blocks;
+	std::vector<SilrunInst>  insts;
+	std::vector<u32>         operands;
+};
+
+/**
+ * \brief loaded program
+ */
+class Silrun
+{
+public:
+	/**
+	 * \brief copy data and constants into memory, returns error message or nullptr
+	 */
+	const char* load(const SilcodeImage& image);
+	/**
+	 * \brief run function, false when the program failed (message is printed)
+	 */
+	bool        run(u32 function, const std::vector<SilrunValue>& args, std::vector<SilrunValue>& results, IrType& type);
+
+private:
+	bool        fail(const char* message, u32 function);
+	bool        decode(u32 function);
+	bool        address(u32 function, u64 frame, const SilrunInst& inst, const std::vector<SilrunValue>& values, u64 size, u64& at);
+	IrType      valueType(const SilrunFunction& f, u32 value) const;
+
+	const SilcodeImage*         pImage;
+	std::vector<u8>             pMemory;
+	u64                         pConstants;
+	u64                         pStack;
+	u32                         pDepth;
+	std::vector<SilrunFunction> pFunctions;
+};
+
+bool Silrun::fail(const char* message, u32 function)
+{
+	std::fprintf(stderr, "silrun: %s in function %s\n", message, this->pImage->name(function));
+	return false;
+}
+
+/**
+ * \brief copy data and constants into memory
+ */
+const char* Silrun::load(const SilcodeImage& image)
+{
+	u64 dataSize, constSize;
+	const u8* data   = image.section(SilcodeSection::Data, dataSize);
+	const u8* consts = image.section(SilcodeSection::Constants, constSize);
+
+	this->pImage     = &image;
+	this->pDepth     = 0;
+	this->pConstants = (dataSize + 7) / 8 * 8;
+	this->pStack     = (this->pConstants + constSize + 7) / 8 * 8;
+	this->pMemory.assign(this->pStack, 0);
+	if(dataSize != 0)
+	{
+		std::memcpy(&this->pMemory[0], data, dataSize);
+	}
+	if(constSize != 0)
+	{
+		std::memcpy(&this->pMemory[this->pConstants], consts, constSize);
+	}
+
+	//globals initialized with string literal hold its offset in constants, it becomes address
+	for(u32 i = 0; i < image.symbolCount(); i++)
+	{
+		const SilcodeSymbol& s = image.symbol(i);
+		if(s.kind == SilcodeSymbolKind::Data && (s.flags & SilcodeSymbolConstant) != 0)
+		{
+			u64 offset;
+			std::memcpy(&offset, &this->pMemory[s.value], sizeof(offset));
+			offset += this->pConstants;
+			std::memcpy(&this->pMemory[s.value], &offset, sizeof(offset));
+		}
+	}
+
+	this->pFunctions.assign(image.symbolCount(), SilrunFunction());
+	return nullptr;
+}
+
+/**
+ * \brief decode code of function on its first call
+ */
+bool Silrun::decode(u32 function)
+{
+	SilrunFunction& f = this->pFunctions[function];
+	if(f.decoded)
+	{
+		return true;
+	}
+
+	u64 codeSize, constSize;
+	const u8* code   = this->pImage->section(SilcodeSection::Code, codeSize);
+	const u8* consts = this->pImage->section(SilcodeSection::Constants, constSize);
+	const u8* in     = code + this->pImage->symbol(function).value;
+
+	u64 blocks = SilcodeReadU(in);
+	u64 values = SilcodeReadU(in);
+	f.frame    = SilcodeReadU(in);
+	SilcodeReadU(in);
+	u64 locals = SilcodeReadU(in);
+	for(u64 l = 0; l < locals; l++)
+	{
+		f.locals.push_back((u32)SilcodeReadU(in));
+		f.offsets.push_back(SilcodeReadU(in));
+	}
+
+	f.blocks.resize(blocks);
+	f.insts.reserve(values);
+	for(SilrunBlock& b : f.blocks)
+	{
+		b.preds.resize(SilcodeReadU(in));
+		for(u32& p : b.preds)
+		{
+			p = (u32)SilcodeReadU(in);
+		}
+		b.first = (u32)f.insts.size();
+		b.count = (u32)SilcodeReadU(in);
+
+		for(u32 i = 0; i < b.count; i++)
+		{
+			SilrunInst inst;
+			inst.op        = (IrOp)*in++;
+			inst.type      = (IrType)*in++;
+			inst.symbol    = SilcodeNone;
+			inst.imm       = 0;
+			inst.operands  = (u32)f.operands.size();
+			inst.count     = 0;
+			inst.target[0] = SilcodeNone;
+			inst.target[1] = SilcodeNone;
+			SilcodeReadU(in);
+
+			auto operands = [&](u64 count)
+			{
+				for(u64 o = 0; o < count; o++)
+				{
+					f.operands.push_back((u32)SilcodeReadU(in));
+				}
+				inst.count += (u32)count;
+			};
+
+			switch(inst.op)
+			{
+				case IrOp::Const:
+				{
+					if(inst.type == IrType::F64)
+					{
+						std::memcpy(&inst.imm, consts + SilcodeReadU(in), sizeof(inst.imm));
+					}
+					else
+					{
+						inst.imm = SilcodeReadS(in);
+					}
+					break;
+				}
+				case IrOp::Undef:  { break; }
+				case IrOp::Str:    { inst.imm = (i64)(this->pConstants + SilcodeReadU(in)); break; }
+				case IrOp::Arg:    { inst.imm = (i64)SilcodeReadU(in); break; }
+				case IrOp::Load:   { inst.symbol = (u32)SilcodeReadU(in); inst.imm = SilcodeReadS(in); break; }
+				case IrOp::Store:  { inst.symbol = (u32)SilcodeReadU(in); inst.imm = SilcodeReadS(in); operands(1); break; }
+				case IrOp::Addr:   { inst.symbol = (u32)SilcodeReadU(in); break; }
+				case IrOp::Copy:   { inst.symbol = (u32)SilcodeReadU(in); operands(1); inst.imm = (i64)SilcodeReadU(in); break; }
+				case IrOp::Call:   { inst.symbol = (u32)SilcodeReadU(in); operands(SilcodeReadU(in)); break; }
+				case IrOp::Result: { operands(1); inst.imm = (i64)SilcodeReadU(in); break; }
+				case IrOp::Ret:    { operands(SilcodeReadU(in)); break; }
+				case IrOp::Jump:   { inst.target[0] = (u32)SilcodeReadU(in); break; }
+				case IrOp::Branch:
+				{
+					operands(1);
+					inst.target[0] = (u32)SilcodeReadU(in);
+					inst.target[1] = (u32)SilcodeReadU(in);
+					break;
+				}
+				case IrOp::Phi:    { operands(b.preds.size()); break; }
+				case IrOp::Cvt:    { operands(1); break; }
+				//binary operations
+				default:           { operands(2); break; }
+			}
+			//address of memory without symbol follows the operands
+			if((inst.op == IrOp::Load || inst.op == IrOp::Store || inst.op == IrOp::Copy) && inst.symbol == SilcodeNone)
+			{
+				operands(1);
+			}
+			f.insts.push_back(inst);
+		}
+	}
+
+	if(in != code + this->pImage->symbol(function).value + this->pImage->symbol(function).size)
+	{
+		return this->fail("damaged code", function);
+	}
+	f.decoded = true;
+	return true;
+}
+
+/**
+ * \brief type of value (comparisons define int)
+ */
+IrType Silrun::valueType(const SilrunFunction& f, u32 value) const
+{
+	const SilrunInst& inst = f.insts[value];
+	return OperatorComparison(inst.op) ? IrType::I64 : inst.type;
+}
+
+/**
+ * \brief address of memory accessed by instruction (symbol or address value) checked for size bytes
+ */
+bool Silrun::address(u32 function, u64 frame, const SilrunInst& inst, const std::vector<SilrunValue>& values, u64 size, u64& at)
+{
+	const SilrunFunction& f = this->pFunctions[function];
+	if(inst.symbol == SilcodeNone)
+	{
+		at = (u64)values[f.operands[inst.operands + inst.count - 1]].i;
+	}
+	else
+	{
+		const SilcodeSymbol& s = this->pImage->symbol(inst.symbol);
+		if(s.kind == SilcodeSymbolKind::Data)
+		{
+			at = s.value;
+		}
+		else
+		{
+			u32 l = 0;
+			while(l < f.locals.size() && f.locals[l] != inst.symbol)
+			{
+				l++;
+			}
+			if(l == f.locals.size())
+			{
+				return this->fail("unresolved memory symbol", function);
+			}
+			at = frame + f.offsets[l];
+		}
+	}
+
+	if(inst.op != IrOp::Addr)
+	{
+		at += inst.op == IrOp::Copy ? 0 : (u64)inst.imm;
+		if(at + size > this->pMemory.size() || at + size < at)
+		{
+			return this->fail("memory access out of bounds", function);
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief run function, false when the program failed (message is printed)
+ */
+bool Silrun::run(u32 function, const std::vector<SilrunValue>& args, std::vector<SilrunValue>& results, IrType& type)
+{
+	if(this->pImage->symbol(function).kind != SilcodeSymbolKind::Function)
+	{
+		return this->fail("call of undefined function", function);
+	}
+	if(this->pDepth == SilrunDepth)
+	{
+		return this->fail("calls too deep", function);
+	}
+	if(!this->decode(function))
+	{
+		return false;
+	}
+
+	//frame of the call is released when it returns
+	u64 frame = this->pStack;
+	this->pStack += (this->pFunctions[function].frame + 7) / 8 * 8;
+	if(this->pMemory.size() < this->pStack)
+	{
+		this->pMemory.resize(this->pStack, 0);
+	}
+	this->pDepth++;
+
+	const SilrunFunction&                 f = this->pFunctions[function];
+	std::vector<SilrunValue>              values(f.insts.size());
+	std::vector<std::vector<SilrunValue>> calls(f.insts.size());
+	std::vector<SilrunValue>              phis;
+
+	u32  block = 0;
+	u32  prev  = SilcodeNone;
+	bool ok    = true;
+	while(ok)
+	{
+		const SilrunBlock& b = f.blocks[block];
+
+		//phis take values of the edge all at once
+		u32 edge = 0;
+		while(edge < b.preds.size() && b.preds[edge] != prev)
+		{
+			edge++;
+		}
+		phis.clear();
+		for(u32 v = b.first; v < b.first + b.count && f.insts[v].op == IrOp::Phi; v++)
+		{
+			if(edge == b.preds.size())
+			{
+				ok = this->fail("phi without edge", function);
+				break;
+			}
+			phis.push_back(values[f.operands[f.insts[v].operands + edge]]);
+		}
+		for(u32 p = 0; p < phis.size(); p++)
+		{
+			values[b.first + p] = phis[p];
+		}
+
+		u32 next = SilcodeNone;
+		for(u32 v = b.first + (u32)phis.size(); ok && v < b.first + b.count; v++)
+		{
+			const SilrunInst& inst = f.insts[v];
+			const u32*        ops  = &f.operands[inst.operands];
+			SilrunValue&      out  = values[v];
+
+			switch(inst.op)
+			{
+				case IrOp::Const:  { out.i = inst.imm; break; }
+				case IrOp::Undef:  { out.i = 0; break; }
+				case IrOp::Str:    { out.i = inst.imm; break; }
+				case IrOp::Arg:
+				{
+					if((u64)inst.imm >= args.size())
+					{
+						ok = this->fail("missing argument", function);
+						break;
+					}
+					out = args[inst.imm];
+					break;
+				}
+				case IrOp::Phi:    { ok = this->fail("phi after instruction", function); break; }
+				case IrOp::Load:
+				{
+					u64 at;
+					u64 size = inst.type == IrType::U8 ? 1 : 8;
+					if(!(ok = this->address(function, frame, inst, values, size, at)))
+					{
+						break;
+					}
+					out.i = 0;
+					std::memcpy(&out, &this->pMemory[at], size);
+					break;
+				}
+				case IrOp::Store:
+				{
+					u64 at;
+					u64 size = inst.type == IrType::U8 ? 1 : 8;
+					if(!(ok = this->address(function, frame, inst, values, size, at)))
+					{
+						break;
+					}
+					std::memcpy(&this->pMemory[at], &values[ops[0]], size);
+					break;
+				}
+				case IrOp::Addr:
+				{
+					u64 at;
+					ok    = this->address(function, frame, inst, values, 0, at);
+					out.i = (i64)at;
+					break;
+				}
+				case IrOp::Copy:
+				{
+					u64 at;
+					u64 from = (u64)values[ops[0]].i;
+					if(!(ok = this->address(function, frame, inst, values, (u64)inst.imm, at)))
+					{
+						break;
+					}
+					if(from + (u64)inst.imm > this->pMemory.size() || from + (u64)inst.imm < from)
+					{
+						ok = this->fail("memory access out of bounds", function);
+						break;
+					}
+					std::memmove(&this->pMemory[at], &this->pMemory[from], (u64)inst.imm);
+					break;
+				}
+				case IrOp::Call:
+				{
+					std::vector<SilrunValue> a;
+					for(u32 o = 0; o < inst.count; o++)
+					{
+						a.push_back(values[ops[o]]);
+					}
+					IrType t;
+					ok    = this->run(inst.symbol, a, calls[v], t);
+					out.i = 0;
+					if(ok && !calls[v].empty())
+					{
+						out = calls[v][0];
+					}
+					break;
+				}
+				case IrOp::Result:
+				{
+					if((u64)inst.imm >= calls[ops[0]].size())
+					{
+						ok = this->fail("missing result of call", function);
+						break;
+					}
+					out = calls[ops[0]][inst.imm];
+					break;
+				}
+				case IrOp::Ret:
+				{
+					results.clear();
+					for(u32 o = 0; o < inst.count; o++)
+					{
+						results.push_back(values[ops[o]]);
+					}
+					type = inst.count != 0 ? this->valueType(f, ops[0]) : IrType::None;
+					this->pStack = frame;
+					this->pDepth--;
+					return true;
+				}
+				case IrOp::Jump:   { next = inst.target[0]; break; }
+				case IrOp::Branch: { next = values[ops[0]].i != 0 ? inst.target[0] : inst.target[1]; break; }
+				case IrOp::Cvt:
+				{
+					OperatorValue from, to;
+					from.type = this->valueType(f, ops[0]);
+					from.i    = values[ops[0]].i;
+					from.f    = values[ops[0]].f;
+					if(!OperatorConvert(from, inst.type, to))
+					{
+						ok = this->fail("conversion out of range", function);
+						break;
+					}
+					if(inst.type == IrType::F64)
+					{
+						out.f = to.f;
+					}
+					else
+					{
+						out.i = to.i;
+					}
+					break;
+				}
+				//binary operations of the type of instruction
+				default:
+				{
+					SilrunValue   a = values[ops[0]];
+					SilrunValue   c = values[ops[1]];
+					OperatorValue r;
+					bool          done;
+					switch(inst.type)
+					{
+						case IrType::U8:  { done = OperatorEval(inst.op, (u8)a.i, (u8)c.i, r); break; }
+						case IrType::F64: { done = OperatorEval(inst.op, a.f, c.f, r); break; }
+						default:          { done = OperatorEval(inst.op, a.i, c.i, r); break; }
+					}
+					if(!done)
+					{
+						ok = this->fail(inst.op == IrOp::Div ? "division by zero" : "invalid operation", function);
+						break;
+					}
+					if(r.type == IrType::F64)
+					{
+						out.f = r.f;
+					}
+					else
+					{
+						out.i = r.i;
+					}
+					break;
+				}
+			}
+		}
+
+		if(ok && next == SilcodeNone)
+		{
+			ok = this->fail("block without terminator", function);
+		}
+		prev  = block;
+		block = next;
+	}
+
+	this->pStack = frame;
+	this->pDepth--;
+	return false;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 2)
+	{
+		std::fprintf(stderr, "usage: %s file.silcode [arguments of main...]\n", argv[0]);
+		return 1;
+	}
+
+	SilcodeImage image;
+	const char*  error = image.open(argv[1]);
+	if(error != nullptr)
+	{
+		std::fprintf(stderr, "%s: %s\n", argv[1], error);
+		return 1;
+	}
+
+	const SilcodeHeader& h = image.header();
+	if(h.entry == SilcodeNone)
+	{
+		std::fprintf(stderr, "%s: no main function\n", argv[1]);
+		return 1;
+	}
+
+	Silrun program;
+	program.load(image);
+
+	std::vector<SilrunValue> args, results;
+	IrType                   type;
+	if(h.init != SilcodeNone && !program.run(h.init, args, results, type))
+	{
+		return 1;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		SilrunValue v;
+		v.i = std::strtoll(argv[i], nullptr, 0);
+		args.push_back(v);
+	}
+	if(!program.run(h.entry, args, results, type))
+	{
+		return 1;
+	}
+
+	for(const SilrunValue& v : results)
+	{
+		if(type == IrType::F64)
+		{
+			std::printf("%.17g\n", v.f);
+		}
+		else
+		{
+			std::printf("%" PRIi64 "\n", v.i);
+		}
+	}
+	return 0;
+}